@@ -29,11 +29,21 @@
  *
  * ========================================================================== */
 #include "TSUnit.hpp"
+#include "TSUnitTestAddOns.hpp"
 #include <cstring>
 #include <stdarg.h>
 #include <cstdlib>
 #include <cstdio>
 #include <cstdint>
+#include <vector>
+#include <set>
+#include <unordered_map>
+
+#if defined(TSUNIT_WITH_THREADS)
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+#endif
 
 #if defined(CROSS_BUILD) && defined(__ARM_EABI__)
     #include "infrastructure/target/arm/SEGGER_RTT/RTT/SEGGER_RTT.h"
@@ -42,6 +52,61 @@
 namespace tsunit {
     Statistics _totalStatistics;
 
+static RunOptions _runOptions;
+
+/* The number of failed assertions of the tests run by the calling thread */
+static TSUNIT_THREAD_LOCAL unsigned int _threadAssertionsFailedCnt = 0;
+
+/*
+ * The number of failed assertions of the test the calling thread works for.
+ * A thread that a test has started by itself works for no known test, so its
+ * failures are unattributed: These fail every test that is running meanwhile
+ * (which is just one unless --jobs is given).
+ */
+static TSUNIT_THREAD_LOCAL Statistics::Counter* _pTestAssertionsFailedCnt = nullptr;
+static Statistics::Counter _unattributedAssertionsFailedCnt(0);
+
+const RunOptions& runOptions()
+{
+    return _runOptions;
+}
+
+void _cntAssertionDone()
+{
+    ++_totalStatistics._assertionsCnt;
+}
+
+void _cntAssertionFailed()
+{
+    ++_totalStatistics._assertionsFailedCnt;
+    ++_threadAssertionsFailedCnt;
+    ++((nullptr != _pTestAssertionsFailedCnt) ? *_pTestAssertionsFailedCnt : _unattributedAssertionsFailedCnt);
+}
+
+void _markFailed()
+{
+    ++_totalStatistics._failedTestsCnt;
+}
+
+void _cntRun()
+{
+    ++_totalStatistics._runTestsCnt;
+}
+
+void _cntInstance(bool inFailed)
+{
+    ++_totalStatistics._runInstancesCnt;
+    if (inFailed)
+    {
+        ++_totalStatistics._failedInstancesCnt;
+    }
+}
+
+unsigned int _threadAssertionsFailed()
+{
+    return _threadAssertionsFailedCnt;
+}
+
 static const char* const _repeatString(unsigned int inRepeatCount, char inRepeatChar)
 {
     static char sBuffer[80];
@@ -76,6 +141,18 @@ public:
     {
         log("%s\n", _repeatString(80, '=') );
         log("Report of %s\n", tsunit::kVersionString);
+        if (_runOptions.shuffle)
+        {
+            log("Shuffled by seed %u (replay by --shuffle=%u)\n", _runOptions.shuffleSeed, _runOptions.shuffleSeed);
+        }
+        if (_runOptions.repeat > 1)
+        {
+            log("Repeating all tests %u times\n", _runOptions.repeat);
+        }
+        if (_runOptions.jobs > 1)
+        {
+            log("Running the tests on %u threads\n", _runOptions.jobs);
+        }
         log("%s\n", _repeatString(80, '=') );
     }
 
@@ -121,6 +198,13 @@ public:
             , _totalStatistics.assertionsCnt()
             , _totalStatistics.assertionsFailedCnt()
             );
+        if (_totalStatistics.runInstancesCnt() > 0)
+        {
+            log("= %d parameter instances in total, %d failed of these.\n"
+                , _totalStatistics.runInstancesCnt()
+                , _totalStatistics.failedInstancesCnt()
+                );
+        }
         log("%s\n", _repeatString(80, '=') );
     }
 }; // class CCommonConsoleLogging : public ILogger
@@ -162,35 +246,862 @@ public:
 }; // class CPrintfLogger : public ILogger
 #endif
 
-ILogger* pLogger = nullptr;
-const TestListEntry* pCurrentEntry;
+TSUNIT_THREAD_LOCAL ILogger* pLogger = nullptr;
+TSUNIT_THREAD_LOCAL const TestListEntry* pCurrentEntry;
+
+#if defined(TSUNIT_WITH_THREADS)
+/* The logger of the run and the test that runs if the tests run serially */
+static ILogger* _pRunLogger = nullptr;
+static std::mutex _runLoggerMutex;
+static std::atomic<const TestListEntry*> _pSerialEntry(nullptr);
+#endif
 
 // class TestCaseRegistrar - public
 void TestCaseRegistrar::push(const TestListEntry& inEntry)
 {
     _unittests.push_back(inEntry);
+    // The first test of an ID wins. The entries of a std::list stay in place.
+    _index.insert(std::make_pair(inEntry.id, &_unittests.back()));
 }
 
-static void _runTests()
+const TestListEntry* TestCaseRegistrar::find(TestId inId) const
+{
+    const auto found = _index.find(inId);
+    return (_index.end() == found) ? nullptr : found->second;
+}
+
+const TestListEntry* TestCaseRegistrar::find(const char* inGroupName, const char* inTestCaseName) const
+{
+    const TestListEntry* const entry = find(testId(inGroupName, inTestCaseName));
+    // Guards against a collision of the IDs.
+    if ((nullptr != entry)
+     && (0 == strcmp(entry->groupName, inGroupName))
+     && (0 == strcmp(entry->testCaseName, inTestCaseName)))
+    {
+        return entry;
+    }
+    return nullptr;
+}
+
+void TestCaseRegistrar::push(const TestDependency& inDependency)
+{
+    _dependencies.push_back(inDependency);
+}
+
+void TestCaseRegistrar::push(const TestResource& inResource)
+{
+    _resources.push_back(inResource);
+}
+
+/*
+ * Runs a single test on the calling thread and reports it to its pLogger.
+ * Returns true if the test has passed.
+ */
+static bool _runTest(const TestListEntry& inEntry)
+{
+    pCurrentEntry = &inEntry;
+    _seedTestRandomStreams(inEntry.groupName, inEntry.testCaseName);
+#if defined(TSUNIT_WITH_THREADS)
+    _pSerialEntry = (_runOptions.jobs > 1) ? nullptr : &inEntry;
+#endif
+
+    _cntRun();
+    Statistics::Counter testAssertionsFailedCnt(0);
+    _pTestAssertionsFailedCnt = &testAssertionsFailedCnt;
+    const unsigned int oldUnattributedCnt = _unattributedAssertionsFailedCnt;
+    pLogger->issueTestRun(inEntry);
+    inEntry.testFunct();
+
+    const bool passed = (0 == testAssertionsFailedCnt) && (oldUnattributedCnt == _unattributedAssertionsFailedCnt);
+    _pTestAssertionsFailedCnt = nullptr;
+    if (passed)
+    {
+        pLogger->reportPassed();
+    }
+    else
+    {
+        _markFailed();
+        pLogger->reportFailed();
+    }
+    return passed;
+}
+
+#if defined(TSUNIT_WITH_THREADS)
+/*
+ * A logger that just collects the output of a test that runs on a worker
+ * thread. The collected output is forwarded to the actual logger after the
+ * test has finished, so the reports of concurrent tests do not interleave.
+ */
+class CCollectingLogger : public ILogger
+{
+public:
+    CCollectingLogger() = default;
+    virtual ~CCollectingLogger() = default;
+
+    virtual void reportIntro() override {}
+    virtual void issueTestRun(const TestListEntry&) override { _output.clear(); }
+    virtual void reportPassed() override {}
+    virtual void reportFailed() override {}
+    virtual void reportResults() override {}
+
+    virtual void log(const char* fmt, ...) override
+    {
+        char buffer[512];
+        va_list list;
+        va_start(list, fmt);
+        vsnprintf(buffer, sizeof(buffer), fmt, list);
+        va_end(list);
+        _output.append(buffer);
+    }
+
+    const std::string& output() const
+    {
+        return _output;
+    }
+
+private:
+    std::string _output;
+}; // class CCollectingLogger : public ILogger
+
+/*
+ * A logger that forwards the output of several threads that work for the
+ * same test to the logger of this test - one line after another.
+ */
+class CForwardingLogger : public ILogger
+{
+public:
+    CForwardingLogger(ILogger& inLogger, std::mutex& inMutex)
+    : _logger(inLogger), _mutex(inMutex) {}
+    virtual ~CForwardingLogger() = default;
+
+    virtual void reportIntro() override {}
+    virtual void issueTestRun(const TestListEntry&) override {}
+    virtual void reportPassed() override {}
+    virtual void reportResults() override {}
+
+    virtual void reportFailed() override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _logger.reportFailed();
+    }
+
+    virtual void log(const char* fmt, ...) override
+    {
+        char buffer[512];
+        va_list list;
+        va_start(list, fmt);
+        vsnprintf(buffer, sizeof(buffer), fmt, list);
+        va_end(list);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _logger.log("%s", buffer);
+    }
+
+private:
+    ILogger& _logger;
+    std::mutex& _mutex;
+}; // class CForwardingLogger : public ILogger
+
+/*
+ * The logger of the threads that a test has started by itself: It forwards
+ * to the logger of the run. The test's line is just completed by [FAILED]
+ * if the tests run serially - otherwise other tests own that line.
+ */
+class CSharedLogger : public ILogger
+{
+public:
+    CSharedLogger() = default;
+    virtual ~CSharedLogger() = default;
+
+    virtual void reportIntro() override {}
+    virtual void issueTestRun(const TestListEntry&) override {}
+    virtual void reportPassed() override {}
+    virtual void reportResults() override {}
+
+    virtual void reportFailed() override
+    {
+        std::lock_guard<std::mutex> lock(_runLoggerMutex);
+        if ((nullptr != _pRunLogger) && (nullptr != _pSerialEntry.load()))
+        {
+            _pRunLogger->reportFailed();
+        }
+    }
+
+    virtual void log(const char* fmt, ...) override
+    {
+        char buffer[512];
+        va_list list;
+        va_start(list, fmt);
+        vsnprintf(buffer, sizeof(buffer), fmt, list);
+        va_end(list);
+
+        std::lock_guard<std::mutex> lock(_runLoggerMutex);
+        if (nullptr != _pRunLogger)
+        {
+            _pRunLogger->log("%s", buffer);
+        }
+    }
+}; // class CSharedLogger : public ILogger
+#endif
+
+ILogger* currentLogger()
+{
+#if defined(TSUNIT_WITH_THREADS)
+    if ((nullptr == pLogger) && (nullptr != _pRunLogger))
+    {
+        static CSharedLogger sharedLogger;
+        return &sharedLogger;
+    }
+#endif
+    return pLogger;
+}
+
+const TestListEntry* currentEntry()
+{
+#if defined(TSUNIT_WITH_THREADS)
+    if (nullptr == pCurrentEntry)
+    {
+        // A thread that a test has started by itself
+        static const TestListEntry unknownEntry{"?", "(a thread of a parallel test)", nullptr, 0};
+        const TestListEntry* const entry = _pSerialEntry.load();
+        return (nullptr != entry) ? entry : &unknownEntry;
+    }
+#endif
+    return pCurrentEntry;
+}
+
+#if defined(TSUNIT_WITH_THREADS)
+/*
+ * The helper threads of a parallel run. They are shared by all tests that
+ * run meanwhile: _dispatch() offers its work to the idle helpers while the
+ * calling thread works on it as well. So a run never uses more than twice
+ * the number of --jobs threads.
+ */
+class CHelperPool
+{
+public:
+    CHelperPool() = default;
+    CHelperPool(const CHelperPool&) = delete;
+    CHelperPool& operator=(const CHelperPool&) = delete;
+
+    ~CHelperPool()
+    {
+        stop();
+    }
+
+    void start(unsigned int inNrOfThreads)
+    {
+        _stopping = false;
+        for (unsigned int i = 0; i < inNrOfThreads; ++i)
+        {
+            _threads.emplace_back(&CHelperPool::_helper, this);
+        }
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _condition.notify_all();
+        for (std::thread& thread : _threads)
+        {
+            thread.join();
+        }
+        _threads.clear();
+    }
+
+    bool started() const
+    {
+        return not _threads.empty();
+    }
+
+    /*
+     * Runs inWork on the calling thread and on up to inMaxHelpers idle
+     * helpers - in the context of the current test.
+     */
+    void run(const std::function<void()>& inWork, unsigned int inMaxHelpers)
+    {
+        Task task{inWork, *pLogger, pCurrentEntry, _pTestAssertionsFailedCnt, {}, inMaxHelpers, 0};
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back(&task);
+        }
+        _condition.notify_all();
+
+        // The calling thread works as well.
+        ILogger* const logger = pLogger;
+        CForwardingLogger forwardingLogger(*logger, task.loggerMutex);
+        pLogger = &forwardingLogger;
+        inWork();
+        pLogger = logger;
+
+        // Withdraw the offer and wait for the helpers that took it.
+        std::unique_lock<std::mutex> lock(_mutex);
+        _withdraw(&task);
+        while (task.runningCnt > 0)
+        {
+            _condition.wait(lock);
+        }
+    }
+
+private:
+    struct Task
+    {
+        const std::function<void()>& work;
+        ILogger& logger;
+        const TestListEntry* const entry;
+        Statistics::Counter* const assertionsFailedCnt;
+        std::mutex loggerMutex;
+        unsigned int offeredCnt;  // The number of helpers that may still join
+        unsigned int runningCnt;
+    };
+
+    void _withdraw(Task* inTask)
+    {
+        for (std::vector<Task*>::iterator it = _tasks.begin(); it != _tasks.end(); ++it)
+        {
+            if (*it == inTask)
+            {
+                _tasks.erase(it);
+                return;
+            }
+        }
+    }
+
+    void _helper()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            while (not _stopping && _tasks.empty())
+            {
+                _condition.wait(lock);
+            }
+            if (_stopping)
+            {
+                return;
+            }
+
+            Task& task = *_tasks.front();
+            if (0 == --task.offeredCnt)
+            {
+                _withdraw(&task);
+            }
+            ++task.runningCnt;
+            lock.unlock();
+
+            CForwardingLogger forwardingLogger(task.logger, task.loggerMutex);
+            pLogger = &forwardingLogger;
+            pCurrentEntry = task.entry;
+            _pTestAssertionsFailedCnt = task.assertionsFailedCnt;
+            task.work();
+            pLogger = nullptr;
+            pCurrentEntry = nullptr;
+            _pTestAssertionsFailedCnt = nullptr;
+
+            lock.lock();
+            --task.runningCnt;
+            _condition.notify_all();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::vector<Task*> _tasks;      // The tasks that are offered to the helpers
+    std::vector<std::thread> _threads;
+    bool _stopping = false;
+}; // class CHelperPool
+
+static CHelperPool _helperPool;
+#endif
+
+void _dispatch(const std::function<void()>& inWork)
+{
+#if defined(TSUNIT_WITH_THREADS)
+    if (_helperPool.started() && (nullptr != pLogger))
+    {
+        _helperPool.run(inWork, _runOptions.jobs - 1);
+        return;
+    }
+#endif
+    inWork();
+}
+
+/*
+ * Schedules the tests of all repetitions as a directed acyclic graph.
+ *
+ * Every test of every repetition is a node of this graph. The edges are
+ * declared by TSUNIT_AFTER() and connect the nodes of the same repetition.
+ * A node gets ready if all its predecessors have been finished. Of all ready
+ * nodes the one of the lowest repetition and the lowest priority is started
+ * first, as long as none of its resources (TSUNIT_EXCLUSIVE()) is held by a
+ * running test. The priority is the position of the test's definition or a
+ * pseudo random number if the tests are shuffled.
+ *
+ * The tests that are connected by edges (typically they share some state)
+ * form a component. A repetition owns a component from the start of its
+ * first node of this component until all of them have been finished - so
+ * the repetitions of a component (and of a single test) never overlap.
+ */
+class CTestScheduler
 {
-    for (const TestListEntry& entry : TestCaseRegistrar::sharedInstance().unittests())
+public:
+    CTestScheduler(ILogger& inLogger, const std::vector<std::uint32_t>& inSeeds)
+    : _logger(inLogger)
+    , _seeds(inSeeds)
+    {
+        for (const TestListEntry& entry : TestCaseRegistrar::sharedInstance().unittests())
+        {
+            _testIndex.insert(std::make_pair(&entry, _tests.size()));
+            _tests.push_back(&entry);
+        }
+        _successors.resize(_tests.size());
+        _predecessorCnt.resize(_tests.size(), 0);
+        _resources.resize(_tests.size());
+
+        for (const TestDependency& dependency : TestCaseRegistrar::sharedInstance().dependencies())
+        {
+            const std::size_t test = _findTest(dependency.groupName, dependency.testCaseName);
+            const std::size_t after = _findTest(dependency.afterGroupName, dependency.afterTestCaseName);
+            if ((kNotFound == test) || (kNotFound == after))
+            {
+                _logger.log(ESC_COLOR_RED "*** Ignoring dependency of unknown tests %s::%s -> %s::%s" ESC_COLOR_RESET "\n"
+                    , dependency.groupName, dependency.testCaseName
+                    , dependency.afterGroupName, dependency.afterTestCaseName);
+            }
+            else
+            {
+                _successors[after].push_back(test);
+                ++_predecessorCnt[test];
+            }
+        }
+
+        std::vector<const char*> resourceNames;
+        for (const TestResource& resource : TestCaseRegistrar::sharedInstance().resources())
+        {
+            const std::size_t test = _findTest(resource.groupName, resource.testCaseName);
+            if (kNotFound == test)
+            {
+                _logger.log(ESC_COLOR_RED "*** Ignoring resource %s of unknown test %s::%s" ESC_COLOR_RESET "\n"
+                    , resource.resourceName, resource.groupName, resource.testCaseName);
+                continue;
+            }
+
+            std::size_t resourceIdx = 0;
+            while ((resourceIdx < resourceNames.size()) && (0 != strcmp(resourceNames[resourceIdx], resource.resourceName)))
+            {
+                ++resourceIdx;
+            }
+            if (resourceIdx == resourceNames.size())
+            {
+                resourceNames.push_back(resource.resourceName);
+            }
+            _resources[test].push_back(resourceIdx);
+        }
+        _resourceBusy.resize(resourceNames.size(), false);
+
+        // The connected components of the edges
+        _component.resize(_tests.size());
+        for (std::size_t test = 0; test < _tests.size(); ++test)
+        {
+            _component[test] = test;
+        }
+        for (std::size_t after = 0; after < _tests.size(); ++after)
+        {
+            for (std::size_t test : _successors[after])
+            {
+                _component[_rootComponent(test)] = _rootComponent(after);
+            }
+        }
+        _componentOwner.resize(_tests.size(), std::size_t(kNotFound));
+        _componentSize.resize(_tests.size(), 0);
+        for (std::size_t test = 0; test < _tests.size(); ++test)
+        {
+            _component[test] = _rootComponent(test);
+            ++_componentSize[_component[test]];
+        }
+        _componentRemainingCnt.resize(_tests.size(), 0);
+
+        _nodes.resize(_tests.size() * _seeds.size());
+        for (std::size_t rep = 0; rep < _seeds.size(); ++rep)
+        {
+            if (_runOptions.shuffle)
+            {
+                pseudoRandomsetSeed(_seeds[rep]);
+            }
+            for (std::size_t test = 0; test < _tests.size(); ++test)
+            {
+                Node& node = _nodes[rep * _tests.size() + test];
+                node.priority = (std::uint64_t(rep) << 32) | (_runOptions.shuffle ? pseudoRandom() : test);
+                node.pendingCnt = _predecessorCnt[test];
+                if (0 == node.pendingCnt)
+                {
+                    _ready.insert(ReadyKey(node.priority, rep * _tests.size() + test));
+                }
+            }
+        }
+        _remainingCnt.resize(_seeds.size(), _tests.size());
+        _repetitionFailed.resize(_seeds.size(), false);
+    }
+
+    /*
+     * Runs all tests on the calling thread.
+     */
+    void runSerial()
+    {
+        std::size_t nodeIdx = 0;
+        while (_pickNext(nodeIdx))
+        {
+            _finish(nodeIdx, _runTest(*_tests[nodeIdx % _tests.size()]));
+        }
+    }
+
+#if defined(TSUNIT_WITH_THREADS)
+    /*
+     * Runs all tests on the given number of worker threads.
+     */
+    void runParallel(unsigned int inJobs)
+    {
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < inJobs; ++i)
+        {
+            threads.emplace_back(&CTestScheduler::_worker, this);
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+#endif
+
+private:
+    static constexpr std::size_t kNotFound = ~std::size_t(0);
+
+    struct Node {
+        std::uint64_t priority = 0;
+        unsigned int pendingCnt = 0; // The number of unfinished predecessors
+        bool started = false;
+    };
+
+    using ReadyKey = std::pair<std::uint64_t, std::size_t>;
+
+    std::size_t _findTest(const char* inGroupName, const char* inTestCaseName) const
+    {
+        const TestListEntry* const entry = TestCaseRegistrar::sharedInstance().find(inGroupName, inTestCaseName);
+        return (nullptr == entry) ? kNotFound : _testIndex.at(entry);
+    }
+
+    bool _allFinished() const
+    {
+        return _finishedCnt == _nodes.size();
+    }
+
+    std::size_t _rootComponent(std::size_t inTest) const
+    {
+        while (_component[inTest] != inTest)
+        {
+            inTest = _component[inTest];
+        }
+        return inTest;
+    }
+
+    /*
+     * Returns true if another repetition owns the component of the node.
+     */
+    bool _componentBusy(std::size_t inNodeIdx) const
+    {
+        const std::size_t owner = _componentOwner[_component[inNodeIdx % _tests.size()]];
+        return (kNotFound != owner) && (owner != inNodeIdx / _tests.size());
+    }
+
+    /*
+     * Picks the next node to run and acquires its resources.
+     * Returns false if there is currently no node that is able to run.
+     */
+    bool _pickNext(std::size_t& outNodeIdx)
+    {
+        if (_pickReady(outNodeIdx))
+        {
+            return true;
+        }
+        if ((0 == _runningCnt) && not _allFinished())
+        {
+            _breakCycle();
+            return _pickReady(outNodeIdx);
+        }
+        return false;
+    }
+
+    bool _pickReady(std::size_t& outNodeIdx)
     {
-        pCurrentEntry = &entry;
+        for (std::set<ReadyKey>::iterator it = _ready.begin(); it != _ready.end(); ++it)
+        {
+            const std::vector<std::size_t>& resources = _resources[it->second % _tests.size()];
+            bool available = not _componentBusy(it->second);
+            for (std::size_t resource : resources)
+            {
+                available &= not _resourceBusy[resource];
+            }
+
+            if (available)
+            {
+                for (std::size_t resource : resources)
+                {
+                    _resourceBusy[resource] = true;
+                }
+                outNodeIdx = it->second;
+                _nodes[outNodeIdx].started = true;
+                const std::size_t component = _component[outNodeIdx % _tests.size()];
+                if (kNotFound == _componentOwner[component])
+                {
+                    _componentOwner[component] = outNodeIdx / _tests.size();
+                    _componentRemainingCnt[component] = _componentSize[component];
+                }
+                _ready.erase(it);
+                ++_runningCnt;
+                return true;
+            }
+        }
+        return false;
+    }
 
-        _totalStatistics.incRunTestsCnt();
-        const auto oldFailCnt = _totalStatistics.assertionsFailedCnt();
-        pLogger->issueTestRun(entry);
-        entry.testFunct();
-        if (oldFailCnt == _totalStatistics.assertionsFailedCnt())
+    /*
+     * The remaining nodes wait for each other. So start the one of them that
+     * has been defined first.
+     */
+    void _breakCycle()
+    {
+        for (std::size_t i = 0; i < _nodes.size(); ++i)
         {
-            pLogger->reportPassed();
+            if (not _nodes[i].started && (_nodes[i].pendingCnt > 0) && not _componentBusy(i))
+            {
+                const TestListEntry& entry = *_tests[i % _tests.size()];
+                _logger.log(ESC_COLOR_RED "*** Cyclic dependency, running %s::%s regardless" ESC_COLOR_RESET "\n"
+                    , entry.groupName, entry.testCaseName);
+                _nodes[i].pendingCnt = 0;
+                _ready.insert(ReadyKey(_nodes[i].priority, i));
+                break;
+            }
+        }
+    }
+
+    /*
+     * Marks a node as finished, releases its resources and makes its
+     * successors ready.
+     */
+    void _finish(std::size_t inNodeIdx, bool inPassed)
+    {
+        const std::size_t test = inNodeIdx % _tests.size();
+        const std::size_t rep  = inNodeIdx / _tests.size();
+
+        for (std::size_t resource : _resources[test])
+        {
+            _resourceBusy[resource] = false;
+        }
+
+        const std::size_t component = _component[test];
+        if (0 == --_componentRemainingCnt[component])
+        {
+            _componentOwner[component] = kNotFound;
+        }
+
+        for (std::size_t successor : _successors[test])
+        {
+            Node& node = _nodes[rep * _tests.size() + successor];
+            if ((node.pendingCnt > 0) && (0 == --node.pendingCnt))
+            {
+                _ready.insert(ReadyKey(node.priority, rep * _tests.size() + successor));
+            }
+        }
+
+        --_runningCnt;
+        ++_finishedCnt;
+
+        _repetitionFailed[rep] = _repetitionFailed[rep] || not inPassed;
+        if ((0 == --_remainingCnt[rep]) && _repetitionFailed[rep] && (_seeds.size() > 1))
+        {
+            _reportFailedRepetition(rep);
+        }
+    }
+
+    void _reportFailedRepetition(std::size_t inRepetition)
+    {
+        if (_runOptions.shuffle)
+        {
+            _logger.log(ESC_COLOR_RED "*** Repetition %u of %u failed (replay by --shuffle=%u)" ESC_COLOR_RESET "\n"
+                , unsigned(inRepetition + 1), unsigned(_seeds.size()), _seeds[inRepetition]);
         }
         else
         {
-            _totalStatistics.incFailedTestsCnt();
-            pLogger->reportFailed();
+            _logger.log(ESC_COLOR_RED "*** Repetition %u of %u failed" ESC_COLOR_RESET "\n"
+                , unsigned(inRepetition + 1), unsigned(_seeds.size()));
+        }
+    }
+
+#if defined(TSUNIT_WITH_THREADS)
+    void _worker()
+    {
+        CCollectingLogger collectingLogger;
+        pLogger = &collectingLogger;
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (not _allFinished())
+        {
+            std::size_t nodeIdx = 0;
+            if (not _pickNext(nodeIdx))
+            {
+                _condition.wait(lock);
+                continue;
+            }
+
+            const TestListEntry& entry = *_tests[nodeIdx % _tests.size()];
+            lock.unlock();
+            const bool passed = _runTest(entry);
+            lock.lock();
+
+            // The output of the test in the same layout as a serial run: A
+            // passed test's output precedes [PASSED], [FAILED] precedes the failures.
+            std::lock_guard<std::mutex> loggerLock(_runLoggerMutex);
+            _logger.issueTestRun(entry);
+            if (not passed)
+            {
+                _logger.reportFailed();
+            }
+            if (not collectingLogger.output().empty())
+            {
+                _logger.log("%s", collectingLogger.output().c_str());
+            }
+            if (passed)
+            {
+                _logger.reportPassed();
+            }
+            _finish(nodeIdx, passed);
+            _condition.notify_all();
+        }
+        pLogger = nullptr;
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+#endif
+
+    ILogger& _logger;
+    const std::vector<std::uint32_t>& _seeds;
+
+    // Per test
+    std::vector<const TestListEntry*> _tests;
+    std::unordered_map<const TestListEntry*, std::size_t> _testIndex;
+    std::vector<std::vector<std::size_t> > _successors;
+    std::vector<unsigned int> _predecessorCnt;
+    std::vector<std::vector<std::size_t> > _resources;
+    std::vector<std::size_t> _component;     // The root test of its component
+
+    // Per component (indexed by its root test)
+    std::vector<std::size_t> _componentSize;
+    std::vector<std::size_t> _componentOwner; // The repetition that runs it
+    std::vector<std::size_t> _componentRemainingCnt;
+
+    // Per node (repetition * test)
+    std::vector<Node> _nodes;
+    std::set<ReadyKey> _ready;
+    std::vector<bool> _resourceBusy;
+    std::size_t _runningCnt = 0;
+    std::size_t _finishedCnt = 0;
+
+    // Per repetition
+    std::vector<std::size_t> _remainingCnt;
+    std::vector<bool> _repetitionFailed;
+}; // class CTestScheduler
+
+/*
+ * The seeds of all repetitions. The first repetition uses the seed of the
+ * run options so a failed repetition may be replayed by its own seed.
+ */
+static std::vector<std::uint32_t> _repetitionSeeds()
+{
+    std::vector<std::uint32_t> seeds(1, _runOptions.shuffleSeed);
+    // Unless shuffled the pseudo random numbers keep their default seed.
+    if (_runOptions.shuffle)
+    {
+        pseudoRandomsetSeed(_runOptions.shuffleSeed);
+    }
+    while (seeds.size() < _runOptions.repeat)
+    {
+        seeds.push_back(_runOptions.shuffle ? pseudoRandom() : 0);
+    }
+    return seeds;
+}
+
+static void _runTests()
+{
+    const std::vector<std::uint32_t> seeds = _repetitionSeeds();
+    CTestScheduler scheduler(*pLogger, seeds);
+
+#if defined(TSUNIT_WITH_THREADS)
+    if (_runOptions.jobs > 1)
+    {
+        _helperPool.start(_runOptions.jobs - 1);
+        scheduler.runParallel(_runOptions.jobs);
+        _helperPool.stop();
+        return;
+    }
+#endif
+    scheduler.runSerial();
+}
+
+/*
+ * Parses the command line arguments of the run. Unknown arguments are ignored.
+ */
+static RunOptions _parseRunOptions(int argc, char* argv[])
+{
+    RunOptions options;
+    bool jobsGiven = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* const arg = argv[i];
+        if (0 == strcmp(arg, "--shuffle"))
+        {
+            options.shuffle = true;
+            const auto now = Clock::now().time_since_epoch().count();
+            options.shuffleSeed = hash(&now, sizeof(now));
+        }
+        else if (0 == strncmp(arg, "--shuffle=", 10))
+        {
+            options.shuffle = true;
+            options.shuffleSeed = static_cast<std::uint32_t>(strtoul(arg + 10, nullptr, 0));
+        }
+        else if (0 == strncmp(arg, "--repeat=", 9))
+        {
+            options.repeat = static_cast<unsigned int>(strtoul(arg + 9, nullptr, 0));
+        }
+        else if (0 == strncmp(arg, "--jobs=", 7))
+        {
+            options.jobs = static_cast<unsigned int>(strtoul(arg + 7, nullptr, 0));
+            jobsGiven = true;
         }
     }
+
+    if (options.repeat < 1)
+    {
+        options.repeat = 1;
+    }
+
+#if defined(TSUNIT_WITH_THREADS)
+    if (not jobsGiven && (options.repeat > 1))
+    {
+        options.jobs = std::thread::hardware_concurrency();
+    }
+#else
+    options.jobs = 1;
+#endif
+    if (options.jobs < 1)
+    {
+        options.jobs = 1;
+    }
+    return options;
 }
 } // namespace tsunit
 
@@ -216,11 +1127,19 @@ int tsunit::runUnitTests(int argc, char* argv[])
 
     /* Clear the statistic collected so far... */
     _totalStatistics.clear();
+    _runOptions = _parseRunOptions(argc, argv);
 
     if (tsunit::pLogger)
     {
+    #if defined(TSUNIT_WITH_THREADS)
+        tsunit::_pRunLogger = tsunit::pLogger;
+    #endif
         tsunit::pLogger->reportIntro();
         tsunit::_runTests();
+    #if defined(TSUNIT_WITH_THREADS)
+        std::lock_guard<std::mutex> lock(tsunit::_runLoggerMutex);
+        tsunit::_pRunLogger = nullptr;
+    #endif
     }
     tsunit::pLogger->reportResults();
     return tsunit::_totalStatistics.failedTestsCnt() ? EXIT_FAILURE : EXIT_SUCCESS;
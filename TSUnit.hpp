@@ -31,6 +31,32 @@
  * ========================================================================== */
 #include <list>
 #include <string>
+#include <vector>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+/*
+ * TSUnit runs its tests on several threads if requested (see RunOptions).
+ * Define TSUNIT_SINGLE_THREADED in order to build it without any thread
+ * support (this is implied for CROSS_BUILDs).
+ */
+#if !defined(TSUNIT_SINGLE_THREADED) && !defined(CROSS_BUILD)
+    #define TSUNIT_WITH_THREADS
+#endif
+
+#if defined(TSUNIT_WITH_THREADS)
+    #include <atomic>
+    #include <mutex>
+    #define TSUNIT_THREAD_LOCAL thread_local
+#else
+    #define TSUNIT_THREAD_LOCAL
+#endif
 
 namespace tsunit {
 
@@ -40,9 +66,16 @@ void _cntAssertionDone();
 void _cntAssertionFailed();
 void _markFailed();
 void _cntRun();
+void _cntInstance(bool inFailed);
 
 class Statistics {
 public:
+#if defined(TSUNIT_WITH_THREADS)
+    using Counter = std::atomic<unsigned int>;
+#else
+    using Counter = unsigned int;
+#endif
+
     Statistics() = default;
 
     // ==================================================================
@@ -56,6 +89,8 @@ public:
         _failedTestsCnt = 0;
         _assertionsCnt = 0;
         _assertionsFailedCnt = 0;
+        _runInstancesCnt = 0;
+        _failedInstancesCnt = 0;
     }
 
     unsigned int failedTestsCnt() const
@@ -83,6 +118,22 @@ public:
         return _assertionsFailedCnt;
     }
 
+    // The parameter instances of parameterized tests (TSUNIT_TEST_P)
+    unsigned int runInstancesCnt() const
+    {
+        return _runInstancesCnt;
+    }
+
+    unsigned int failedInstancesCnt() const
+    {
+        return _failedInstancesCnt;
+    }
+
+    unsigned int passedInstancesCnt() const
+    {
+        return _runInstancesCnt - _failedInstancesCnt;
+    }
+
     // ==================================================================
     // Increase the counters
     // ==================================================================
@@ -107,15 +158,18 @@ public:
     }
 
 private:
-    unsigned int _runTestsCnt = 0;
-    unsigned int _failedTestsCnt = 0;
-    unsigned int _assertionsCnt = 0;
-    unsigned int _assertionsFailedCnt = 0;
+    Counter _runTestsCnt{0};
+    Counter _failedTestsCnt{0};
+    Counter _assertionsCnt{0};
+    Counter _assertionsFailedCnt{0};
+    Counter _runInstancesCnt{0};
+    Counter _failedInstancesCnt{0};
 
     friend void _cntAssertionDone();
     friend void _cntAssertionFailed();
     friend void _markFailed();
     friend void _cntRun();
+    friend void _cntInstance(bool);
 
 }; // class Statistics
 
@@ -137,20 +191,97 @@ static Statistics& totalStatistics()
 #endif
 
 
+/*
+ * Every test is identified by a 64 bit ID: the FNV-1a hash of "group::name".
+ * The TSUNIT_TEST...() macros calculate it at compile time, thus a test can
+ * be looked up (or its results can be keyed) by an integer instead of
+ * comparing its names.
+ */
+using TestId = std::uint64_t;
+
+constexpr TestId kTestIdBasis = 0xcbf29ce484222325ull;
+constexpr TestId kTestIdPrime = 0x100000001b3ull;
+
+constexpr TestId _fnv1a(const char* inString, TestId inHash)
+{
+    return ('\0' == *inString) ? inHash
+        : _fnv1a(inString + 1, (inHash ^ static_cast<unsigned char>(*inString)) * kTestIdPrime);
+}
+
+/*!
+ * \brief Calculates the ID of the test inGroupName::inTestCaseName.
+ * \see TestCaseRegistrar::find()
+ */
+constexpr TestId testId(const char* inGroupName, const char* inTestCaseName)
+{
+    return _fnv1a(inTestCaseName, _fnv1a("::", _fnv1a(inGroupName, kTestIdBasis)));
+}
+
+/*
+ * Forces the calculation of the ID at compile time (C++11 does not
+ * guarantee this for a constexpr function called within an expression).
+ */
+#define TSUNIT_TEST_ID(groupname,testcase)\
+std::integral_constant<tsunit::TestId, tsunit::testId(#groupname, #testcase)>::value
+
 struct TestListEntry {
     const char* const groupName;
     const char* const testCaseName;
     void(*testFunct)(void);
+    const TestId id;
 };
 
 using TestList = std::list<TestListEntry>;
 
+/*
+ * Declares that a test must not start before another one has finished.
+ */
+struct TestDependency {
+    const char* const groupName;
+    const char* const testCaseName;
+    const char* const afterGroupName;
+    const char* const afterTestCaseName;
+};
+
+using TestDependencyList = std::list<TestDependency>;
+
+/*
+ * Declares that a test uses a resource exclusively. Tests that share a
+ * resource will never run at the same time.
+ */
+struct TestResource {
+    const char* const groupName;
+    const char* const testCaseName;
+    const char* const resourceName;
+};
+
+using TestResourceList = std::list<TestResource>;
+
 class TestCaseRegistrar
 {
 public:
     void push(const TestListEntry& inEntry);
+    void push(const TestDependency& inDependency);
+    void push(const TestResource& inResource);
     const TestList& unittests() const {
         return _unittests; }
+    const TestDependencyList& dependencies() const {
+        return _dependencies; }
+    const TestResourceList& resources() const {
+        return _resources; }
+
+    /*!
+     * \brief Looks up a registered test by its ID in O(1).
+     * \return The test or nullptr if there is no test of this ID.
+     */
+    const TestListEntry* find(TestId inId) const;
+
+    /*!
+     * \brief Looks up a registered test by its names in O(1).
+     * \return The test or nullptr if there is no such test.
+     */
+    const TestListEntry* find(const char* inGroupName, const char* inTestCaseName) const;
+
     static TestCaseRegistrar& sharedInstance() {
         static TestCaseRegistrar singleton;
         return singleton;
@@ -159,6 +290,9 @@ public:
 private:
     TestCaseRegistrar() = default;
     TestList _unittests;
+    std::unordered_map<TestId, const TestListEntry*> _index;
+    TestDependencyList _dependencies;
+    TestResourceList _resources;
 }; // class TestCaseRegistrar
 
 #define TESTNAME(groupname,testcase) groupname##_TC_##testcase
@@ -183,8 +317,13 @@ class TestFixture
 {
 public:
     TestFixture(const char* const inGroupName, const char* const inTestCaseName, void(*inTestFunction)(void))
+    : TestFixture(inGroupName, inTestCaseName, inTestFunction, testId(inGroupName, inTestCaseName))
+    {
+    }
+
+    TestFixture(const char* const inGroupName, const char* const inTestCaseName, void(*inTestFunction)(void), TestId inId)
     {
-        TestCaseRegistrar::sharedInstance().push(TestListEntry{inGroupName, inTestCaseName, inTestFunction});
+        TestCaseRegistrar::sharedInstance().push(TestListEntry{inGroupName, inTestCaseName, inTestFunction, inId});
     }
 }; // class TestFixture
 
@@ -203,7 +342,7 @@ public:
     protected:\
         virtual void _runTest() override;\
     };\
-    tsunit::TestFixture testCase_##Testname(#FixtureClass, #Testname, Ext_##FixtureClass_##Testname::runTest);\
+    tsunit::TestFixture testCase_##Testname(#FixtureClass, #Testname, Ext_##FixtureClass_##Testname::runTest, TSUNIT_TEST_ID(FixtureClass, Testname));\
     void Ext_##FixtureClass_##Testname::_runTest()
 
 // Common Tests
@@ -211,16 +350,55 @@ class TestCase
 {
 public:
     TestCase(const char* const inGroupName, const char* const inTestCaseName, void(*inTestFunction)(void))
+    : TestCase(inGroupName, inTestCaseName, inTestFunction, testId(inGroupName, inTestCaseName))
     {
-        TestCaseRegistrar::sharedInstance().push(TestListEntry{inGroupName, inTestCaseName, inTestFunction});
+    }
+
+    TestCase(const char* const inGroupName, const char* const inTestCaseName, void(*inTestFunction)(void), TestId inId)
+    {
+        TestCaseRegistrar::sharedInstance().push(TestListEntry{inGroupName, inTestCaseName, inTestFunction, inId});
     }
 };
 
 #define TSUNIT_TEST(groupname,testcase)\
 extern void groupname##_TC_##testcase();\
-tsunit::TestCase TR_##groupname##_TC_##testcase(#groupname, #testcase,groupname##_TC_##testcase);\
+tsunit::TestCase TR_##groupname##_TC_##testcase(#groupname, #testcase, groupname##_TC_##testcase, TSUNIT_TEST_ID(groupname, testcase));\
 void groupname##_TC_##testcase()
 
+// Constraints of Tests
+class TestAfter
+{
+public:
+    TestAfter(const char* const inGroupName, const char* const inTestCaseName, const char* const inAfterGroupName, const char* const inAfterTestCaseName)
+    {
+        TestCaseRegistrar::sharedInstance().push(TestDependency{inGroupName, inTestCaseName, inAfterGroupName, inAfterTestCaseName});
+    }
+};
+
+class TestExclusive
+{
+public:
+    TestExclusive(const char* const inGroupName, const char* const inTestCaseName, const char* const inResourceName)
+    {
+        TestCaseRegistrar::sharedInstance().push(TestResource{inGroupName, inTestCaseName, inResourceName});
+    }
+};
+
+/*
+ * Declares that the test groupname::testcase has to run after the test
+ * aftergroup::aftertestcase has been finished - even if the tests are shuffled
+ * or run on several threads.
+ */
+#define TSUNIT_AFTER(groupname,testcase,aftergroup,aftertestcase)\
+tsunit::TestAfter TA_##groupname##_TC_##testcase##_AFTER_##aftergroup##_TC_##aftertestcase(#groupname, #testcase, #aftergroup, #aftertestcase)
+
+/*
+ * Declares that the test groupname::testcase uses the (symbolic) resource
+ * exclusively. Tests that share a resource will never run at the same time.
+ */
+#define TSUNIT_EXCLUSIVE(groupname,testcase,resource)\
+tsunit::TestExclusive TX_##groupname##_TC_##testcase##_USES_##resource(#groupname, #testcase, #resource)
+
 class ILogger
 {
 public:
@@ -235,61 +413,512 @@ public:
     virtual void reportResults() = 0;
 };
 
-extern ILogger* pLogger;
-extern const TestListEntry* pCurrentEntry;
+extern TSUNIT_THREAD_LOCAL ILogger* pLogger;
+extern TSUNIT_THREAD_LOCAL const TestListEntry* pCurrentEntry;
+
+/*!
+ * Returns the logger of the test that the calling thread works for. The
+ * assertions use this one: A thread that a test has started by itself has no
+ * pLogger - it shares the (locked) logger of the run.
+ */
+ILogger* currentLogger();
+
+/*!
+ * Returns the test that the calling thread works for - or a placeholder if
+ * this is a thread that a test of a parallel run has started by itself.
+ */
+const TestListEntry* currentEntry();
+
+/*
+ * The options of a test run. These are parsed from the command line
+ * arguments passed to runUnitTests():
+ *
+ *   --shuffle[=seed]  Run the tests in a pseudo random order. If the seed
+ *                     is omitted a new one is chosen (and reported).
+ *   --repeat=N        Run all tests N times. Every repetition will be
+ *                     shuffled by an own seed.
+ *   --jobs=N          Run the tests on N threads. This defaults to the
+ *                     number of cores if --repeat is given, 1 otherwise.
+ *
+ * The order declared by TSUNIT_AFTER() and the resources declared by
+ * TSUNIT_EXCLUSIVE() are honored in any case.
+ */
+struct RunOptions
+{
+    bool shuffle = false;
+    std::uint32_t shuffleSeed = 0;
+    unsigned int repeat = 1;
+    unsigned int jobs = 1;
+};
+
+/*!
+ * Returns the options of the current (or recent) test run.
+ * \return The options parsed by runUnitTests().
+ */
+const RunOptions& runOptions();
 
 #define UT_EXPECT_TRUE(arg) do{\
-  tsunit::totalStatistics().incAssertionsCnt();\
+  tsunit::_cntAssertionDone();\
   if ( ! (arg) ) {\
-    tsunit::totalStatistics().incAssertionFailedCnt();\
-    if (tsunit::pLogger){\
-        tsunit::pLogger->reportFailed();\
-        tsunit::pLogger->log(ESC_COLOR_RED "*** Assertion failed in %s::%s @line %d" ESC_COLOR_RESET "\n"\
-            , tsunit::pCurrentEntry->groupName\
-            , tsunit::pCurrentEntry->testCaseName, __LINE__);\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()){\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Assertion failed in %s::%s @line %d" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__);\
     }\
   }\
 } while(0)
 
 #define UT_EXPECT_FALSE(arg) do{\
-  tsunit::totalStatistics().incAssertionsCnt();\
+  tsunit::_cntAssertionDone();\
   if ( (arg) ) {\
-    tsunit::totalStatistics().incAssertionFailedCnt();\
-    if (tsunit::pLogger){\
-        tsunit::pLogger->reportFailed();\
-        tsunit::pLogger->log(ESC_COLOR_RED "*** Assertion failed in %s::%s @line %d" ESC_COLOR_RESET "\n"\
-            , tsunit::pCurrentEntry->groupName\
-            , tsunit::pCurrentEntry->testCaseName, __LINE__);\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()){\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Assertion failed in %s::%s @line %d" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__);\
     }\
   }\
 } while(0)
 
 #define UT_EXPECT_EQ(argA,argB) do{\
-  tsunit::totalStatistics().incAssertionsCnt();\
+  tsunit::_cntAssertionDone();\
   if ( (argA) != (argB) ) {\
-    tsunit::totalStatistics().incAssertionFailedCnt();\
-    if (tsunit::pLogger) {\
-        tsunit::pLogger->reportFailed();\
-        tsunit::pLogger->log(ESC_COLOR_RED "*** Assertion failed in %s::%s @line %d" ESC_COLOR_RESET "\n"\
-            , tsunit::pCurrentEntry->groupName\
-            , tsunit::pCurrentEntry->testCaseName, __LINE__);\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()) {\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Assertion failed in %s::%s @line %d" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__);\
     }\
   }\
 } while(0)
 
 #define UT_EXPECT_NE(argA,argB) do{\
-  tsunit::totalStatistics().incAssertionsCnt();\
+  tsunit::_cntAssertionDone();\
   if ( (argA) == (argB) ) {\
-    tsunit::totalStatistics().incAssertionFailedCnt();\
-    if (tsunit::pLogger) {\
-        tsunit::pLogger->reportFailed();\
-        tsunit::pLogger->log(ESC_COLOR_RED "*** Assertion failed in %s::%s @line %d" ESC_COLOR_RESET "\n"\
-            , tsunit::pCurrentEntry->groupName\
-            , tsunit::pCurrentEntry->testCaseName, __LINE__);\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()) {\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Assertion failed in %s::%s @line %d" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__);\
+    }\
+  }\
+} while(0)
+
+// ==========================================================================
+// Latency budget support
+// ==========================================================================
+/*!
+ * The monotonic clock all duration assertions are measured with.
+ */
+using Clock = std::chrono::steady_clock;
+
+/*!
+ * Measures a single call of \p inFunct in [ns] - uncorrected raw value.
+ * \param inFunct The code to measure.
+ * \return The raw elapsed time in [ns] including the harness overhead.
+ * \see clockOverheadNs()
+ */
+template <typename FUNCT>
+double _measureOnceNs(FUNCT& inFunct)
+{
+    const Clock::time_point start = Clock::now();
+    inFunct();
+    const Clock::time_point stop = Clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+/*!
+ * Returns the overhead of an empty measurement in [ns].
+ * The value is calibrated once (the best of 1000 empty measurements) and will
+ * be subtracted from every measured duration.
+ * \return The calibrated harness overhead in [ns].
+ */
+inline double clockOverheadNs()
+{
+    static const double sOverheadNs = []() {
+        auto emptyFunct = [](){};
+        double best = _measureOnceNs(emptyFunct);
+        for (unsigned int i = 1; i < 1000; ++i)
+        {
+            best = std::min(best, _measureOnceNs(emptyFunct));
+        }
+        return best;
+    }();
+    return sOverheadNs;
+}
+
+/*!
+ * Measures the duration of \p inFunct with the harness overhead subtracted.
+ * \param inFunct The code to measure.
+ * \param inRepetitions How often to run \p inFunct. The best (minimal) run
+ *        is returned in order to reduce the noise caused by the system.
+ * \return The measured duration in [ns].
+ * \see measurePercentileNs()
+ */
+template <typename FUNCT>
+double measureDurationNs(FUNCT inFunct, unsigned int inRepetitions = 1)
+{
+    double best = _measureOnceNs(inFunct);
+    for (unsigned int i = 1; i < inRepetitions; ++i)
+    {
+        best = std::min(best, _measureOnceNs(inFunct));
+    }
+    return std::max(0.0, best - clockOverheadNs());
+}
+
+/*!
+ * Determines the percentile of some samples by the nearest rank method.
+ * \param ioSamples The samples. Note that their order will be changed!
+ * \param inPercentile The percentile to determine [0..100].
+ * \return The sample of the rank \p inPercentile or 0 if \p ioSamples is empty.
+ */
+inline double percentile(std::vector<double>& ioSamples, double inPercentile)
+{
+    if (ioSamples.empty())
+    {
+        return 0.0;
+    }
+    const double rank = (inPercentile / 100.0) * ioSamples.size();
+    std::size_t idx = static_cast<std::size_t>(std::ceil(rank));
+    idx = (0 == idx) ? 0 : std::min(idx, ioSamples.size()) - 1;
+    std::nth_element(ioSamples.begin(), ioSamples.begin() + idx, ioSamples.end());
+    return ioSamples[idx];
+}
+
+/*!
+ * Measures \p inFunct \p inNrOfSamples times and returns the given percentile
+ * of the durations (harness overhead subtracted).
+ * \param inFunct The code to measure.
+ * \param inNrOfSamples The number of samples to take.
+ * \param inPercentile The percentile to return [0..100] (e.g. 99 for p99).
+ * \return The measured percentile in [ns].
+ * \see measureDurationNs()
+ */
+template <typename FUNCT>
+double measurePercentileNs(FUNCT inFunct, unsigned int inNrOfSamples, double inPercentile)
+{
+    std::vector<double> samples;
+    samples.reserve(inNrOfSamples);
+    const double overheadNs = clockOverheadNs();
+    for (unsigned int i = 0; i < inNrOfSamples; ++i)
+    {
+        samples.push_back(std::max(0.0, _measureOnceNs(inFunct) - overheadNs));
+    }
+    return percentile(samples, inPercentile);
+}
+
+/*
+ * Expect that some code (passed as the trailing macro arguments) runs below
+ * a given budget (an std::chrono::duration), e.g.
+ *
+ *   UT_EXPECT_DURATION_BELOW(std::chrono::milliseconds(5), {
+ *       for (unsigned int i = 0; i < 1000; ++i) { ... }
+ *   });
+ *
+ * The _N variant repeats the code and takes the best run in order to reduce noise.
+ */
+#define UT_EXPECT_DURATION_BELOW(budget, ...) UT_EXPECT_DURATION_BELOW_N(budget, 1, __VA_ARGS__)
+
+#define UT_EXPECT_DURATION_BELOW_N(budget, repetitions, ...) do{\
+  tsunit::_cntAssertionDone();\
+  const double utMeasuredNs = tsunit::measureDurationNs([&]() { __VA_ARGS__; }, (repetitions));\
+  const double utBudgetNs = std::chrono::duration<double, std::nano>(budget).count();\
+  if ( ! (utMeasuredNs < utBudgetNs) ) {\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()) {\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Duration budget exceeded in %s::%s @line %d: measured %.3f us, budget %.3f us" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__\
+            , utMeasuredNs / 1000.0, utBudgetNs / 1000.0);\
     }\
   }\
 } while(0)
 
+/*
+ * Expect that the given percentile (e.g. 99 for p99) of the durations of some
+ * code sampled \p samples times is below a budget (an std::chrono::duration).
+ */
+#define UT_EXPECT_PERCENTILE_BELOW(pct, budget, samples, ...) do{\
+  tsunit::_cntAssertionDone();\
+  const double utMeasuredNs = tsunit::measurePercentileNs([&]() { __VA_ARGS__; }, (samples), (pct));\
+  const double utBudgetNs = std::chrono::duration<double, std::nano>(budget).count();\
+  if ( ! (utMeasuredNs < utBudgetNs) ) {\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()) {\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Duration budget exceeded in %s::%s @line %d: p%g of %u samples %.3f us, budget %.3f us" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__\
+            , double(pct), static_cast<unsigned int>(samples)\
+            , utMeasuredNs / 1000.0, utBudgetNs / 1000.0);\
+    }\
+  }\
+} while(0)
+
+// ==========================================================================
+// Parameterized tests
+// ==========================================================================
+/*
+ * A parameter generator yields the parameters of a parameterized test one
+ * after another. Any class that provides
+ *
+ *   using value_type = <The type of the parameters>;
+ *   bool hasNext() const;
+ *   value_type next();
+ *
+ * may be used as a generator. The values are never materialized in memory
+ * as a whole - they are fetched lazily in small batches.
+ */
+
+/*!
+ * Generates the numbers of the half open range [first..last[ with a given step.
+ * A negative step counts down. A step of 0 or one that points away from the
+ * end is invalid - then the range is empty and the test fails.
+ * \see range()
+ */
+template <typename T>
+class Range
+{
+public:
+    using value_type = T;
+
+    Range(T inFirst, T inLast, T inStep)
+    : _next(inFirst), _last(inLast), _step(inStep)
+    , _down(inStep < T(0))
+    , _valid(_down ? not (inFirst < inLast) : ((T(0) < inStep) && not (inLast < inFirst)))
+    {
+        if (not _valid)
+        {
+            _next = _last;
+        }
+    }
+
+    bool valid() const
+    {
+        return _valid;
+    }
+
+    bool hasNext() const
+    {
+        return _down ? (_last < _next) : (_next < _last);
+    }
+
+    value_type next()
+    {
+        const T value = _next;
+        const Distance remaining = _down ? Distance(Distance(_next) - Distance(_last)) : Distance(Distance(_last) - Distance(_next));
+        const Distance stride = _down ? Distance(Distance(0) - Distance(_step)) : Distance(_step);
+        _next = (remaining > stride) ? T(_next + _step) : _last;
+        return value;
+    }
+
+private:
+    // Integral distances are unsigned - the signed ones overflow for wide ranges (e.g. [INT_MIN..INT_MAX[).
+    using Distance = typename std::conditional<std::is_integral<T>::value, std::make_unsigned<T>, std::common_type<T>>::type::type;
+
+    T _next;
+    const T _last;
+    const T _step;
+    const bool _down;
+    const bool _valid;
+}; // class Range
+
+/*!
+ * Generates the given values one after another.
+ * \see values()
+ */
+template <typename T>
+class Values
+{
+public:
+    using value_type = T;
+
+    Values(std::initializer_list<T> inValues)
+    : _values(inValues) {}
+
+    bool hasNext() const
+    {
+        return _nextIdx < _values.size();
+    }
+
+    value_type next()
+    {
+        return _values[_nextIdx++];
+    }
+
+private:
+    std::vector<T> _values;
+    std::size_t _nextIdx = 0;
+}; // class Values
+
+/*!
+ * Creates a generator for the numbers [\p inFirst..\p inLast[.
+ * \param inFirst The first number.
+ * \param inLast The number to stop before.
+ * \param inStep The distance of two numbers. This defaults to 1 if omitted.
+ * It has to point from \p inFirst to \p inLast - a negative step counts down.
+ */
+template <typename T>
+Range<T> range(T inFirst, T inLast, T inStep = T(1))
+{
+    return Range<T>(inFirst, inLast, inStep);
+}
+
+/*!
+ * Creates a generator for a (small) list of values, e.g. values({1, 5, 9}).
+ */
+template <typename T>
+Values<T> values(std::initializer_list<T> inValues)
+{
+    return Values<T>(inValues);
+}
+
+/*
+ * Describe a parameter for the report of a failed instance. Overload this
+ * for your own parameter types.
+ */
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, std::string>::type describeParam(const T& inValue)
+{
+    return std::to_string(inValue);
+}
+
+template <typename T>
+typename std::enable_if<not std::is_arithmetic<T>::value, std::string>::type describeParam(const T&)
+{
+    return "?";
+}
+
+inline std::string describeParam(const std::string& inValue)
+{
+    return "\"" + inValue + "\"";
+}
+
+/* The number of parameter instances fetched from a generator at once */
+constexpr unsigned int kParameterBatchSize = 64;
+
+/*!
+ * Returns the number of failed assertions of the calling thread so far.
+ */
+unsigned int _threadAssertionsFailed();
+
+/*!
+ * Runs \p inWork on the calling thread and on up to RunOptions::jobs - 1 idle
+ * helper threads (shared by all tests of the run) in the context of the
+ * current test. Returns after all of them finished.
+ */
+void _dispatch(const std::function<void()>& inWork);
+
+/*
+ * Asks a generator if it is valid - generators without a valid() method are.
+ */
+template <typename GENERATOR>
+auto _isValidGenerator(const GENERATOR& inGenerator, int) -> decltype(inGenerator.valid())
+{
+    return inGenerator.valid();
+}
+
+template <typename GENERATOR>
+bool _isValidGenerator(const GENERATOR&, long)
+{
+    return true;
+}
+
+/*!
+ * Runs a parameterized test for all parameters of a generator. The parameters
+ * are dispatched in batches to the worker threads.
+ * \param inGenerator The generator of the parameters.
+ * \param inTestFunct The test to run for each of the parameters.
+ */
+template <typename GENERATOR>
+void runParameterized(GENERATOR inGenerator, void(*inTestFunct)(const typename GENERATOR::value_type&))
+{
+    using Param = typename GENERATOR::value_type;
+
+    if (not _isValidGenerator(inGenerator, 0))
+    {
+        _cntAssertionDone();
+        _cntAssertionFailed();
+        if (currentLogger())
+        {
+            currentLogger()->reportFailed();
+            currentLogger()->log(ESC_COLOR_RED "*** Invalid generator (e.g. a range of the step 0) in %s::%s" ESC_COLOR_RESET "\n"
+                , currentEntry()->groupName
+                , currentEntry()->testCaseName);
+        }
+        return;
+    }
+#if defined(TSUNIT_WITH_THREADS)
+    std::mutex generatorMutex;
+#endif
+    unsigned long long nextInstance = 0;
+
+    _dispatch([&]() {
+        std::vector<Param> batch;
+        batch.reserve(kParameterBatchSize);
+        for (;;)
+        {
+            unsigned long long instance = 0;
+            batch.clear();
+            {
+#if defined(TSUNIT_WITH_THREADS)
+                std::lock_guard<std::mutex> lock(generatorMutex);
+#endif
+                instance = nextInstance;
+                while ((batch.size() < kParameterBatchSize) && inGenerator.hasNext())
+                {
+                    batch.push_back(inGenerator.next());
+                }
+                nextInstance += batch.size();
+            }
+
+            if (batch.empty())
+            {
+                break;
+            }
+
+            for (const Param& param : batch)
+            {
+                const unsigned int oldFailCnt = _threadAssertionsFailed();
+                inTestFunct(param);
+                const bool failed = (oldFailCnt != _threadAssertionsFailed());
+                _cntInstance(failed);
+                if (failed && pLogger)
+                {
+                    pLogger->log(ESC_COLOR_RED "*** Parameter instance #%llu (%s) failed in %s::%s" ESC_COLOR_RESET "\n"
+                        , instance
+                        , describeParam(param).c_str()
+                        , pCurrentEntry->groupName
+                        , pCurrentEntry->testCaseName);
+                }
+                ++instance;
+            }
+        }
+    });
+}
+
+/*
+ * A parameterized test. The test body will be run for every value the
+ * generator yields. Within the body this value is named "param", e.g.
+ *
+ *   TSUNIT_TEST_P(AluAdderTest, checkIfNumbersAreAddedCorrectly, tsunit::range(-1000, 1000))
+ *   {
+ *       UT_EXPECT_EQ(alu_add(param, 3), param + 3);
+ *   }
+ */
+#define TSUNIT_TEST_P(groupname,testcase,generator)\
+using groupname##_TC_##testcase##_Param = std::decay<decltype(generator)>::type::value_type;\
+extern void groupname##_TC_##testcase(const groupname##_TC_##testcase##_Param& param);\
+static void groupname##_TC_##testcase##_P() { tsunit::runParameterized(generator, groupname##_TC_##testcase); }\
+tsunit::TestCase TR_##groupname##_TC_##testcase(#groupname, #testcase, groupname##_TC_##testcase##_P, TSUNIT_TEST_ID(groupname, testcase));\
+void groupname##_TC_##testcase(const groupname##_TC_##testcase##_Param& param)
+
 int runUnitTests(int argc, char* argv[]);
 
 } // namespace tsunit
@@ -0,0 +1,540 @@
+#pragma once
+/* ==========================================================================
+ * @(#)File: TSUnitProperties.hpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "TSUnit.hpp"
+#include "TSUnitTestAddOns.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <utility>
+
+// Property based testing: Check a property against many pseudo random
+// values and shrink a failing value to a minimal counterexample.
+
+namespace tsunit {
+
+// ==========================================================================
+// The source of randomness of a single case.
+// ==========================================================================
+/*!
+ * A pseudo random generator whose sequence is determined by a seed and the
+ * index of a case only. So every case can be reproduced on its own - no
+ * matter which (or how many) threads generated the other cases.
+ */
+class CPropertyRandom
+{
+public:
+    CPropertyRandom(std::uint32_t inSeed, unsigned long long inCase)
+    : _stream(CRandomStream(inSeed).substream(inCase)) {}
+
+    /*!
+     * Returns the next pseudo random number using the full 32 bit scale.
+     */
+    std::uint32_t next32()
+    {
+        return _stream.next32();
+    }
+
+    /*!
+     * Returns the next pseudo random number using the full 64 bit scale.
+     */
+    std::uint64_t next64()
+    {
+        return _stream.next64();
+    }
+
+    /*!
+     * Returns an (unbiased) pseudo random number of the range [0..inBound[.
+     * \param inBound The upper bound. Must not be 0.
+     */
+    std::uint64_t below(std::uint64_t inBound)
+    {
+        return _stream.below(inBound);
+    }
+
+    /*!
+     * Returns a pseudo random number of the range [0..1[ with 53 bits of precision.
+     */
+    double unit()
+    {
+        return _stream.uniformDouble();
+    }
+
+private:
+    CRandomStream _stream;
+}; // class CPropertyRandom
+
+// ==========================================================================
+// The generators
+// ==========================================================================
+/*
+ * A property generator creates pseudo random values of a type and knows how
+ * to simplify them. Any class that provides
+ *
+ *   using value_type = <The type of the values>;
+ *   value_type generate(CPropertyRandom&) const;
+ *   std::vector<value_type> shrink(const value_type&) const;
+ *   std::string describe(const value_type&) const;
+ *
+ * may be used as a generator. shrink() returns some "simpler" candidates of
+ * a value - the most aggressive first - or nothing if it is minimal already.
+ */
+
+/*!
+ * Generates integers of the range [lo..hi]. These shrink towards 0 (or the
+ * bound next to it).
+ * \see anyInt()
+ */
+template <typename T>
+class IntGenerator
+{
+public:
+    using value_type = T;
+
+    IntGenerator(T inLo, T inHi) : _lo(inLo), _hi(inHi) {}
+
+    value_type generate(CPropertyRandom& ioRandom) const
+    {
+        // Prefer the edges every now and then.
+        if (0 == ioRandom.below(16))
+        {
+            const T edges[3] = {_lo, _hi, _target()};
+            return edges[ioRandom.below(3)];
+        }
+
+        const std::uint64_t span = std::uint64_t(_hi) - std::uint64_t(_lo);
+        const std::uint64_t offset = (~std::uint64_t(0) == span) ? ioRandom.next64() : ioRandom.below(span + 1);
+        return T(std::uint64_t(_lo) + offset);
+    }
+
+    std::vector<value_type> shrink(const value_type& inValue) const
+    {
+        std::vector<value_type> candidates;
+        const T target = _target();
+        if (inValue != target)
+        {
+            const bool above = (inValue > target);
+            const std::uint64_t distance = above ? std::uint64_t(inValue) - std::uint64_t(target)
+                                                 : std::uint64_t(target) - std::uint64_t(inValue);
+            candidates.push_back(target);
+            if (distance > 2)
+            {
+                candidates.push_back(T(above ? std::uint64_t(target) + distance / 2 : std::uint64_t(target) - distance / 2));
+            }
+            if (distance > 1)
+            {
+                candidates.push_back(above ? T(inValue - 1) : T(inValue + 1));
+            }
+        }
+        return candidates;
+    }
+
+    std::string describe(const value_type& inValue) const
+    {
+        return std::to_string(inValue);
+    }
+
+private:
+    T _target() const
+    {
+        return (_lo > T(0)) ? _lo : ((_hi < T(0)) ? _hi : T(0));
+    }
+
+    const T _lo;
+    const T _hi;
+}; // class IntGenerator
+
+/*!
+ * Generates floating point numbers of the range [lo..hi]. These shrink
+ * towards 0 (or the bound next to it) and to integral values.
+ * \see anyFloat()
+ */
+template <typename T>
+class FloatGenerator
+{
+public:
+    using value_type = T;
+
+    FloatGenerator(T inLo, T inHi) : _lo(inLo), _hi(inHi) {}
+
+    value_type generate(CPropertyRandom& ioRandom) const
+    {
+        if (0 == ioRandom.below(16))
+        {
+            const T edges[3] = {_lo, _hi, _target()};
+            return edges[ioRandom.below(3)];
+        }
+        const T value = _lo + (_hi - _lo) * T(ioRandom.unit());
+        return (value > _hi) ? _hi : value;
+    }
+
+    std::vector<value_type> shrink(const value_type& inValue) const
+    {
+        std::vector<value_type> candidates;
+        const T target = _target();
+        if (inValue != target)
+        {
+            candidates.push_back(target);
+            const T integral = std::trunc(inValue);
+            if ((integral != inValue) && (integral >= _lo) && (integral <= _hi))
+            {
+                candidates.push_back(integral);
+            }
+            const T half = target + (inValue - target) / T(2);
+            if ((half != inValue) && (half != target))
+            {
+                candidates.push_back(half);
+            }
+        }
+        return candidates;
+    }
+
+    std::string describe(const value_type& inValue) const
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.17g", double(inValue));
+        return buffer;
+    }
+
+private:
+    T _target() const
+    {
+        return (_lo > T(0)) ? _lo : ((_hi < T(0)) ? _hi : T(0));
+    }
+
+    const T _lo;
+    const T _hi;
+}; // class FloatGenerator
+
+/*!
+ * Generates std::vectors of up to maxLength elements of another generator.
+ * These shrink by removing elements first and by shrinking the elements then.
+ * \see anyVector()
+ * \see anyBytes()
+ */
+template <typename ELEMENT_GENERATOR>
+class VectorGenerator
+{
+public:
+    using element_type = typename ELEMENT_GENERATOR::value_type;
+    using value_type = std::vector<element_type>;
+
+    VectorGenerator(const ELEMENT_GENERATOR& inElementGenerator, std::size_t inMaxLength)
+    : _elementGenerator(inElementGenerator), _maxLength(inMaxLength) {}
+
+    value_type generate(CPropertyRandom& ioRandom) const
+    {
+        value_type value(static_cast<std::size_t>(ioRandom.below(_maxLength + 1)));
+        for (element_type& element : value)
+        {
+            element = _elementGenerator.generate(ioRandom);
+        }
+        return value;
+    }
+
+    std::vector<value_type> shrink(const value_type& inValue) const
+    {
+        std::vector<value_type> candidates;
+        if (inValue.empty())
+        {
+            return candidates;
+        }
+
+        // Remove elements: All, a half, and one after another.
+        candidates.push_back(value_type());
+        if (inValue.size() > 1)
+        {
+            const std::size_t half = inValue.size() / 2;
+            candidates.push_back(value_type(inValue.begin(), inValue.begin() + half));
+            candidates.push_back(value_type(inValue.begin() + half, inValue.end()));
+        }
+        for (std::size_t i = 0; i < inValue.size(); ++i)
+        {
+            value_type candidate(inValue);
+            candidate.erase(candidate.begin() + i);
+            candidates.push_back(candidate);
+        }
+
+        // Shrink the elements
+        for (std::size_t i = 0; i < inValue.size(); ++i)
+        {
+            for (const element_type& element : _elementGenerator.shrink(inValue[i]))
+            {
+                value_type candidate(inValue);
+                candidate[i] = element;
+                candidates.push_back(candidate);
+            }
+        }
+        return candidates;
+    }
+
+    std::string describe(const value_type& inValue) const
+    {
+        std::string description("{");
+        for (std::size_t i = 0; i < inValue.size(); ++i)
+        {
+            description.append(i ? ", " : "");
+            description.append(_elementGenerator.describe(inValue[i]));
+        }
+        return description.append("}");
+    }
+
+private:
+    const ELEMENT_GENERATOR _elementGenerator;
+    const std::size_t _maxLength;
+}; // class VectorGenerator
+
+/*!
+ * Generates std::pairs of two other generators. Both halves shrink on their own.
+ * \see anyPair()
+ */
+template <typename FIRST_GENERATOR, typename SECOND_GENERATOR>
+class PairGenerator
+{
+public:
+    using value_type = std::pair<typename FIRST_GENERATOR::value_type, typename SECOND_GENERATOR::value_type>;
+
+    PairGenerator(const FIRST_GENERATOR& inFirst, const SECOND_GENERATOR& inSecond)
+    : _first(inFirst), _second(inSecond) {}
+
+    value_type generate(CPropertyRandom& ioRandom) const
+    {
+        const typename FIRST_GENERATOR::value_type first = _first.generate(ioRandom);
+        return value_type(first, _second.generate(ioRandom));
+    }
+
+    std::vector<value_type> shrink(const value_type& inValue) const
+    {
+        std::vector<value_type> candidates;
+        for (const typename FIRST_GENERATOR::value_type& first : _first.shrink(inValue.first))
+        {
+            candidates.push_back(value_type(first, inValue.second));
+        }
+        for (const typename SECOND_GENERATOR::value_type& second : _second.shrink(inValue.second))
+        {
+            candidates.push_back(value_type(inValue.first, second));
+        }
+        return candidates;
+    }
+
+    std::string describe(const value_type& inValue) const
+    {
+        return "(" + _first.describe(inValue.first) + ", " + _second.describe(inValue.second) + ")";
+    }
+
+private:
+    const FIRST_GENERATOR _first;
+    const SECOND_GENERATOR _second;
+}; // class PairGenerator
+
+/*!
+ * Creates a generator for integers of the range [\p inLo..\p inHi].
+ */
+template <typename T>
+IntGenerator<T> anyInt(T inLo = std::numeric_limits<T>::min(), T inHi = std::numeric_limits<T>::max())
+{
+    return IntGenerator<T>(inLo, inHi);
+}
+
+/*!
+ * Creates a generator for floating point numbers of the range [\p inLo..\p inHi].
+ */
+template <typename T>
+FloatGenerator<T> anyFloat(T inLo, T inHi)
+{
+    return FloatGenerator<T>(inLo, inHi);
+}
+
+/*!
+ * Creates a generator for std::vectors of up to \p inMaxLength elements of \p inElementGenerator.
+ */
+template <typename ELEMENT_GENERATOR>
+VectorGenerator<ELEMENT_GENERATOR> anyVector(const ELEMENT_GENERATOR& inElementGenerator, std::size_t inMaxLength)
+{
+    return VectorGenerator<ELEMENT_GENERATOR>(inElementGenerator, inMaxLength);
+}
+
+/*!
+ * Creates a generator for byte buffers (std::vector<std::uint8_t>) of up to \p inMaxLength bytes.
+ */
+inline VectorGenerator<IntGenerator<std::uint8_t> > anyBytes(std::size_t inMaxLength)
+{
+    return anyVector(anyInt<std::uint8_t>(), inMaxLength);
+}
+
+/*!
+ * Creates a generator for std::pairs of the values of two generators.
+ */
+template <typename FIRST_GENERATOR, typename SECOND_GENERATOR>
+PairGenerator<FIRST_GENERATOR, SECOND_GENERATOR> anyPair(const FIRST_GENERATOR& inFirst, const SECOND_GENERATOR& inSecond)
+{
+    return PairGenerator<FIRST_GENERATOR, SECOND_GENERATOR>(inFirst, inSecond);
+}
+
+// ==========================================================================
+// The engine
+// ==========================================================================
+template <typename T>
+struct PropertyResult
+{
+    bool failed = false;
+    std::uint32_t seed = 0;
+    unsigned long long failedCase = 0;  // The index of the first failed case
+    T counterexample{};                 // The shrunk value of this case
+    unsigned int shrinks = 0;           // The number of successful shrinks
+};
+
+/* The number of cases a thread checks at once */
+constexpr unsigned int kPropertyChunkSize = 256;
+
+/* Stop shrinking after this number of steps */
+constexpr unsigned int kMaxShrinks = 10000;
+
+/*!
+ * Checks a property for a number of pseudo random values. The cases are
+ * checked on up to RunOptions::jobs threads - so the property has to be
+ * thread safe then. The result neither depends on the number of threads:
+ * the first failing case is found and shrunk to a minimal counterexample.
+ *
+ * \param inGenerator The generator of the values.
+ * \param inCases The number of cases to check.
+ * \param inSeed The seed. The same seed will check the very same values.
+ * \param inProperty A function that returns true if the property holds for
+ *        a value of the generator.
+ * \return The result of the check.
+ */
+template <typename GENERATOR, typename PROPERTY>
+PropertyResult<typename GENERATOR::value_type> checkProperty(const GENERATOR& inGenerator, unsigned long long inCases, std::uint32_t inSeed, PROPERTY inProperty)
+{
+    using Value = typename GENERATOR::value_type;
+
+#if defined(TSUNIT_WITH_THREADS)
+    std::mutex mutex;
+#endif
+    unsigned long long nextCase = 0;
+    unsigned long long firstFailedCase = inCases;
+
+    _dispatch([&]() {
+        for (;;)
+        {
+            unsigned long long first = 0;
+            unsigned long long last = 0;
+            {
+#if defined(TSUNIT_WITH_THREADS)
+                std::lock_guard<std::mutex> lock(mutex);
+#endif
+                first = nextCase;
+                last = std::min(first + kPropertyChunkSize, firstFailedCase);
+                nextCase = std::max(first, last);
+            }
+            if (first >= last)
+            {
+                break;
+            }
+
+            for (unsigned long long i = first; i < last; ++i)
+            {
+                CPropertyRandom random(inSeed, i);
+                if (not inProperty(inGenerator.generate(random)))
+                {
+#if defined(TSUNIT_WITH_THREADS)
+                    std::lock_guard<std::mutex> lock(mutex);
+#endif
+                    firstFailedCase = std::min(firstFailedCase, i);
+                    break;
+                }
+            }
+        }
+    });
+
+    PropertyResult<Value> result;
+    result.seed = inSeed;
+    if (firstFailedCase < inCases)
+    {
+        result.failed = true;
+        result.failedCase = firstFailedCase;
+
+        CPropertyRandom random(inSeed, firstFailedCase);
+        result.counterexample = inGenerator.generate(random);
+
+        bool shrunk = true;
+        while (shrunk && (result.shrinks < kMaxShrinks))
+        {
+            shrunk = false;
+            for (const Value& candidate : inGenerator.shrink(result.counterexample))
+            {
+                if (not inProperty(candidate))
+                {
+                    result.counterexample = candidate;
+                    ++result.shrinks;
+                    shrunk = true;
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/*
+ * Expect that a property (a function returning a bool - passed as the
+ * trailing macro arguments) holds for a number of values of a generator, e.g.
+ *
+ *   UT_EXPECT_PROPERTY(tsunit::anyInt<int>(-1000, 1000), 100000, [](int x) {
+ *       return alu_sub(alu_add(x, 3), 3) == x;
+ *   });
+ *
+ * The seed is taken from tsunit::pseudoRandom(). The _SEED variant uses a
+ * fixed seed in order to replay a reported failure.
+ */
+#define UT_EXPECT_PROPERTY(generator, cases, ...) UT_EXPECT_PROPERTY_SEED(generator, cases, tsunit::pseudoRandom(), __VA_ARGS__)
+
+#define UT_EXPECT_PROPERTY_SEED(generator, cases, replaySeed, ...) do{\
+  tsunit::_cntAssertionDone();\
+  const auto utGenerator = (generator);\
+  const auto utResult = tsunit::checkProperty(utGenerator, (cases), (replaySeed), __VA_ARGS__);\
+  if (utResult.failed) {\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()) {\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Property failed in %s::%s @line %d at case %llu (replay by seed %u): %s (shrunk %u times)" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__\
+            , utResult.failedCase, utResult.seed\
+            , utGenerator.describe(utResult.counterexample).c_str(), utResult.shrinks);\
+    }\
+  }\
+} while(0)
+
+} // namespace tsunit
@@ -29,9 +29,41 @@
  *
  * ========================================================================== */
 #include "TSUnitTestAddOns.hpp"
+#include "TSUnit.hpp"
 #include <cstdlib>
 #include <stdio.h>
 #include <cassert>
+#include <cstddef>
+#include <cctype>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <cmath>
+
+#if defined(TSUNIT_WITH_THREADS)
+    #include <atomic>
+    #include <thread>
+#endif
+
+#if !defined(CROSS_BUILD) && (defined(__unix__) || defined(__APPLE__))
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define TSUNIT_HASH_WITH_MMAP
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    #include <immintrin.h>
+    #define TSUNIT_HASH_WITH_SSE2
+    #define TSUNIT_HASH_WITH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define TSUNIT_HASH_WITH_SSE2
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    #include <arm_neon.h>
+    #define TSUNIT_HASH_WITH_NEON
+#endif
 
 // Some Useful addons for Unittest...
 
@@ -41,30 +73,22 @@
 
 namespace tsunit {
 
-static std::uint32_t _rot32r(std::uint32_t inNum, unsigned int places)
+constexpr static std::uint32_t _rot32r(std::uint32_t inNum, unsigned int places)
 {
-    places &= 0x1f;
-    return (inNum >> places) | (inNum << (32-places));
+    return (0 != (places & 0x1f)) ? (inNum >> (places & 0x1f)) | (inNum << (32 - (places & 0x1f))) : inNum;
 }
 
 template<unsigned int FROM_POS,unsigned int TO_POS>
 constexpr static std::uint32_t _swapBits(std::uint32_t inValue)
 {
-    constexpr unsigned int shiftDistance = (TO_POS >= FROM_POS ?
-    		TO_POS - FROM_POS
-          : FROM_POS - TO_POS);
-
-    constexpr uint32_t from_mask = (1ul<<FROM_POS);
-    constexpr uint32_t to_mask   = (1ul<<TO_POS);
-    constexpr uint32_t all_mask = from_mask | to_mask;
-
-    return  (inValue & ~all_mask)
-        | (((inValue & from_mask) << shiftDistance)
-        | ((inValue & to_mask)   >> shiftDistance));
+    // shiftDistance is (TO_POS >= FROM_POS ? TO_POS - FROM_POS : FROM_POS - TO_POS)
+    return  (inValue & ~((std::uint32_t(1)<<FROM_POS) | (std::uint32_t(1)<<TO_POS)))
+        | (((inValue & (std::uint32_t(1)<<FROM_POS)) << (TO_POS >= FROM_POS ? TO_POS - FROM_POS : FROM_POS - TO_POS))
+        | ((inValue & (std::uint32_t(1)<<TO_POS))   >> (TO_POS >= FROM_POS ? TO_POS - FROM_POS : FROM_POS - TO_POS)));
 }
 
 // =======================================================================================
-static std::uint32_t _scramble0(std::uint32_t param)
+constexpr static std::uint32_t _scramble0(std::uint32_t param)
 {
     return _swapBits<23,16>(param)
          | _swapBits<25,13>(param)
@@ -85,7 +109,7 @@ static std::uint32_t _scramble0(std::uint32_t param)
          ;
 }
 
-static std::uint32_t _scramble1(std::uint32_t param)
+constexpr static std::uint32_t _scramble1(std::uint32_t param)
 {
     return _swapBits<7,19>(param)
          | _swapBits<30,6>(param)
@@ -106,7 +130,7 @@ static std::uint32_t _scramble1(std::uint32_t param)
          ;
 }
 
-static std::uint32_t _scramble2(std::uint32_t param)
+constexpr static std::uint32_t _scramble2(std::uint32_t param)
 {
     return _swapBits<28,30>(param)
          | _swapBits<10,31>(param)
@@ -127,7 +151,7 @@ static std::uint32_t _scramble2(std::uint32_t param)
          ;
 }
 
-static std::uint32_t _scramble3(std::uint32_t param)
+constexpr static std::uint32_t _scramble3(std::uint32_t param)
 {
     return _swapBits<17,22>(param)
          | _swapBits<20,16>(param)
@@ -148,21 +172,32 @@ static std::uint32_t _scramble3(std::uint32_t param)
          ;
 }
 
-typedef std::uint32_t(*ScrambleFunct)(uint32_t);
+constexpr static std::uint32_t _scramble(unsigned int inFunctIdx, std::uint32_t param)
+{
+    return (0 == inFunctIdx) ? _scramble0(param)
+         : (1 == inFunctIdx) ? _scramble1(param)
+         : (2 == inFunctIdx) ? _scramble2(param)
+         :                     _scramble3(param);
+}
 
-static uint32_t _noiseNumber(std::uint32_t inIndex)
-{
-    static const uint32_t kNoiseTable[32] = {
-          0x347cf746ul, 0x7b840e02ul, 0x4b6e3c4eul, 0x489b06c6ul
-        , 0x2ba14c6eul, 0x4572434aul, 0x04600530ul, 0x7f9acc78ul
-        , 0x50a98955ul, 0x071b0827ul, 0x15690047ul, 0x6c68f552ul
-        , 0x5fc52edful, 0x61ca273bul, 0x44e4c5f4ul, 0x6a8f5fc5ul
-        , 0x01fc910aul, 0x29e9de3ful, 0x2788c41eul, 0x6b5c5ce4ul
-        , 0x39d672deul, 0x6d7680bful, 0x511f385dul, 0x577fa18ful
-        , 0x7aa4ca0dul, 0x671710edul, 0x127e0c78ul, 0x567cb335ul
-        , 0x65f0a296ul, 0x3f0eaf85ul, 0x4e838e1ful, 0x1a6d99ddul
-    };
+static constexpr uint32_t kNoiseTable[32] = {
+      0x347cf746ul, 0x7b840e02ul, 0x4b6e3c4eul, 0x489b06c6ul
+    , 0x2ba14c6eul, 0x4572434aul, 0x04600530ul, 0x7f9acc78ul
+    , 0x50a98955ul, 0x071b0827ul, 0x15690047ul, 0x6c68f552ul
+    , 0x5fc52edful, 0x61ca273bul, 0x44e4c5f4ul, 0x6a8f5fc5ul
+    , 0x01fc910aul, 0x29e9de3ful, 0x2788c41eul, 0x6b5c5ce4ul
+    , 0x39d672deul, 0x6d7680bful, 0x511f385dul, 0x577fa18ful
+    , 0x7aa4ca0dul, 0x671710edul, 0x127e0c78ul, 0x567cb335ul
+    , 0x65f0a296ul, 0x3f0eaf85ul, 0x4e838e1ful, 0x1a6d99ddul
+};
 
+// =======================================================================================
+// The reference implementation of the hash
+// =======================================================================================
+typedef std::uint32_t(*ScrambleFunct)(uint32_t);
+
+static uint32_t _noiseNumberReference(std::uint32_t inIndex)
+{
     const unsigned int noiseIdx = (inIndex & 0x1f);
 
     static const ScrambleFunct scrambleFunct[] {
@@ -174,6 +209,76 @@ static uint32_t _noiseNumber(std::uint32_t inIndex)
     return scrambleFunct[scrambleFuncIdx](inIndex - kNoiseTable[noiseIdx]);
 }
 
+std::uint32_t hashReference(const void* inDataPtr, unsigned int inDataSize)
+{
+    const uint8_t* dataPtr = static_cast<const uint8_t*>(inDataPtr);
+    uint32_t cs = 0xac3b843bul;
+
+    for (;inDataSize;--inDataSize)
+    {
+        const uint32_t thisDataWord  = (*dataPtr++);
+
+        cs += _noiseNumberReference((thisDataWord >> 4) + cs);
+        cs += _noiseNumberReference(cs + thisDataWord * 238);
+        cs ^= _noiseNumberReference(_rot32r(1057592071 + thisDataWord, 15));
+    }
+    return cs;
+}
+
+// =======================================================================================
+// The table driven implementation of the hash
+// =======================================================================================
+/*
+ * Every _scrambleN() just ORs some masked and shifted copies of its parameter.
+ * Hence _scrambleN(a | b) == _scrambleN(a) | _scrambleN(b) and a scramble of
+ * a 32 bit word is the OR of the scrambles of its 4 bytes. These are looked
+ * up in tables that are calculated at compile time.
+ */
+template <std::size_t... I> struct IndexList {};
+template <std::size_t N, std::size_t... I> struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template <std::size_t... I> struct MakeIndexList<0, I...> { using type = IndexList<I...>; };
+
+struct HashTables
+{
+    std::uint32_t scramble[4][4][256]; // [scramble function][byte position][byte value]
+    std::uint32_t byteNoise[256];      // The 3rd noise number of hash() only depends on the data byte
+};
+
+constexpr static std::uint32_t _noiseNumber(std::uint32_t inIndex)
+{
+    return _scramble(inIndex & 3, inIndex - kNoiseTable[inIndex & 0x1f]);
+}
+
+#define SCRAMBLE_TABLE(funct) \
+    {  {_scramble(funct, std::uint32_t(I) <<  0)...} \
+     , {_scramble(funct, std::uint32_t(I) <<  8)...} \
+     , {_scramble(funct, std::uint32_t(I) << 16)...} \
+     , {_scramble(funct, std::uint32_t(I) << 24)...} }
+
+template <std::size_t... I>
+constexpr static HashTables _makeHashTables(IndexList<I...>)
+{
+    return HashTables{
+          { SCRAMBLE_TABLE(0), SCRAMBLE_TABLE(1), SCRAMBLE_TABLE(2), SCRAMBLE_TABLE(3) }
+        , { _noiseNumber(_rot32r(1057592071 + std::uint32_t(I), 15))... }
+    };
+}
+
+#undef SCRAMBLE_TABLE
+
+static constexpr HashTables kHashTables = _makeHashTables(MakeIndexList<256>::type());
+
+static inline std::uint32_t _noiseNumberFast(std::uint32_t inIndex)
+{
+    const std::uint32_t value = inIndex - kNoiseTable[inIndex & 0x1f];
+    const std::uint32_t (&table)[4][256] = kHashTables.scramble[inIndex & 3];
+
+    return table[0][value & 0xff]
+         | table[1][(value >>  8) & 0xff]
+         | table[2][(value >> 16) & 0xff]
+         | table[3][(value >> 24)];
+}
+
 std::uint32_t hash(const void* inDataPtr, unsigned int inDataSize)
 {
     const uint8_t* dataPtr = static_cast<const uint8_t*>(inDataPtr);
@@ -183,14 +288,649 @@ std::uint32_t hash(const void* inDataPtr, unsigned int inDataSize)
     {
         const uint32_t thisDataWord  = (*dataPtr++);
 
-        cs += _noiseNumber((thisDataWord >> 4) + cs);
-        cs += _noiseNumber(cs + thisDataWord * 238);
-        cs ^= _noiseNumber(_rot32r(1057592071 + thisDataWord, 15));
+        cs += _noiseNumberFast((thisDataWord >> 4) + cs);
+        cs += _noiseNumberFast(cs + thisDataWord * 238);
+        cs ^= kHashTables.byteNoise[thisDataWord];
     }
     return cs;
 }
 
-static std::uint32_t randomSeed = 0x3ac4821cul;
+// =======================================================================================
+// The multi lane hash (HashVersion::MULTILANE_V1)
+// =======================================================================================
+/*
+ * The data is split into stripes of 32 bytes. Each of the 8 lanes takes one
+ * (little endian) 32 bit word of every stripe and accumulates it like xxHash32
+ * does. Since the lanes do not depend on each other they are calculated in
+ * SIMD registers. The lanes, the remaining tail and the size are folded into
+ * the hash at the end - by the very same (scalar) code for all implementations.
+ */
+static constexpr std::uint32_t kPrime1 = 2654435761ul;
+static constexpr std::uint32_t kPrime2 = 2246822519ul;
+static constexpr std::uint32_t kPrime3 = 3266489917ul;
+static constexpr std::uint32_t kPrime4 =  668265263ul;
+static constexpr std::uint32_t kPrime5 =  374761393ul;
+
+static constexpr unsigned int kNrOfLanes = 8;
+static constexpr unsigned int kStripeSize = kNrOfLanes * sizeof(std::uint32_t);
+
+typedef void(*MultiLaneStripesFunct)(std::uint32_t* ioLanes, const std::uint8_t* inDataPtr, std::size_t inNrOfStripes);
+
+static inline std::uint32_t _read32le(const std::uint8_t* inDataPtr)
+{
+    return  std::uint32_t(inDataPtr[0])
+         | (std::uint32_t(inDataPtr[1]) <<  8)
+         | (std::uint32_t(inDataPtr[2]) << 16)
+         | (std::uint32_t(inDataPtr[3]) << 24);
+}
+
+static void _multiLaneStripesScalar(std::uint32_t* ioLanes, const std::uint8_t* inDataPtr, std::size_t inNrOfStripes)
+{
+    for (;inNrOfStripes;--inNrOfStripes, inDataPtr += kStripeSize)
+    {
+        for (unsigned int i=0; i < kNrOfLanes; ++i)
+        {
+            ioLanes[i] = rotl<13>(ioLanes[i] + _read32le(inDataPtr + i * sizeof(std::uint32_t)) * kPrime2) * kPrime1;
+        }
+    }
+}
+
+#if defined(TSUNIT_HASH_WITH_SSE2)
+// SSE2 lacks a 32 bit multiplication - so do it on the even and the odd lanes.
+static inline __m128i _mullo32Sse2(__m128i inA, __m128i inB)
+{
+    const __m128i even = _mm_mul_epu32(inA, inB);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(inA, 32), _mm_srli_epi64(inB, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i _roundSse2(__m128i inLanes, __m128i inData)
+{
+    const __m128i sum = _mm_add_epi32(inLanes, _mullo32Sse2(inData, _mm_set1_epi32(int(kPrime2))));
+    return _mullo32Sse2(_mm_or_si128(_mm_slli_epi32(sum, 13), _mm_srli_epi32(sum, 19)), _mm_set1_epi32(int(kPrime1)));
+}
+
+static void _multiLaneStripesSse2(std::uint32_t* ioLanes, const std::uint8_t* inDataPtr, std::size_t inNrOfStripes)
+{
+    __m128i lanes0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ioLanes));
+    __m128i lanes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ioLanes + 4));
+    for (;inNrOfStripes;--inNrOfStripes, inDataPtr += kStripeSize)
+    {
+        lanes0 = _roundSse2(lanes0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(inDataPtr)));
+        lanes1 = _roundSse2(lanes1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(inDataPtr + 16)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ioLanes), lanes0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ioLanes + 4), lanes1);
+}
+#endif // defined(TSUNIT_HASH_WITH_SSE2)
+
+#if defined(TSUNIT_HASH_WITH_AVX2)
+__attribute__((target("avx2")))
+static void _multiLaneStripesAvx2(std::uint32_t* ioLanes, const std::uint8_t* inDataPtr, std::size_t inNrOfStripes)
+{
+    const __m256i prime1 = _mm256_set1_epi32(int(kPrime1));
+    const __m256i prime2 = _mm256_set1_epi32(int(kPrime2));
+
+    __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ioLanes));
+    for (;inNrOfStripes;--inNrOfStripes, inDataPtr += kStripeSize)
+    {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inDataPtr));
+        lanes = _mm256_add_epi32(lanes, _mm256_mullo_epi32(data, prime2));
+        lanes = _mm256_or_si256(_mm256_slli_epi32(lanes, 13), _mm256_srli_epi32(lanes, 19));
+        lanes = _mm256_mullo_epi32(lanes, prime1);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ioLanes), lanes);
+}
+
+static bool _cpuSupportsAvx2()
+{
+    return __builtin_cpu_supports("avx2");
+}
+#endif // defined(TSUNIT_HASH_WITH_AVX2)
+
+static bool _cpuSupportsAll()
+{
+    return true;
+}
+
+#if defined(TSUNIT_HASH_WITH_NEON)
+static inline uint32x4_t _roundNeon(uint32x4_t inLanes, uint32x4_t inData)
+{
+    const uint32x4_t sum = vaddq_u32(inLanes, vmulq_u32(inData, vdupq_n_u32(kPrime2)));
+    return vmulq_u32(vorrq_u32(vshlq_n_u32(sum, 13), vshrq_n_u32(sum, 19)), vdupq_n_u32(kPrime1));
+}
+
+static void _multiLaneStripesNeon(std::uint32_t* ioLanes, const std::uint8_t* inDataPtr, std::size_t inNrOfStripes)
+{
+    uint32x4_t lanes0 = vld1q_u32(ioLanes);
+    uint32x4_t lanes1 = vld1q_u32(ioLanes + 4);
+    for (;inNrOfStripes;--inNrOfStripes, inDataPtr += kStripeSize)
+    {
+        lanes0 = _roundNeon(lanes0, vreinterpretq_u32_u8(vld1q_u8(inDataPtr)));
+        lanes1 = _roundNeon(lanes1, vreinterpretq_u32_u8(vld1q_u8(inDataPtr + 16)));
+    }
+    vst1q_u32(ioLanes, lanes0);
+    vst1q_u32(ioLanes + 4, lanes1);
+}
+#endif // defined(TSUNIT_HASH_WITH_NEON)
+
+struct MultiLaneEngine
+{
+    const char* name;
+    MultiLaneStripesFunct stripesFunct;
+    bool (*cpuSupports)();
+};
+
+static bool _isEqualIgnoringCase(const char* inLeft, const char* inRight)
+{
+    for (;*inLeft && (tolower(*inLeft) == tolower(*inRight)); ++inLeft, ++inRight) {}
+    return tolower(*inLeft) == tolower(*inRight);
+}
+
+static MultiLaneEngine _selectMultiLaneEngine()
+{
+    static const MultiLaneEngine engines[] = {
+#if defined(TSUNIT_HASH_WITH_AVX2)
+        {"AVX2", _multiLaneStripesAvx2, _cpuSupportsAvx2},
+#endif
+#if defined(TSUNIT_HASH_WITH_SSE2)
+        {"SSE2", _multiLaneStripesSse2, _cpuSupportsAll},
+#endif
+#if defined(TSUNIT_HASH_WITH_NEON)
+        {"NEON", _multiLaneStripesNeon, _cpuSupportsAll},
+#endif
+        {"scalar", _multiLaneStripesScalar, _cpuSupportsAll}
+    };
+
+    // The implementation may be forced (e.g. to verify it) - if the CPU supports it.
+    const char* forcedEngine = getenv("TSUNIT_HASH_ENGINE");
+    for (const MultiLaneEngine& engine : engines)
+    {
+        if (forcedEngine && _isEqualIgnoringCase(forcedEngine, engine.name))
+        {
+            if (engine.cpuSupports())
+            {
+                return engine;
+            }
+            fprintf(stderr, "*** TSUNIT_HASH_ENGINE=%s is not supported by this CPU - ignoring it\n", forcedEngine);
+        }
+    }
+
+    // The engines are sorted by their speed.
+    for (const MultiLaneEngine& engine : engines)
+    {
+        if (engine.cpuSupports())
+        {
+            return engine;
+        }
+    }
+    return engines[dimof(engines) - 1];
+}
+
+static const MultiLaneEngine& _multiLaneEngine()
+{
+    static const MultiLaneEngine engine = _selectMultiLaneEngine();
+    return engine;
+}
+
+static std::uint32_t _hashMultiLane(const void* inDataPtr, unsigned int inDataSize, MultiLaneStripesFunct inStripesFunct)
+{
+    const std::uint8_t* dataPtr = static_cast<const std::uint8_t*>(inDataPtr);
+
+    std::uint32_t lanes[kNrOfLanes];
+    for (unsigned int i=0; i < kNrOfLanes; ++i)
+    {
+        lanes[i] = 0xac3b843bul + kPrime1 * (i + 1);
+    }
+
+    const std::size_t nrOfStripes = inDataSize / kStripeSize;
+    inStripesFunct(lanes, dataPtr, nrOfStripes);
+    dataPtr += nrOfStripes * kStripeSize;
+    inDataSize -= static_cast<unsigned int>(nrOfStripes * kStripeSize);
+
+    // Fold the lanes...
+    std::uint32_t cs = kPrime5 + static_cast<std::uint32_t>(nrOfStripes * kStripeSize + inDataSize);
+    for (unsigned int i=0; i < kNrOfLanes; ++i)
+    {
+        cs = rotl<17>(cs + lanes[i] * kPrime3) * kPrime4;
+    }
+
+    // ... the remaining tail ...
+    for (;inDataSize >= sizeof(std::uint32_t); inDataSize -= sizeof(std::uint32_t), dataPtr += sizeof(std::uint32_t))
+    {
+        cs = rotl<17>(cs + _read32le(dataPtr) * kPrime3) * kPrime4;
+    }
+    for (;inDataSize;--inDataSize)
+    {
+        cs = rotl<11>(cs + (*dataPtr++) * kPrime5) * kPrime1;
+    }
+
+    // ... and let every bit of the hash depend on every bit of the data.
+    cs ^= cs >> 15;
+    cs *= kPrime2;
+    cs ^= cs >> 13;
+    cs *= kPrime3;
+    cs ^= cs >> 16;
+    return cs;
+}
+
+std::uint32_t hashMultiLaneScalar(const void* inDataPtr, unsigned int inDataSize)
+{
+    return _hashMultiLane(inDataPtr, inDataSize, _multiLaneStripesScalar);
+}
+
+const char* hashMultiLaneEngine()
+{
+    return _multiLaneEngine().name;
+}
+
+std::uint32_t hash(const void* inDataPtr, unsigned int inDataSize, HashVersion inVersion)
+{
+    switch (inVersion)
+    {
+    case HashVersion::MULTILANE_V1:
+        return _hashMultiLane(inDataPtr, inDataSize, _multiLaneEngine().stripesFunct);
+
+    case HashVersion::LEGACY:
+    default:
+        return hash(inDataPtr, inDataSize);
+    }
+}
+
+// =======================================================================================
+// CHasher64 (XXH64)
+// =======================================================================================
+static constexpr std::uint64_t kPrime64_1 = 0x9e3779b185ebca87ull;
+static constexpr std::uint64_t kPrime64_2 = 0xc2b2ae3d27d4eb4full;
+static constexpr std::uint64_t kPrime64_3 = 0x165667b19e3779f9ull;
+static constexpr std::uint64_t kPrime64_4 = 0x85ebca77c2b2ae63ull;
+static constexpr std::uint64_t kPrime64_5 = 0x27d4eb2f165667c5ull;
+
+static inline std::uint64_t _rotl64(std::uint64_t inValue, unsigned int inBits)
+{
+    return (inValue << inBits) | (inValue >> (64 - inBits));
+}
+
+static inline std::uint64_t _read64le(const std::uint8_t* inDataPtr)
+{
+    return std::uint64_t(_read32le(inDataPtr)) | (std::uint64_t(_read32le(inDataPtr + 4)) << 32);
+}
+
+static inline std::uint64_t _xxh64Round(std::uint64_t inLane, std::uint64_t inData)
+{
+    return _rotl64(inLane + inData * kPrime64_2, 31) * kPrime64_1;
+}
+
+static inline std::uint64_t _xxh64MergeRound(std::uint64_t inHash, std::uint64_t inLane)
+{
+    return (inHash ^ _xxh64Round(0, inLane)) * kPrime64_1 + kPrime64_4;
+}
+
+void CHasher64::reset(std::uint64_t inSeed)
+{
+    _seed = inSeed;
+    _lanes[0] = inSeed + kPrime64_1 + kPrime64_2;
+    _lanes[1] = inSeed + kPrime64_2;
+    _lanes[2] = inSeed;
+    _lanes[3] = inSeed - kPrime64_1;
+    _totalSize = 0;
+    _bufferSize = 0;
+}
+
+void CHasher64::update(const void* inDataPtr, std::size_t inDataSizeInBytes)
+{
+    const std::uint8_t* dataPtr = static_cast<const std::uint8_t*>(inDataPtr);
+    _totalSize += inDataSizeInBytes;
+
+    // Complete a stripe of a former call first...
+    if (_bufferSize)
+    {
+        const std::size_t copySize = std::min(sizeof(_buffer) - _bufferSize, inDataSizeInBytes);
+        memcpy(_buffer + _bufferSize, dataPtr, copySize);
+        _bufferSize += copySize;
+        dataPtr += copySize;
+        inDataSizeInBytes -= copySize;
+        if (_bufferSize < sizeof(_buffer))
+        {
+            return;
+        }
+        for (unsigned int i=0; i < 4; ++i)
+        {
+            _lanes[i] = _xxh64Round(_lanes[i], _read64le(_buffer + 8 * i));
+        }
+        _bufferSize = 0;
+    }
+
+    // ... then all complete stripes ...
+    for (;inDataSizeInBytes >= sizeof(_buffer); inDataSizeInBytes -= sizeof(_buffer), dataPtr += sizeof(_buffer))
+    {
+        _lanes[0] = _xxh64Round(_lanes[0], _read64le(dataPtr));
+        _lanes[1] = _xxh64Round(_lanes[1], _read64le(dataPtr + 8));
+        _lanes[2] = _xxh64Round(_lanes[2], _read64le(dataPtr + 16));
+        _lanes[3] = _xxh64Round(_lanes[3], _read64le(dataPtr + 24));
+    }
+
+    // ... and keep the rest for the next call.
+    memcpy(_buffer, dataPtr, inDataSizeInBytes);
+    _bufferSize = inDataSizeInBytes;
+}
+
+std::uint64_t CHasher64::value() const
+{
+    std::uint64_t h;
+    if (_totalSize >= sizeof(_buffer))
+    {
+        h = _rotl64(_lanes[0], 1) + _rotl64(_lanes[1], 7) + _rotl64(_lanes[2], 12) + _rotl64(_lanes[3], 18);
+        for (unsigned int i=0; i < 4; ++i)
+        {
+            h = _xxh64MergeRound(h, _lanes[i]);
+        }
+    }
+    else
+    {
+        h = _seed + kPrime64_5;
+    }
+    h += _totalSize;
+
+    const std::uint8_t* dataPtr = _buffer;
+    std::size_t size = _bufferSize;
+    for (;size >= 8; size -= 8, dataPtr += 8)
+    {
+        h = _rotl64(h ^ _xxh64Round(0, _read64le(dataPtr)), 27) * kPrime64_1 + kPrime64_4;
+    }
+    if (size >= 4)
+    {
+        h = _rotl64(h ^ (std::uint64_t(_read32le(dataPtr)) * kPrime64_1), 23) * kPrime64_2 + kPrime64_3;
+        size -= 4;
+        dataPtr += 4;
+    }
+    for (;size;--size)
+    {
+        h = _rotl64(h ^ ((*dataPtr++) * kPrime64_5), 11) * kPrime64_1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime64_2;
+    h ^= h >> 29;
+    h *= kPrime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+// =======================================================================================
+// CHasher128 (MurmurHash3 x64 128)
+// =======================================================================================
+static constexpr std::uint64_t kMurmurC1 = 0x87c37b91114253d5ull;
+static constexpr std::uint64_t kMurmurC2 = 0x4cf5ad432745937full;
+
+static inline std::uint64_t _murmurMixK1(std::uint64_t inK1)
+{
+    return _rotl64(inK1 * kMurmurC1, 31) * kMurmurC2;
+}
+
+static inline std::uint64_t _murmurMixK2(std::uint64_t inK2)
+{
+    return _rotl64(inK2 * kMurmurC2, 33) * kMurmurC1;
+}
+
+static inline std::uint64_t _murmurFinalize(std::uint64_t inValue)
+{
+    inValue ^= inValue >> 33;
+    inValue *= 0xff51afd7ed558ccdull;
+    inValue ^= inValue >> 33;
+    inValue *= 0xc4ceb9fe1a85ec53ull;
+    return inValue ^ (inValue >> 33);
+}
+
+static inline void _murmurBlock(std::uint64_t& ioH1, std::uint64_t& ioH2, const std::uint8_t* inDataPtr)
+{
+    ioH1 ^= _murmurMixK1(_read64le(inDataPtr));
+    ioH1 = (_rotl64(ioH1, 27) + ioH2) * 5 + 0x52dce729;
+    ioH2 ^= _murmurMixK2(_read64le(inDataPtr + 8));
+    ioH2 = (_rotl64(ioH2, 31) + ioH1) * 5 + 0x38495ab5;
+}
+
+void CHasher128::reset(std::uint32_t inSeed)
+{
+    _h1 = inSeed;
+    _h2 = inSeed;
+    _totalSize = 0;
+    _bufferSize = 0;
+}
+
+void CHasher128::update(const void* inDataPtr, std::size_t inDataSizeInBytes)
+{
+    const std::uint8_t* dataPtr = static_cast<const std::uint8_t*>(inDataPtr);
+    _totalSize += inDataSizeInBytes;
+
+    if (_bufferSize)
+    {
+        const std::size_t copySize = std::min(sizeof(_buffer) - _bufferSize, inDataSizeInBytes);
+        memcpy(_buffer + _bufferSize, dataPtr, copySize);
+        _bufferSize += copySize;
+        dataPtr += copySize;
+        inDataSizeInBytes -= copySize;
+        if (_bufferSize < sizeof(_buffer))
+        {
+            return;
+        }
+        _murmurBlock(_h1, _h2, _buffer);
+        _bufferSize = 0;
+    }
+
+    for (;inDataSizeInBytes >= sizeof(_buffer); inDataSizeInBytes -= sizeof(_buffer), dataPtr += sizeof(_buffer))
+    {
+        _murmurBlock(_h1, _h2, dataPtr);
+    }
+
+    memcpy(_buffer, dataPtr, inDataSizeInBytes);
+    _bufferSize = inDataSizeInBytes;
+}
+
+Hash128 CHasher128::value() const
+{
+    std::uint64_t h1 = _h1;
+    std::uint64_t h2 = _h2;
+
+    // The tail (little endian)
+    std::uint64_t k1 = 0;
+    std::uint64_t k2 = 0;
+    for (std::size_t i = _bufferSize; i > 8; --i)
+    {
+        k2 = (k2 << 8) | _buffer[i - 1];
+    }
+    for (std::size_t i = std::min<std::size_t>(_bufferSize, 8); i > 0; --i)
+    {
+        k1 = (k1 << 8) | _buffer[i - 1];
+    }
+    if (_bufferSize > 8)
+    {
+        h2 ^= _murmurMixK2(k2);
+    }
+    if (_bufferSize > 0)
+    {
+        h1 ^= _murmurMixK1(k1);
+    }
+
+    h1 ^= _totalSize;
+    h2 ^= _totalSize;
+    h1 += h2;
+    h2 += h1;
+    h1 = _murmurFinalize(h1);
+    h2 = _murmurFinalize(h2);
+    h1 += h2;
+    h2 += h1;
+
+    Hash128 result;
+    result.low = h1;
+    result.high = h2;
+    return result;
+}
+
+// =======================================================================================
+// Tree hashing
+// =======================================================================================
+/*
+ * The chunk hashes are the leaves of a binary tree. Each node is the hash of
+ * its two children (an odd one is passed up unchanged). The root is hashed
+ * along with the size of the data. So the shape of the tree - and hence the
+ * root - only depends on the size of the data and of the chunks.
+ */
+static std::uint32_t _treeHashRoot(std::vector<std::uint32_t> inLevel, std::uint64_t inDataSize, std::size_t inChunkSize, HashVersion inVersion)
+{
+    while (inLevel.size() > 1)
+    {
+        std::vector<std::uint32_t> parents((inLevel.size() + 1) / 2);
+        for (std::size_t i=0; i < parents.size(); ++i)
+        {
+            if (2 * i + 1 < inLevel.size())
+            {
+                CHasher hasher(0x5acB4821ul, inVersion);
+                parents[i] = hasher.addAll(inLevel[2 * i], inLevel[2 * i + 1]).value();
+            }
+            else
+            {
+                parents[i] = inLevel[2 * i];
+            }
+        }
+        inLevel.swap(parents);
+    }
+
+    CHasher hasher(0x5acB4821ul, inVersion);
+    return hasher.addAll(inLevel.empty() ? std::uint32_t(0) : inLevel.front(), inDataSize, std::uint64_t(inChunkSize)).value();
+}
+
+TreeHash hashRange(const void* inDataPtr, std::size_t inDataSize, HashVersion inVersion, std::size_t inChunkSize, unsigned int inNrOfThreads)
+{
+    const std::uint8_t* dataPtr = static_cast<const std::uint8_t*>(inDataPtr);
+
+    TreeHash result;
+    result.dataSize = inDataSize;
+    result.chunkSize = std::min<std::size_t>(inChunkSize ? inChunkSize : kTreeHashChunkSize, 0x80000000ul);
+    result.chunkHashes.resize((inDataSize + result.chunkSize - 1) / result.chunkSize);
+
+    const std::size_t nrOfChunks = result.chunkHashes.size();
+    const std::size_t chunkSize = result.chunkSize;
+    std::uint32_t* chunkHashes = result.chunkHashes.data();
+
+#if defined(TSUNIT_WITH_THREADS)
+    std::atomic<std::size_t> nextChunk(0);
+    auto hashChunks = [&]() {
+        for (std::size_t i = nextChunk++; i < nrOfChunks; i = nextChunk++)
+        {
+            const std::size_t offset = i * chunkSize;
+            chunkHashes[i] = hash(dataPtr + offset, unsigned(std::min(chunkSize, inDataSize - offset)), inVersion);
+        }
+    };
+
+    const unsigned int nrOfThreads = unsigned(std::min<std::size_t>(inNrOfThreads ? inNrOfThreads : std::max(1u, std::thread::hardware_concurrency())
+                                                                  , std::max<std::size_t>(1, nrOfChunks)));
+    std::vector<std::thread> threads;
+    for (unsigned int i=1; i < nrOfThreads; ++i)
+    {
+        threads.push_back(std::thread(hashChunks));
+    }
+    hashChunks();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+#else
+    (void)inNrOfThreads;
+    for (std::size_t i=0; i < nrOfChunks; ++i)
+    {
+        const std::size_t offset = i * chunkSize;
+        chunkHashes[i] = hash(dataPtr + offset, unsigned(std::min(chunkSize, inDataSize - offset)), inVersion);
+    }
+#endif
+
+    result.root = _treeHashRoot(result.chunkHashes, result.dataSize, result.chunkSize, inVersion);
+    return result;
+}
+
+#if !defined(CROSS_BUILD)
+bool hashFile(const char* inPath, TreeHash& outHash, HashVersion inVersion, std::size_t inChunkSize, unsigned int inNrOfThreads)
+{
+#if defined(TSUNIT_HASH_WITH_MMAP)
+    const int fd = open(inPath, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if ((0 != fstat(fd, &fileStat)) or not S_ISREG(fileStat.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+
+    const std::size_t fileSize = std::size_t(fileStat.st_size);
+    void* mappedPtr = nullptr;
+    if (fileSize > 0)
+    {
+        mappedPtr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == mappedPtr)
+        {
+            close(fd);
+            return false;
+        }
+        madvise(mappedPtr, fileSize, MADV_WILLNEED);
+    }
+    close(fd);
+
+    outHash = hashRange(mappedPtr, fileSize, inVersion, inChunkSize, inNrOfThreads);
+
+    if (mappedPtr)
+    {
+        munmap(mappedPtr, fileSize);
+    }
+    return true;
+#else
+    // No memory mapping - so read the file as a whole.
+    FILE* file = fopen(inPath, "rb");
+    if (nullptr == file)
+    {
+        return false;
+    }
+
+    std::vector<std::uint8_t> data;
+    std::uint8_t buffer[65536];
+    for (std::size_t readCnt; 0 != (readCnt = fread(buffer, 1, sizeof(buffer), file));)
+    {
+        data.insert(data.end(), buffer, buffer + readCnt);
+    }
+    const bool success = (0 == ferror(file));
+    fclose(file);
+
+    if (success)
+    {
+        outHash = hashRange(data.data(), data.size(), inVersion, inChunkSize, inNrOfThreads);
+    }
+    return success;
+#endif
+}
+#endif // !defined(CROSS_BUILD)
+
+std::vector<std::size_t> TreeHash::diff(const TreeHash& inOther) const
+{
+    const std::size_t nrOfChunks = std::max(chunkHashes.size(), inOther.chunkHashes.size());
+
+    std::vector<std::size_t> differingChunks;
+    for (std::size_t i=0; i < nrOfChunks; ++i)
+    {
+        if ((chunkSize != inOther.chunkSize)
+            or (i >= chunkHashes.size())
+            or (i >= inOther.chunkHashes.size())
+            or (chunkHashes[i] != inOther.chunkHashes[i]))
+        {
+            differingChunks.push_back(i);
+        }
+    }
+    return differingChunks;
+}
+
+static TSUNIT_THREAD_LOCAL std::uint32_t randomSeed = 0x3ac4821cul;
 
 void pseudoRandomsetSeed(std::uint32_t inSeed)
 {
@@ -208,98 +948,358 @@ float pseudoRandomFloat(float minValue, float maxValue)
     return minValue + (maxValue - minValue) * (float(pseudoRandom()) / float(UINT32_MAX));
 }
 
-/*!
- * Specialization to add an U16 Value endian independent to the hash.
- * \param inValue The Value to add to the hash disregard of the hosts endianess.
- * \return this Hasher object after adding the uint16 value.
- *
- * \see operator+=(uint32_t)
- * \see operator+=(const uint64_t&)
- * \see operator+=(float)
- * \see operator+=(double)
- */
-template <>
-CHasher& CHasher::operator+=(uint16_t inValue)
+double pseudoRandomDouble(double minValue, double maxValue)
 {
-    operator+=(uint8_t(inValue>> 8));
-    operator+=(uint8_t(inValue>> 0));
-    return *this;
+    const std::uint64_t high = pseudoRandom();
+    const std::uint64_t bits = (high << 32) | pseudoRandom();
+    return minValue + (maxValue - minValue) * (double(bits >> 11) * (1.0 / 9007199254740992.0));
 }
 
-/*!
- * Specialization to add an U32 Value endian independent to the hash.
- * \param inValue The Value to add to the hash disregard of the hosts endianess.
- * \return this Hasher object after adding the uint16 value.
- *
- * \see operator+=(uint16_t)
- * \see operator+=(const uint64_t&)
- * \see operator+=(float)
- * \see operator+=(double)
+void pseudoRandomFill(void* outPtr, std::size_t inSize)
+{
+    // One number of the (slow) generator keys a fast stream.
+    const std::uint64_t high = pseudoRandom();
+    CRandomStream((high << 32) | pseudoRandom()).fill(outPtr, inSize);
+}
+
+CRandomStream CRandomStream::forName(const char* inName, std::uint64_t inKey)
+{
+    // The same FNV-1a as for the IDs of the tests (see testId()).
+    return CRandomStream(inKey).substream(_fnv1a(inName, kTestIdBasis));
+}
+
+/*
+ * The bulk functions calculate their numbers by their position (at()) - so
+ * the iterations do not depend on each other and may be vectorized.
  */
-template <>
-CHasher& CHasher::operator+=(uint32_t inValue)
+void CRandomStream::fill(void* outPtr, std::size_t inSize)
 {
-    operator+=(uint8_t(inValue>>24));
-    operator+=(uint8_t(inValue>>16));
-    operator+=(uint8_t(inValue>> 8));
-    operator+=(uint8_t(inValue>> 0));
-    return *this;
+    std::uint8_t* bytePtr = static_cast<std::uint8_t*>(outPtr);
+    const std::size_t nrOfWords = inSize / sizeof(std::uint64_t);
+    const std::uint64_t counter = _counter;
+
+    for (std::size_t i=0; i < nrOfWords; ++i)
+    {
+        const std::uint64_t value = at(counter + i);
+        std::uint8_t* wordPtr = bytePtr + i * sizeof(std::uint64_t);
+        wordPtr[0] = std::uint8_t(value);
+        wordPtr[1] = std::uint8_t(value >>  8);
+        wordPtr[2] = std::uint8_t(value >> 16);
+        wordPtr[3] = std::uint8_t(value >> 24);
+        wordPtr[4] = std::uint8_t(value >> 32);
+        wordPtr[5] = std::uint8_t(value >> 40);
+        wordPtr[6] = std::uint8_t(value >> 48);
+        wordPtr[7] = std::uint8_t(value >> 56);
+    }
+    _counter += nrOfWords;
+
+    const std::size_t tailSize = inSize % sizeof(std::uint64_t);
+    if (tailSize)
+    {
+        std::uint64_t value = next64();
+        for (std::uint8_t* tailPtr = bytePtr + nrOfWords * sizeof(std::uint64_t); tailPtr != bytePtr + inSize; ++tailPtr, value >>= 8)
+        {
+            *tailPtr = std::uint8_t(value);
+        }
+    }
 }
 
-/*!
- * Specialization to add an U64 Value endian independent to the hash.
- * \param inValue The Value to add to the hash disregard of the hosts endianess.
- * \return this Hasher object after adding the uint16 value.
- *
- * \see operator+=(uint16_t)
- * \see operator+=(uint32_t)
- * \see operator+=(float)
- * \see operator+=(double)
+/*
+ * Multiplies and shifts a whole block of numbers at once (see below()). Just
+ * a value whose low half is below the bound might be biased - this is rare
+ * unless the bound is huge. below() decides on it exactly, and as it may
+ * draw further numbers the next block starts right after it.
  */
-template <>
-CHasher& CHasher::operator+=(const uint64_t& inValue)
-{
-    operator+=(uint8_t(inValue>>56));
-    operator+=(uint8_t(inValue>>48));
-    operator+=(uint8_t(inValue>>40));
-    operator+=(uint8_t(inValue>>32));
-    operator+=(uint8_t(inValue>>24));
-    operator+=(uint8_t(inValue>>16));
-    operator+=(uint8_t(inValue>> 8));
-    operator+=(uint8_t(inValue>> 0));
-    return *this;
-}
-
-/*!
- * Specialization to add a 32 bit IEEE float Value endian independent to the hash.
- * \param inValue The Value to add to the hash disregard of the hosts endianess.
- * \return this Hasher object after adding the uint16 value.
- *
- * \see operator+=(uint16_t)
- * \see operator+=(uint32_t)
- * \see operator+=(const uint64_t&)
- * \see operator+=(double)
+void CRandomStream::fillBelow(std::uint64_t* outValues, std::size_t inCount, std::uint64_t inBound)
+{
+    constexpr std::size_t kBlockSize = 64;
+    std::uint64_t lows[kBlockSize];
+
+    while (inCount)
+    {
+        const std::size_t blockSize = (inCount < kBlockSize) ? inCount : kBlockSize;
+        const std::uint64_t counter = _counter;
+        for (std::size_t i=0; i < blockSize; ++i)
+        {
+            outValues[i] = _multiply(at(counter + i), inBound, lows[i]);
+        }
+
+        std::size_t accepted = 0;
+        while ((accepted < blockSize) && (lows[accepted] >= inBound))
+        {
+            ++accepted;
+        }
+        _counter += accepted;
+        outValues += accepted;
+        inCount -= accepted;
+
+        if (accepted < blockSize)
+        {
+            *outValues++ = below(inBound);
+            --inCount;
+        }
+    }
+}
+
+void CRandomStream::fillUniformDouble(double* outValues, std::size_t inCount)
+{
+    const std::uint64_t counter = _counter;
+    for (std::size_t i=0; i < inCount; ++i)
+    {
+        outValues[i] = _toDouble(at(counter + i));
+    }
+    _counter += inCount;
+}
+
+static const double kTwoPi = 6.283185307179586476925286766559;
+
+double CRandomStream::normal(double inMean, double inStdDev)
+{
+    const double u1 = 1.0 - uniformDouble(); // ]0..1]
+    const double u2 = uniformDouble();
+    return inMean + inStdDev * std::sqrt(-2.0 * std::log(u1)) * std::cos(kTwoPi * u2);
+}
+
+void CRandomStream::fillNormal(double* outValues, std::size_t inCount, double inMean, double inStdDev)
+{
+    // Every pair of uniform numbers gives two normal distributed ones.
+    const std::uint64_t counter = _counter;
+    for (std::size_t i=0; i < inCount; i += 2)
+    {
+        const double radius = inStdDev * std::sqrt(-2.0 * std::log(1.0 - _toDouble(at(counter + i))));
+        const double angle = kTwoPi * _toDouble(at(counter + i + 1));
+        outValues[i] = inMean + radius * std::cos(angle);
+        if (i + 1 < inCount)
+        {
+            outValues[i + 1] = inMean + radius * std::sin(angle);
+        }
+    }
+    _counter += inCount + (inCount & 1);
+}
+
+double CRandomStream::exponential(double inLambda)
+{
+    return -std::log1p(-uniformDouble()) / inLambda;
+}
+
+void CRandomStream::fillExponential(double* outValues, std::size_t inCount, double inLambda)
+{
+    const std::uint64_t counter = _counter;
+    for (std::size_t i=0; i < inCount; ++i)
+    {
+        outValues[i] = -std::log1p(-_toDouble(at(counter + i))) / inLambda;
+    }
+    _counter += inCount;
+}
+
+static TSUNIT_THREAD_LOCAL CRandomStream testStream;
+
+CRandomStream& testRandomStream()
+{
+    return testStream;
+}
+
+void _seedTestRandomStreams(const char* inGroupName, const char* inTestCaseName)
+{
+    const std::string name = std::string(inGroupName) + "::" + inTestCaseName;
+    testRandomStream() = CRandomStream::forName(name.c_str());
+    pseudoRandomsetSeed(CRandomStream::forName(name.c_str(), 0x3ac4821cul).next32());
+}
+
+// =======================================================================================
+// CHasher
+// =======================================================================================
+/*
+ * Adding a byte to a CHasher adds the hash of this single byte. These are
+ * looked up in a table (per HashVersion) instead of calculating these again.
  */
-template <>
+struct SingleByteHashes
+{
+    std::uint32_t hash[256];
+};
+
+static SingleByteHashes _makeSingleByteHashes(HashVersion inVersion)
+{
+    SingleByteHashes hashes;
+    for (unsigned int i=0; i < dimof(hashes.hash); ++i)
+    {
+        const std::uint8_t byte = std::uint8_t(i);
+        hashes.hash[i] = hash(&byte, sizeof(byte), inVersion);
+    }
+    return hashes;
+}
+
+static const std::uint32_t* _singleByteHashes(HashVersion inVersion)
+{
+    if (HashVersion::MULTILANE_V1 == inVersion)
+    {
+        static const SingleByteHashes multiLaneHashes = _makeSingleByteHashes(HashVersion::MULTILANE_V1);
+        return multiLaneHashes.hash;
+    }
+    static const SingleByteHashes legacyHashes = _makeSingleByteHashes(HashVersion::LEGACY);
+    return legacyHashes.hash;
+}
+
+void CHasher::_addBytes(const std::uint8_t* inBytes, std::size_t inCount)
+{
+    const std::uint32_t* singleByteHashes = _singleByteHashes(m_Version);
+    for (;inCount;--inCount)
+    {
+        _addHash(singleByteHashes[*inBytes++]);
+    }
+}
+
+CHasher& CHasher::operator+=(std::uint8_t inValue)
+{
+    return addAll(inValue);
+}
+
+CHasher& CHasher::operator+=(std::uint16_t inValue)
+{
+    return addAll(inValue);
+}
+
+CHasher& CHasher::operator+=(std::uint32_t inValue)
+{
+    return addAll(inValue);
+}
+
+CHasher& CHasher::operator+=(std::uint64_t inValue)
+{
+    return addAll(inValue);
+}
+
 CHasher& CHasher::operator+=(float inValue)
 {
-    return operator+=(*reinterpret_cast<const uint32_t*>(&inValue));
+    return addAll(inValue);
 }
 
-/*!
- * Specialization to add a 64 bit IEEE double Value endian independent to the hash.
- * \param inValue The Value to add to the hash disregard of the hosts endianess.
- * \return this Hasher object after adding the uint16 value.
- *
- * \see operator+=(uint16_t)
- * \see operator+=(uint32_t)
- * \see operator+=(const uint64_t&)
- * \see operator+=(float)
- */
-template <>
 CHasher& CHasher::operator+=(double inValue)
 {
-    return operator+=(*reinterpret_cast<const uint64_t*>(&inValue));
+    return addAll(inValue);
+}
+
+// =======================================================================================
+// Statistical tests
+// =======================================================================================
+/*
+ * Bit n of a byte spread onto byte n of an uint64_t.
+ */
+constexpr static std::uint64_t _spreadByte(std::uint64_t inByte)
+{
+    return (((inByte >> 0) & 1) <<  0) | (((inByte >> 1) & 1) <<  8)
+         | (((inByte >> 2) & 1) << 16) | (((inByte >> 3) & 1) << 24)
+         | (((inByte >> 4) & 1) << 32) | (((inByte >> 5) & 1) << 40)
+         | (((inByte >> 6) & 1) << 48) | (((inByte >> 7) & 1) << 56);
+}
+
+struct ByteSpreadTable
+{
+    std::uint64_t bytes[256];
+};
+
+template <std::size_t... I>
+constexpr static ByteSpreadTable _makeByteSpreadTable(IndexList<I...>)
+{
+    return ByteSpreadTable{ { _spreadByte(I)... } };
+}
+
+static constexpr ByteSpreadTable kByteSpreadTable = _makeByteSpreadTable(MakeIndexList<256>::type());
+
+const std::uint64_t (&CBitCounter::kByteSpread)[256] = kByteSpreadTable.bytes;
+
+void CBitCounter::_flush()
+{
+    for (unsigned int bit = 0; bit < 64; ++bit)
+    {
+        _totals[bit] += (_packed[bit / 8] >> (8 * (bit % 8))) & 0xff;
+    }
+    std::fill(std::begin(_packed), std::end(_packed), 0);
+    _pendingCnt = 0;
+}
+
+/*
+ * The probability of a standard normal deviation of at least |inZ|.
+ */
+static double _twoSidedPValue(double inZ)
+{
+    return std::erfc(std::fabs(inZ) / std::sqrt(2.0));
+}
+
+StatisticResult uniformBits(CBitCounter& ioCounter, unsigned int inBits, double inTolerance)
+{
+    StatisticResult result{false, 0, 0.0, 1.0};
+    const double expected = 0.5 * double(ioCounter.samples());
+    if (0.0 == expected)
+    {
+        return result;
+    }
+    for (unsigned int bit = 0; bit < inBits; ++bit)
+    {
+        const double deviation = (double(ioCounter.count(bit)) - expected) / expected;
+        if (std::fabs(deviation) > std::fabs(result.deviation))
+        {
+            result.worstBit = bit;
+            result.deviation = deviation;
+        }
+    }
+    // The count of a bit is binomial distributed: sigma = sqrt(n/4)
+    result.pValue = _twoSidedPValue(result.deviation * expected / std::sqrt(0.5 * expected));
+    result.failed = std::fabs(result.deviation) > inTolerance;
+    return result;
+}
+
+StatisticResult chiSquare(const std::vector<std::uint64_t>& inBuckets, double inSignificance)
+{
+    StatisticResult result{false, 0, 0.0, 1.0};
+    if (inBuckets.size() < 2)
+    {
+        return result;
+    }
+    std::uint64_t total = 0;
+    for (std::uint64_t count : inBuckets)
+    {
+        total += count;
+    }
+    const double expected = double(total) / inBuckets.size();
+    if (0.0 == expected)
+    {
+        return result;
+    }
+    double chi2 = 0.0;
+    for (std::uint64_t count : inBuckets)
+    {
+        chi2 += (double(count) - expected) * (double(count) - expected) / expected;
+    }
+    // The Wilson-Hilferty transformation of chi-square to a standard normal deviate.
+    const double degreesOfFreedom = double(inBuckets.size() - 1);
+    const double variance = 2.0 / (9.0 * degreesOfFreedom);
+    result.deviation = (std::cbrt(chi2 / degreesOfFreedom) - (1.0 - variance)) / std::sqrt(variance);
+    // Too large a chi-square is as suspicious as too small a one (too uniform).
+    result.pValue = _twoSidedPValue(result.deviation);
+    result.failed = result.pValue < inSignificance;
+    return result;
+}
+
+StatisticResult CRunCounter::test(double inSignificance) const
+{
+    StatisticResult result{false, 0, 0.0, 1.0};
+    const double n = double(_bitCnt);
+    const double ones = double(_ones);
+    const double zeros = n - ones;
+    if ((0.0 == ones) || (0.0 == zeros))
+    {
+        // A stream of constant bits.
+        result.failed = (n > 1.0);
+        result.pValue = 0.0;
+        return result;
+    }
+    const double expected = 2.0 * ones * zeros / n + 1.0;
+    const double variance = (expected - 1.0) * (expected - 2.0) / (n - 1.0);
+    result.deviation = (variance > 0.0) ? (double(_runs) - expected) / std::sqrt(variance) : 0.0;
+    result.pValue = _twoSidedPValue(result.deviation);
+    result.failed = result.pValue < inSignificance;
+    return result;
 }
 
 } // namespace tsunit
@@ -30,6 +30,10 @@
  *
  * ========================================================================== */
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <type_traits>
 
 // Some Useful addons for Unittest...
 
@@ -79,6 +83,132 @@ static std::uint32_t rotr(std::uint32_t val)
  */
 std::uint32_t hash(const void* inDataPtr, unsigned int inDataSize);
 
+/*!
+ * The versions of the hash. Since every version calculates different hashes
+ * one has to choose a version explicitly in order to keep stored hashes valid.
+ */
+enum struct HashVersion
+{
+    /* The original byte by byte hash, see hash(const void*, unsigned int) */
+    LEGACY,
+
+    /* Hashes the data in 8 independent lanes of 32 bits each (in the
+     * SIMD registers of the CPU) and folds these at the end. Much faster
+     * on bulk buffers. */
+    MULTILANE_V1
+};
+
+/*!
+ * Calculate a Hash of a given version for a given bunch of memory contents.
+ * \param inDataPtr The Pointer to the Data to calculate a hash for.
+ * \param inDataSize The number of bytes \p inDataPtr points to.
+ * \param inVersion The version of the hash.
+ * \return An Hash for the data \p inDataPtr points to and of the size \p inDataSize.
+ */
+std::uint32_t hash(const void* inDataPtr, unsigned int inDataSize, HashVersion inVersion);
+
+/*!
+ * The portable implementation of the HashVersion::MULTILANE_V1 hash. The
+ * SIMD implementations return the very same hash - so use this one in order
+ * to verify these only.
+ * \see hash(const void*, unsigned int, HashVersion)
+ */
+std::uint32_t hashMultiLaneScalar(const void* inDataPtr, unsigned int inDataSize);
+
+/*!
+ * Returns the name of the implementation HashVersion::MULTILANE_V1 uses on
+ * this CPU ("AVX2", "SSE2", "NEON" or "scalar"). This may be overridden by
+ * the environment variable TSUNIT_HASH_ENGINE (e.g. TSUNIT_HASH_ENGINE=scalar).
+ */
+const char* hashMultiLaneEngine();
+
+/*!
+ * The (slow) reference implementation of hash(). Both return the very same
+ * hash - so use this one in order to verify hash() only.
+ * \param inDataPtr The Pointer to the Data to calculate a hash for.
+ * \param inDataSize The number of bytes \p inDataPtr points to.
+ * \return An Hash for the data \p inDataPtr points to and of the size \p inDataSize.
+ * \see hash(const void*, unsigned int)
+ */
+std::uint32_t hashReference(const void* inDataPtr, unsigned int inDataSize);
+
+// ==========================================================================
+// Endian independent serialization
+// ==========================================================================
+/*!
+ * Writes a value in big endian byte order (the most significant byte first)
+ * to a buffer - disregard of the hosts endianess.
+ * \param outPtr The buffer to write the value to. This must provide at least
+ *        sizeof(\p inValue) bytes.
+ * \param inValue The value to write.
+ * \return The position of the buffer just behind the written value.
+ */
+inline std::uint8_t* serializeBigEndian(std::uint8_t* outPtr, std::uint8_t inValue)
+{
+    *outPtr++ = inValue;
+    return outPtr;
+}
+
+inline std::uint8_t* serializeBigEndian(std::uint8_t* outPtr, std::uint16_t inValue)
+{
+    *outPtr++ = std::uint8_t(inValue >> 8);
+    *outPtr++ = std::uint8_t(inValue >> 0);
+    return outPtr;
+}
+
+inline std::uint8_t* serializeBigEndian(std::uint8_t* outPtr, std::uint32_t inValue)
+{
+    *outPtr++ = std::uint8_t(inValue >> 24);
+    *outPtr++ = std::uint8_t(inValue >> 16);
+    *outPtr++ = std::uint8_t(inValue >>  8);
+    *outPtr++ = std::uint8_t(inValue >>  0);
+    return outPtr;
+}
+
+inline std::uint8_t* serializeBigEndian(std::uint8_t* outPtr, std::uint64_t inValue)
+{
+    outPtr = serializeBigEndian(outPtr, std::uint32_t(inValue >> 32));
+    return serializeBigEndian(outPtr, std::uint32_t(inValue));
+}
+
+/* IEEE floating point numbers are written as their bit pattern */
+inline std::uint8_t* serializeBigEndian(std::uint8_t* outPtr, float inValue)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &inValue, sizeof(bits));
+    return serializeBigEndian(outPtr, bits);
+}
+
+inline std::uint8_t* serializeBigEndian(std::uint8_t* outPtr, double inValue)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &inValue, sizeof(bits));
+    return serializeBigEndian(outPtr, bits);
+}
+
+/*
+ * The types serializeBigEndian() supports. These take sizeof(T) bytes.
+ */
+template <typename T> struct IsSerializable { static constexpr bool value = false; };
+template <> struct IsSerializable<std::uint8_t>  { static constexpr bool value = true; };
+template <> struct IsSerializable<std::uint16_t> { static constexpr bool value = true; };
+template <> struct IsSerializable<std::uint32_t> { static constexpr bool value = true; };
+template <> struct IsSerializable<std::uint64_t> { static constexpr bool value = true; };
+template <> struct IsSerializable<float>         { static constexpr bool value = true; };
+template <> struct IsSerializable<double>        { static constexpr bool value = true; };
+
+/*
+ * The number of bytes a bunch of values of the types T... take serialized.
+ */
+template <typename... T> struct SerializedSize;
+template <> struct SerializedSize<> { static constexpr std::size_t value = 0; };
+template <typename T, typename... MORE>
+struct SerializedSize<T, MORE...>
+{
+    static_assert(IsSerializable<T>::value, "serializeBigEndian() does not support this type");
+    static constexpr std::size_t value = sizeof(T) + SerializedSize<MORE...>::value;
+};
+
 /*!
  * Helper class that allows to collect several calculations of a Hash Value.
  * The purpose of this class is to remember and reuse the last calculated
@@ -92,11 +222,12 @@ public:
      * Creates a new Hasher object with a given initial hash value.
      * \param inInitialHashValue The inital Has Value. This parameter will
      * default to \p 0x5acB4821ul if omitted.
+     * \param inVersion The version of the hash to calculate the values with.
      *
      * \see reset(std::uint32_t)
      */
-    CHasher(std::uint32_t inInitialHashValue = 0x5acB4821ul)
-    : m_Hash(inInitialHashValue){}
+    CHasher(std::uint32_t inInitialHashValue = 0x5acB4821ul, HashVersion inVersion = HashVersion::LEGACY)
+    : m_Hash(inInitialHashValue), m_Version(inVersion){}
 
     /*!
      * Adds a new value to this has calculation.
@@ -107,10 +238,80 @@ public:
     template <typename T>
     CHasher& operator+=(T inValue)
     {
-        _addHash(tsunit::hash(&inValue, sizeof(inValue)));
+        _addHash(tsunit::hash(&inValue, sizeof(inValue), m_Version));
         return *this;
     }
 
+    /*!
+     * Adds an unsigned integer or an IEEE floating point value endian
+     * independent to this hash. This is the same as adding its bytes in big
+     * endian order one after another.
+     * \param inValue The Value to add to the hash disregard of the hosts endianess.
+     * \return An reference to this object **after** \p inValue has been added.
+     * \see addAll(T...)
+     */
+    CHasher& operator+=(std::uint8_t inValue);
+    CHasher& operator+=(std::uint16_t inValue);
+    CHasher& operator+=(std::uint32_t inValue);
+    CHasher& operator+=(std::uint64_t inValue);
+    CHasher& operator+=(float inValue);
+    CHasher& operator+=(double inValue);
+
+    /*!
+     * Adds several values endian independent to this hash at once. This is the
+     * same as adding these one after another by operator+=() - but faster.
+     * \param inValues The values to add. These have to be of the types
+     *        serializeBigEndian() supports.
+     * \return An reference to this object **after** the values have been added.
+     */
+    template <typename... T>
+    CHasher& addAll(T... inValues)
+    {
+        std::uint8_t buffer[SerializedSize<T...>::value + 1];
+        std::uint8_t* bufferPtr = buffer;
+        using expand = int[];
+        (void)expand{0, (bufferPtr = serializeBigEndian(bufferPtr, inValues), 0)...};
+        _addBytes(buffer, std::size_t(bufferPtr - buffer));
+        return *this;
+    }
+
+    /*!
+     * Adds a number of values endian independent to this hash. This is the same
+     * as adding these one after another by operator+=() - but faster.
+     * \param inValues Points to the values to add. These have to be of the types
+     *        serializeBigEndian() supports.
+     * \param inCount The number of values \p inValues points to.
+     * \return An reference to this object **after** the values have been added.
+     * \see add(const std::vector<T>&)
+     */
+    template <typename T>
+    CHasher& addSpan(const T* inValues, std::size_t inCount)
+    {
+        static_assert(IsSerializable<T>::value, "serializeBigEndian() does not support this type");
+
+        std::uint8_t buffer[256];
+        while (inCount)
+        {
+            std::uint8_t* bufferPtr = buffer;
+            for (std::size_t i = 0; inCount and (i < sizeof(buffer) / sizeof(T)); ++i, --inCount)
+            {
+                bufferPtr = serializeBigEndian(bufferPtr, *inValues++);
+            }
+            _addBytes(buffer, std::size_t(bufferPtr - buffer));
+        }
+        return *this;
+    }
+
+    /*!
+     * Adds all values of a vector endian independent to this hash.
+     * \see addSpan(const T*, std::size_t)
+     */
+    template <typename T>
+    CHasher& add(const std::vector<T>& inValues)
+    {
+        return addSpan(inValues.data(), inValues.size());
+    }
+
     /*!
      * Adds the contents of some memory to this hash.
      * \param inDataPtr The generic value of type <T>
@@ -121,7 +322,7 @@ public:
      */
     CHasher& add(const void* inDataPtr, unsigned int inDataSizeInBytes)
     {
-        _addHash(tsunit::hash(inDataPtr, inDataSizeInBytes));
+        _addHash(tsunit::hash(inDataPtr, inDataSizeInBytes, m_Version));
         return *this;
     }
 
@@ -150,10 +351,280 @@ private:
         m_Hash = rotl<7>(m_Hash) ^ rotr<12>(m_Hash) - inNewHash;
     }
 
+    /* Adds the hashes of some bytes one after another */
+    void _addBytes(const std::uint8_t* inBytes, std::size_t inCount);
+
 private:
     std::uint32_t m_Hash = 0x5acB4821ul;
+    HashVersion m_Version = HashVersion::LEGACY;
 }; // class CHasher
 
+// ==========================================================================
+// Wide hashes for content addressed caches
+// ==========================================================================
+/*!
+ * The typed interface the wide hashers share with CHasher. A class derived
+ * from this has to provide
+ *
+ *   void update(const void* inDataPtr, std::size_t inDataSizeInBytes);
+ *
+ * that streams some bytes into its hash.
+ */
+template <typename DERIVED>
+class CHasherStream
+{
+public:
+    /*!
+     * Adds a value to this hash. Unsigned integers and IEEE floating point
+     * values are added endian independent (as their bytes in big endian
+     * order), any other type as the bytes it occupies in memory.
+     * \param inValue The Value to add to the hash.
+     * \return An reference to this object **after** \p inValue has been added.
+     */
+    template <typename T>
+    DERIVED& operator+=(T inValue)
+    {
+        return _addValue(inValue, std::integral_constant<bool, IsSerializable<T>::value>());
+    }
+
+    /*!
+     * Adds several values endian independent to this hash at once.
+     * \see CHasher::addAll()
+     */
+    template <typename... T>
+    DERIVED& addAll(T... inValues)
+    {
+        std::uint8_t buffer[SerializedSize<T...>::value + 1];
+        std::uint8_t* bufferPtr = buffer;
+        using expand = int[];
+        (void)expand{0, (bufferPtr = serializeBigEndian(bufferPtr, inValues), 0)...};
+        _derived().update(buffer, std::size_t(bufferPtr - buffer));
+        return _derived();
+    }
+
+    /*!
+     * Adds a number of values endian independent to this hash.
+     * \see CHasher::addSpan()
+     */
+    template <typename T>
+    DERIVED& addSpan(const T* inValues, std::size_t inCount)
+    {
+        static_assert(IsSerializable<T>::value, "serializeBigEndian() does not support this type");
+
+        std::uint8_t buffer[256];
+        while (inCount)
+        {
+            std::uint8_t* bufferPtr = buffer;
+            for (std::size_t i = 0; inCount and (i < sizeof(buffer) / sizeof(T)); ++i, --inCount)
+            {
+                bufferPtr = serializeBigEndian(bufferPtr, *inValues++);
+            }
+            _derived().update(buffer, std::size_t(bufferPtr - buffer));
+        }
+        return _derived();
+    }
+
+    /*!
+     * Adds all values of a vector endian independent to this hash.
+     */
+    template <typename T>
+    DERIVED& add(const std::vector<T>& inValues)
+    {
+        return addSpan(inValues.data(), inValues.size());
+    }
+
+    /*!
+     * Adds the contents of some memory to this hash.
+     * \param inDataPtr Points to the data.
+     * \param inDataSizeInBytes The size of the data \p inDataPtr points to in [bytes]
+     * \return An reference to this object **after** the data has been added.
+     */
+    DERIVED& add(const void* inDataPtr, std::size_t inDataSizeInBytes)
+    {
+        _derived().update(inDataPtr, inDataSizeInBytes);
+        return _derived();
+    }
+
+private:
+    DERIVED& _derived()
+    {
+        return static_cast<DERIVED&>(*this);
+    }
+
+    template <typename T>
+    DERIVED& _addValue(T inValue, std::true_type)
+    {
+        return addAll(inValue);
+    }
+
+    template <typename T>
+    DERIVED& _addValue(const T& inValue, std::false_type)
+    {
+        return add(&inValue, sizeof(inValue));
+    }
+}; // class CHasherStream
+
+/*!
+ * A streaming 64 bit hash (XXH64). Other than CHasher all data added is one
+ * stream: Adding "ab" and "c" is the same as adding "abc".
+ */
+class CHasher64 : public CHasherStream<CHasher64>
+{
+public:
+    /*!
+     * Creates a new Hasher object.
+     * \param inSeed The seed of the hash.
+     */
+    explicit CHasher64(std::uint64_t inSeed = 0)
+    {
+        reset(inSeed);
+    }
+
+    /*!
+     * Resets the hash to its initial state.
+     * \param inSeed The seed of the hash.
+     */
+    void reset(std::uint64_t inSeed = 0);
+
+    /*!
+     * Streams some bytes into this hash.
+     */
+    void update(const void* inDataPtr, std::size_t inDataSizeInBytes);
+
+    /*!
+     * Returns the hash of all data added so far.
+     */
+    std::uint64_t value() const;
+
+private:
+    std::uint64_t _seed;
+    std::uint64_t _lanes[4];
+    std::uint64_t _totalSize;
+    std::uint8_t _buffer[32];
+    std::size_t _bufferSize;
+}; // class CHasher64
+
+/*!
+ * A 128 bit hash value.
+ */
+struct Hash128
+{
+    std::uint64_t low;
+    std::uint64_t high;
+
+    bool operator==(const Hash128& inOther) const { return (low == inOther.low) and (high == inOther.high); }
+    bool operator!=(const Hash128& inOther) const { return not operator==(inOther); }
+    bool operator<(const Hash128& inOther) const { return (high != inOther.high) ? (high < inOther.high) : (low < inOther.low); }
+};
+
+/*!
+ * A streaming 128 bit hash (MurmurHash3 x64 128). Other than CHasher all data
+ * added is one stream: Adding "ab" and "c" is the same as adding "abc".
+ */
+class CHasher128 : public CHasherStream<CHasher128>
+{
+public:
+    /*!
+     * Creates a new Hasher object.
+     * \param inSeed The seed of the hash.
+     */
+    explicit CHasher128(std::uint32_t inSeed = 0)
+    {
+        reset(inSeed);
+    }
+
+    /*!
+     * Resets the hash to its initial state.
+     * \param inSeed The seed of the hash.
+     */
+    void reset(std::uint32_t inSeed = 0);
+
+    /*!
+     * Streams some bytes into this hash.
+     */
+    void update(const void* inDataPtr, std::size_t inDataSizeInBytes);
+
+    /*!
+     * Returns the hash of all data added so far.
+     */
+    Hash128 value() const;
+
+private:
+    std::uint64_t _h1;
+    std::uint64_t _h2;
+    std::uint64_t _totalSize;
+    std::uint8_t _buffer[16];
+    std::size_t _bufferSize;
+}; // class CHasher128
+
+// ==========================================================================
+// Tree hashing of large buffers and files
+// ==========================================================================
+/* The default size of the chunks a tree hash splits the data into */
+constexpr std::size_t kTreeHashChunkSize = 1024 * 1024;
+
+/*!
+ * The result of a tree hash: The hashes of all chunks of the data and the
+ * root of the (Merkle) tree these build.
+ * \see hashRange()
+ * \see hashFile()
+ */
+struct TreeHash
+{
+    /* The hash of the whole data */
+    std::uint32_t root = 0;
+
+    /* The size of the data in [bytes] */
+    std::uint64_t dataSize = 0;
+
+    /* The size of the chunks in [bytes] */
+    std::size_t chunkSize = kTreeHashChunkSize;
+
+    /* The hash of every chunk */
+    std::vector<std::uint32_t> chunkHashes;
+
+    /*!
+     * Compares the chunks of two tree hashes in order to locate where the data differ.
+     * \param inOther The tree hash to compare with. This should use the same chunk
+     *        size - else all chunks are reported to differ.
+     * \return The indices of the chunks that differ (or just exist in one of these).
+     */
+    std::vector<std::size_t> diff(const TreeHash& inOther) const;
+};
+
+/*!
+ * Calculates the tree hash of a buffer. The chunks are hashed in parallel -
+ * the result however does not depend on the number of threads.
+ * \param inDataPtr The Pointer to the Data to calculate a hash for.
+ * \param inDataSize The number of bytes \p inDataPtr points to.
+ * \param inVersion The version of the hash to hash the chunks with.
+ * \param inChunkSize The size of the chunks in [bytes].
+ * \param inNrOfThreads The number of threads to use. 0 uses all cores.
+ * \return The tree hash of the data.
+ */
+TreeHash hashRange(const void* inDataPtr, std::size_t inDataSize
+                 , HashVersion inVersion = HashVersion::MULTILANE_V1
+                 , std::size_t inChunkSize = kTreeHashChunkSize
+                 , unsigned int inNrOfThreads = 0);
+
+#if !defined(CROSS_BUILD)
+/*!
+ * Calculates the tree hash of a file. The file is memory mapped (if the
+ * platform supports this) so it will not be read into memory as a whole.
+ * \param inPath The path of the file.
+ * \param outHash The tree hash of the file.
+ * \param inVersion The version of the hash to hash the chunks with.
+ * \param inChunkSize The size of the chunks in [bytes].
+ * \param inNrOfThreads The number of threads to use. 0 uses all cores.
+ * \return true if the file has been hashed, false if it could not be read.
+ * \see hashRange()
+ */
+bool hashFile(const char* inPath, TreeHash& outHash
+            , HashVersion inVersion = HashVersion::MULTILANE_V1
+            , std::size_t inChunkSize = kTreeHashChunkSize
+            , unsigned int inNrOfThreads = 0);
+#endif // !defined(CROSS_BUILD)
+
 // ==========================================================================
 // Some "Pseudo random" functions.
 // ==========================================================================
@@ -163,6 +634,10 @@ private:
  * one may able to reproduce the same "random" sequence if she starts at the **same
  * seed**.
  *
+ * Every thread has a generator on its own. TSUnit seeds it at the start of
+ * every test by the name of the test - so a test gets the same "random"
+ * numbers no matter in which order or on which thread it runs.
+ *
  * \see pseudoRandomsetSeed(std::uint32_t)
  * \see pseudoRandom()
  */
@@ -194,4 +669,489 @@ std::uint32_t pseudoRandom();
  */
 float pseudoRandomFloat(float minValue = 0.f, float maxValue = 1.f);
 
+/*!
+ * Returns the current pseudo random number for a given range as a double
+ * with the full precision of 53 bits.
+ * \param minValue The minimal value (included). This will default to 0 if omitted.
+ * \param maxValue The max value (excluded). This will default to 1.0 if omitted.
+ * \see pseudoRandomsetSeed(std::uint32_t)
+ */
+double pseudoRandomDouble(double minValue = 0.0, double maxValue = 1.0);
+
+/*!
+ * Fills a buffer with pseudo random bytes. This is as fast as writing to the
+ * memory and reproducible by pseudoRandomsetSeed() as well.
+ * \param outPtr The buffer to fill.
+ * \param inSize The size of the buffer in [bytes].
+ * \see CRandomStream::fill(void*, std::size_t)
+ */
+void pseudoRandomFill(void* outPtr, std::size_t inSize);
+
+/*!
+ * A counter based pseudo random generator. Its n-th number is a pure function
+ * of its key and n (the counter) - so a stream may jump to any position in
+ * O(1) and several streams never share a state. Derive independent streams
+ * for threads (or tests) by substream() or forName().
+ */
+class CRandomStream
+{
+public:
+    /*!
+     * Creates a new stream.
+     * \param inKey The key that selects the sequence of this stream.
+     * \param inCounter The position within this sequence.
+     */
+    constexpr explicit CRandomStream(std::uint64_t inKey = 0, std::uint64_t inCounter = 0)
+    : _key(inKey), _counter(inCounter) {}
+
+    /*!
+     * Creates a stream whose key is derived from a name (e.g. the name of a test).
+     * \param inName The name.
+     * \param inKey The key to derive the stream from.
+     */
+    static CRandomStream forName(const char* inName, std::uint64_t inKey = 0);
+
+    /*!
+     * Returns the number at a position of this stream. This does not
+     * change the stream.
+     * \param inCounter The position.
+     */
+    std::uint64_t at(std::uint64_t inCounter) const
+    {
+        return _mix(_key + (inCounter + 1) * kGamma);
+    }
+
+    /*!
+     * Returns the next pseudo random number using the full 64 bit scale.
+     */
+    std::uint64_t next64()
+    {
+        return at(_counter++);
+    }
+
+    /*!
+     * Returns the next pseudo random number using the full 32 bit scale.
+     */
+    std::uint32_t next32()
+    {
+        return std::uint32_t(next64() >> 32);
+    }
+
+    /*!
+     * Skips a number of pseudo random numbers in O(1).
+     * \param inDistance The number of numbers to skip.
+     */
+    void jump(std::uint64_t inDistance)
+    {
+        _counter += inDistance;
+    }
+
+    /*!
+     * Returns an independent stream derived from this one (e.g. one for
+     * every thread). The same index always derives the same stream.
+     * \param inIndex The index of the sub stream.
+     */
+    CRandomStream substream(std::uint64_t inIndex) const
+    {
+        return CRandomStream(_mix(_key ^ _mix(inIndex + kGamma)));
+    }
+
+    /*!
+     * Returns an unbiased pseudo random number of the range [0..inBound[
+     * (by Lemire's multiply and shift method - without a modulo bias).
+     * \param inBound The upper bound. 0 returns 0.
+     */
+    std::uint64_t below(std::uint64_t inBound)
+    {
+        std::uint64_t low;
+        std::uint64_t high = _multiply(next64(), inBound, low);
+        if (low < inBound)
+        {
+            const std::uint64_t threshold = (0 - inBound) % inBound;
+            while (low < threshold)
+            {
+                high = _multiply(next64(), inBound, low);
+            }
+        }
+        return high;
+    }
+
+    /*!
+     * Returns an unbiased pseudo random number of the range [\p inMin..\p inMax].
+     */
+    std::int64_t uniformInt(std::int64_t inMin, std::int64_t inMax)
+    {
+        const std::uint64_t span = std::uint64_t(inMax) - std::uint64_t(inMin);
+        const std::uint64_t offset = (~std::uint64_t(0) == span) ? next64() : below(span + 1);
+        return std::int64_t(std::uint64_t(inMin) + offset);
+    }
+
+    /*!
+     * Returns a pseudo random number of the range [0..1[ with the full
+     * precision of 53 bits.
+     */
+    double uniformDouble()
+    {
+        return _toDouble(next64());
+    }
+
+    /*!
+     * Returns a normal distributed pseudo random number (Box-Muller).
+     * \param inMean The mean of the distribution.
+     * \param inStdDev The standard deviation of the distribution.
+     */
+    double normal(double inMean = 0.0, double inStdDev = 1.0);
+
+    /*!
+     * Returns an exponential distributed pseudo random number.
+     * \param inLambda The rate of the distribution (its mean is 1 / \p inLambda).
+     */
+    double exponential(double inLambda = 1.0);
+
+    /*!
+     * Fills a buffer with pseudo random bytes. The bytes are the same on
+     * every host (the numbers are stored in little endian byte order).
+     * \param outPtr The buffer to fill.
+     * \param inSize The size of the buffer in [bytes].
+     */
+    void fill(void* outPtr, std::size_t inSize);
+
+    /*
+     * Bulk variants. These return the very same numbers as calling the
+     * single value functions \p inCount times - but faster. Just fillNormal()
+     * uses both numbers of each Box-Muller pair.
+     */
+    void fillBelow(std::uint64_t* outValues, std::size_t inCount, std::uint64_t inBound);
+    void fillUniformDouble(double* outValues, std::size_t inCount);
+    void fillNormal(double* outValues, std::size_t inCount, double inMean = 0.0, double inStdDev = 1.0);
+    void fillExponential(double* outValues, std::size_t inCount, double inLambda = 1.0);
+
+    /*!
+     * Shuffles some values (Fisher-Yates). Every permutation is equally likely.
+     * \param ioValues The values to shuffle.
+     * \param inCount The number of values.
+     */
+    template <typename T>
+    void shuffle(T* ioValues, std::size_t inCount)
+    {
+        for (std::size_t i = inCount; i > 1; --i)
+        {
+            const std::size_t j = std::size_t(below(i));
+            if (j != i - 1)
+            {
+                const T value(ioValues[i - 1]);
+                ioValues[i - 1] = ioValues[j];
+                ioValues[j] = value;
+            }
+        }
+    }
+
+    std::uint64_t key() const { return _key; }
+    std::uint64_t counter() const { return _counter; }
+
+private:
+    static constexpr std::uint64_t kGamma = 0x9e3779b97f4a7c15ull;
+
+    // Returns the upper 64 bits of the 128 bit product of two numbers
+    static std::uint64_t _multiply(std::uint64_t inA, std::uint64_t inB, std::uint64_t& outLow)
+    {
+#if defined(__SIZEOF_INT128__)
+        const unsigned __int128 product = static_cast<unsigned __int128>(inA) * inB;
+        outLow = std::uint64_t(product);
+        return std::uint64_t(product >> 64);
+#else
+        const std::uint64_t aLow = inA & 0xffffffffull, aHigh = inA >> 32;
+        const std::uint64_t bLow = inB & 0xffffffffull, bHigh = inB >> 32;
+        const std::uint64_t lowLow = aLow * bLow;
+        const std::uint64_t middle = aHigh * bLow + (lowLow >> 32);
+        const std::uint64_t middle2 = aLow * bHigh + (middle & 0xffffffffull);
+        outLow = (middle2 << 32) | (lowLow & 0xffffffffull);
+        return aHigh * bHigh + (middle >> 32) + (middle2 >> 32);
+#endif
+    }
+
+    static double _toDouble(std::uint64_t inValue)
+    {
+        return double(inValue >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // The finalizer of SplitMix64
+    static std::uint64_t _mix(std::uint64_t inValue)
+    {
+        inValue = (inValue ^ (inValue >> 30)) * 0xbf58476d1ce4e5b9ull;
+        inValue = (inValue ^ (inValue >> 27)) * 0x94d049bb133111ebull;
+        return inValue ^ (inValue >> 31);
+    }
+
+    std::uint64_t _key;
+    std::uint64_t _counter;
+}; // class CRandomStream
+
+/*!
+ * Returns the random stream of the current test. This is derived from the
+ * name of the test - so it is the same no matter in which order or on which
+ * thread the test runs.
+ */
+CRandomStream& testRandomStream();
+
+/*
+ * Seeds the pseudo random generators of the calling thread by the name of a
+ * test. TSUnit calls this at the start of every test.
+ */
+void _seedTestRandomStreams(const char* inGroupName, const char* inTestCaseName);
+
+// ==========================================================================
+// Statistical tests of random numbers and hashes.
+// ==========================================================================
+/*!
+ * \brief Counts the set bits per position of up to 64 bit wide values.
+ *
+ * Instead of testing every single bit each byte of a value is spread onto
+ * 8 byte wide counters by a table lookup (SWAR). These are flushed into 64
+ * bit totals before they are able to overflow. So counting a value costs 8
+ * additions - no matter how many bits it has.
+ */
+class CBitCounter
+{
+public:
+    void add(std::uint64_t inValue)
+    {
+        for (unsigned int byteIdx = 0; byteIdx < 8; ++byteIdx)
+        {
+            _packed[byteIdx] += kByteSpread[(inValue >> (8 * byteIdx)) & 0xff];
+        }
+        ++_samples;
+        if (255 == ++_pendingCnt)
+        {
+            _flush();
+        }
+    }
+
+    /*!
+     * \return How often the bit \p inBit [0..63] has been set.
+     */
+    std::uint64_t count(unsigned int inBit)
+    {
+        _flush();
+        return _totals[inBit];
+    }
+
+    /*!
+     * \return The number of added values.
+     */
+    std::uint64_t samples() const {
+        return _samples; }
+
+    /* Bit n of a byte spread onto the byte n of an uint64_t */
+    static const std::uint64_t (&kByteSpread)[256];
+
+private:
+    void _flush();
+
+    std::uint64_t _packed[8] = {};
+    std::uint64_t _totals[64] = {};
+    std::uint64_t _samples = 0;
+    unsigned int _pendingCnt = 0;
+}; // class CBitCounter
+
+/*!
+ * \brief The outcome of a statistical test.
+ */
+struct StatisticResult
+{
+    bool failed;
+    unsigned int worstBit;  // The bit of the largest deviation (uniformBits() only)
+    double deviation;       // The relative deviation of this bit or the z score of the test
+    double pValue;          // The probability of a deviation at least as large by chance
+};
+
+/*!
+ * \brief Checks that every bit is set in half of the values.
+ * \param ioCounter The counted bits of the values.
+ * \param inBits The width of the values in bits.
+ * \param inTolerance The acceptable relative deviation of a bit count
+ *        from the half of the values, e.g. 0.03 for +/-3%.
+ * \return The bit of the largest deviation and its (two sided) p-value.
+ */
+StatisticResult uniformBits(CBitCounter& ioCounter, unsigned int inBits, double inTolerance);
+
+/*!
+ * \brief A chi-square test of counts that are expected to be equal.
+ * \param inBuckets The counts.
+ * \param inSignificance The test fails if its p-value is below.
+ */
+StatisticResult chiSquare(const std::vector<std::uint64_t>& inBuckets, double inSignificance);
+
+/*!
+ * \brief Counts the ones and the runs (sequences of equal bits) of a stream
+ * of bits - the values are concatenated starting at their least significant
+ * bits.
+ */
+class CRunCounter
+{
+public:
+    explicit CRunCounter(unsigned int inBits)
+    : _bits(inBits)
+    , _mask((64 == inBits) ? ~std::uint64_t(0) : ((std::uint64_t(1) << inBits) - 1))
+    {
+    }
+
+    void add(std::uint64_t inValue)
+    {
+        inValue &= _mask;
+        if (0 == _bitCnt)
+        {
+            _lastBit = inValue & 1;
+        }
+        // Another run starts at every bit that differs from its predecessor.
+        const std::uint64_t previous = (inValue << 1) | _lastBit;
+        _runs += _popcount((inValue ^ previous) & _mask);
+        _ones += _popcount(inValue);
+        _lastBit = inValue >> (_bits - 1);
+        _bitCnt += _bits;
+    }
+
+    /*!
+     * \brief The Wald-Wolfowitz runs test of the bits added so far.
+     * \param inSignificance The test fails if its p-value is below.
+     */
+    StatisticResult test(double inSignificance) const;
+
+private:
+    static unsigned int _popcount(std::uint64_t inValue)
+    {
+        inValue = inValue - ((inValue >> 1) & 0x5555555555555555ull);
+        inValue = (inValue & 0x3333333333333333ull) + ((inValue >> 2) & 0x3333333333333333ull);
+        inValue = (inValue + (inValue >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return static_cast<unsigned int>((inValue * 0x0101010101010101ull) >> 56);
+    }
+
+    unsigned int _bits;
+    std::uint64_t _mask;
+    std::uint64_t _lastBit = 0;
+    std::uint64_t _runs = 1;
+    std::uint64_t _ones = 0;
+    std::uint64_t _bitCnt = 0;
+}; // class CRunCounter
+
+template <typename GENERATOR>
+using GeneratedValue = typename std::decay<decltype(std::declval<GENERATOR&>()())>::type;
+
+/*!
+ * \brief Checks that every bit of the values of a generator is uniform.
+ * \param inGenerator Returns an unsigned integer of up to 64 bits per call.
+ * \see uniformBits()
+ */
+template <typename GENERATOR>
+StatisticResult checkUniformBits(GENERATOR&& inGenerator, std::uint64_t inCount, double inTolerance)
+{
+    using Value = GeneratedValue<GENERATOR>;
+    static_assert(std::is_unsigned<Value>::value and (sizeof(Value) <= 8), "The generator has to return an unsigned integer");
+    CBitCounter counter;
+    for (std::uint64_t i = 0; i < inCount; ++i)
+    {
+        counter.add(inGenerator());
+    }
+    return uniformBits(counter, 8 * sizeof(Value), inTolerance);
+}
+
+/*!
+ * \brief The chi-square test of the values of a generator modulo the number
+ * of buckets.
+ * \see chiSquare()
+ */
+template <typename GENERATOR>
+StatisticResult checkChiSquare(GENERATOR&& inGenerator, std::uint64_t inCount, std::uint32_t inNrOfBuckets, double inSignificance)
+{
+    using Value = GeneratedValue<GENERATOR>;
+    static_assert(std::is_unsigned<Value>::value and (sizeof(Value) <= 8), "The generator has to return an unsigned integer");
+    std::vector<std::uint64_t> buckets(inNrOfBuckets, 0);
+    for (std::uint64_t i = 0; i < inCount; ++i)
+    {
+        ++buckets[std::uint64_t(inGenerator()) % inNrOfBuckets];
+    }
+    return chiSquare(buckets, inSignificance);
+}
+
+/*!
+ * \brief The runs test of the bits of the values of a generator.
+ * \see CRunCounter::test()
+ */
+template <typename GENERATOR>
+StatisticResult checkRuns(GENERATOR&& inGenerator, std::uint64_t inCount, double inSignificance)
+{
+    using Value = GeneratedValue<GENERATOR>;
+    static_assert(std::is_unsigned<Value>::value and (sizeof(Value) <= 8), "The generator has to return an unsigned integer");
+    CRunCounter counter(8 * sizeof(Value));
+    for (std::uint64_t i = 0; i < inCount; ++i)
+    {
+        counter.add(inGenerator());
+    }
+    return counter.test(inSignificance);
+}
+
+/*
+ * Expect that every bit of the values of a generator (a callable returning
+ * an unsigned integer) is set in half of inCount values within a relative
+ * tolerance, e.g.
+ *
+ *   UT_EXPECT_UNIFORM_BITS([]() { return tsunit::pseudoRandom(); }, 10000, 0.04);
+ *
+ * A failure reports the bit of the largest deviation and its p-value.
+ */
+#define UT_EXPECT_UNIFORM_BITS(generator, count, tolerance) do{\
+  tsunit::_cntAssertionDone();\
+  const tsunit::StatisticResult utResult = tsunit::checkUniformBits((generator), (count), (tolerance));\
+  if (utResult.failed) {\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()) {\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Bit %u is not uniform in %s::%s @line %d: deviation %.2f%% (p-value %g)" ESC_COLOR_RESET "\n"\
+            , utResult.worstBit, tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__\
+            , 100.0 * utResult.deviation, utResult.pValue);\
+    }\
+  }\
+} while(0)
+
+/*
+ * Expect that the values of a generator modulo nrOfBuckets are uniformly
+ * distributed - the chi-square test must not be below the significance, e.g.
+ *
+ *   UT_EXPECT_CHI_SQUARE([]() { return tsunit::pseudoRandom(); }, 100000, 256, 0.001);
+ */
+#define UT_EXPECT_CHI_SQUARE(generator, count, nrOfBuckets, significance) do{\
+  tsunit::_cntAssertionDone();\
+  const tsunit::StatisticResult utResult = tsunit::checkChiSquare((generator), (count), (nrOfBuckets), (significance));\
+  if (utResult.failed) {\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()) {\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Chi-square test failed in %s::%s @line %d: z score %.2f (p-value %g)" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__\
+            , utResult.deviation, utResult.pValue);\
+    }\
+  }\
+} while(0)
+
+/*
+ * Expect that the bits of the values of a generator pass the runs test, i.e.
+ * they do not change too seldom or too often.
+ */
+#define UT_EXPECT_RUNS(generator, count, significance) do{\
+  tsunit::_cntAssertionDone();\
+  const tsunit::StatisticResult utResult = tsunit::checkRuns((generator), (count), (significance));\
+  if (utResult.failed) {\
+    tsunit::_cntAssertionFailed();\
+    if (tsunit::currentLogger()) {\
+        tsunit::currentLogger()->reportFailed();\
+        tsunit::currentLogger()->log(ESC_COLOR_RED "*** Runs test failed in %s::%s @line %d: z score %.2f (p-value %g)" ESC_COLOR_RESET "\n"\
+            , tsunit::currentEntry()->groupName\
+            , tsunit::currentEntry()->testCaseName, __LINE__\
+            , utResult.deviation, utResult.pValue);\
+    }\
+  }\
+} while(0)
+
 } // namespace tsunit
@@ -0,0 +1,102 @@
+/* ==========================================================================
+ * @(#)File: BM_Hash.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "TSUnitTestAddOns.hpp"
+#include "TSUnit.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// The throughput of tsunit::hash() compared to its reference implementation
+// and to the multi lane hash.
+
+static std::uint32_t _hashMultiLane(const void* inDataPtr, unsigned int inDataSize)
+{
+    return tsunit::hash(inDataPtr, inDataSize, tsunit::HashVersion::MULTILANE_V1);
+}
+
+static std::uint32_t _hash64(const void* inDataPtr, unsigned int inDataSize)
+{
+    return std::uint32_t(tsunit::CHasher64().add(inDataPtr, inDataSize).value());
+}
+
+static std::uint32_t _hash128(const void* inDataPtr, unsigned int inDataSize)
+{
+    return std::uint32_t(tsunit::CHasher128().add(inDataPtr, inDataSize).value().low);
+}
+
+static double _throughputMBs(std::uint32_t (*inHash)(const void*, unsigned int), const std::vector<std::uint8_t>& inBuffer, unsigned int inRepetitions)
+{
+    volatile std::uint32_t sink = 0;
+    const double ns = tsunit::measureDurationNs([&]() {
+        sink = inHash(inBuffer.data(), static_cast<unsigned int>(inBuffer.size()));
+    }, inRepetitions);
+    (void)sink;
+    return (ns > 0.0) ? (double(inBuffer.size()) * 1000.0 / ns) : 0.0;
+}
+
+int main()
+{
+    static const std::size_t kSizes[] = {4, 64, 1024, 64 * 1024, 1024 * 1024, 8 * 1024 * 1024};
+
+    printf("Multi lane hash on %s\n", tsunit::hashMultiLaneEngine());
+    printf("%12s %16s %16s %10s %16s %16s %16s %16s\n", "size [bytes]", "reference [MB/s]", "hash [MB/s]", "speedup", "multilane [MB/s]", "scalar [MB/s]", "CHasher64 [MB/s]", "CHasher128 [MB/s]");
+    for (std::size_t size : kSizes)
+    {
+        std::vector<std::uint8_t> buffer(size);
+        tsunit::pseudoRandomsetSeed(4711);
+        for (std::uint8_t& byte : buffer)
+        {
+            byte = std::uint8_t(tsunit::pseudoRandom());
+        }
+
+        const unsigned int repetitions = (size < 65536) ? 1000 : 3;
+        const double reference = _throughputMBs(tsunit::hashReference, buffer, repetitions);
+        const double tableDriven = _throughputMBs(tsunit::hash, buffer, repetitions);
+        const double multiLane = _throughputMBs(_hashMultiLane, buffer, repetitions);
+        const double multiLaneScalar = _throughputMBs(tsunit::hashMultiLaneScalar, buffer, repetitions);
+        const double wide64 = _throughputMBs(_hash64, buffer, repetitions);
+        const double wide128 = _throughputMBs(_hash128, buffer, repetitions);
+        printf("%12zu %16.1f %16.1f %9.1fx %16.1f %16.1f %16.1f %16.1f\n", size, reference, tableDriven, (reference > 0.0) ? tableDriven / reference : 0.0
+             , multiLane, multiLaneScalar, wide64, wide128);
+    }
+
+    // The tree hash of a large buffer on a growing number of threads.
+    std::vector<std::uint8_t> buffer(64 * 1024 * 1024, 0x55);
+    printf("\n%12s %16s\n", "threads", "tree hash [MB/s]");
+    for (unsigned int nrOfThreads : {1u, 2u, 4u, 8u})
+    {
+        const double ns = tsunit::measureDurationNs([&]() {
+            tsunit::hashRange(buffer.data(), buffer.size(), tsunit::HashVersion::MULTILANE_V1, tsunit::kTreeHashChunkSize, nrOfThreads);
+        }, 3);
+        printf("%12u %16.1f\n", nrOfThreads, (ns > 0.0) ? (double(buffer.size()) * 1000.0 / ns) : 0.0);
+    }
+    return 0;
+}
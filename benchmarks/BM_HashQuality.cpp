@@ -0,0 +1,339 @@
+/* ==========================================================================
+ * @(#)File: BM_HashQuality.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "TSUnitTestAddOns.hpp"
+#include "TSUnit.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+// The quality and the throughput of the hashes and of the random generators -
+// a small battery in the spirit of SMHasher and PractRand:
+//  - Throughput of aligned and unaligned inputs from 4 bytes up to 64 MB.
+//  - Avalanche: Flipping a single input bit has to flip every output bit
+//    with a probability of 1/2.
+//  - Bit independence (BIC): Two output bits must not flip together more
+//    often than by chance.
+//  - Chi-square of the distribution into 2^16 buckets (by the low and the
+//    high bits) and the number of collisions of the 32 bit hashes.
+// The bits are counted by tsunit::CBitCounter (SWAR) - so the battery runs in seconds.
+// The deviations are reported in standard deviations (sigma) of an ideal hash.
+
+namespace {
+
+struct HashFunction
+{
+    const char* name;
+    unsigned int bits;
+    std::uint64_t (*funct)(const void*, std::size_t);
+};
+
+std::uint64_t _hashLegacy(const void* inDataPtr, std::size_t inDataSize)
+{
+    return tsunit::hash(inDataPtr, static_cast<unsigned int>(inDataSize));
+}
+
+std::uint64_t _hashMultiLane(const void* inDataPtr, std::size_t inDataSize)
+{
+    return tsunit::hash(inDataPtr, static_cast<unsigned int>(inDataSize), tsunit::HashVersion::MULTILANE_V1);
+}
+
+std::uint64_t _hash64(const void* inDataPtr, std::size_t inDataSize)
+{
+    return tsunit::CHasher64().add(inDataPtr, inDataSize).value();
+}
+
+std::uint64_t _hash128(const void* inDataPtr, std::size_t inDataSize)
+{
+    // The low half only - the 64 bits that are tested.
+    return tsunit::CHasher128().add(inDataPtr, inDataSize).value().low;
+}
+
+const HashFunction kHashFunctions[] = {
+    {"hash (LEGACY)",      32, _hashLegacy},
+    {"hash (MULTILANE_V1)",32, _hashMultiLane},
+    {"CHasher64",          64, _hash64},
+    {"CHasher128 (low)",   64, _hash128},
+};
+
+const char* _verdict(double inSigma)
+{
+    return (std::fabs(inSigma) < 6.0) ? "ok" : "FAIL";
+}
+
+double _seconds(std::chrono::steady_clock::time_point inStart)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inStart).count();
+}
+
+void _benchmarkThroughput()
+{
+    static const std::size_t kSizes[] = {4, 16, 64, 256, 1024, 4096, 64 * 1024, 1024 * 1024, 8 * 1024 * 1024, 64 * 1024 * 1024};
+    static const std::size_t kBytesPerMeasurement = 2 * 1024 * 1024;
+    static const std::size_t kAlignment = 64;
+
+    std::vector<std::uint8_t> storage(kSizes[sizeof(kSizes) / sizeof(kSizes[0]) - 1] + 2 * kAlignment);
+    tsunit::CRandomStream(4711).fill(storage.data(), storage.size());
+    std::uint8_t* const alignedPtr = storage.data() + (kAlignment - reinterpret_cast<std::uintptr_t>(storage.data()) % kAlignment);
+
+    printf("Throughput [MB/s] of aligned (a) and unaligned (u) inputs, multi lane hash on %s\n", tsunit::hashMultiLaneEngine());
+    printf("%12s", "size [bytes]");
+    for (const HashFunction& hashFunction : kHashFunctions)
+    {
+        printf(" %21s", hashFunction.name);
+    }
+    printf("\n");
+    for (std::size_t size : kSizes)
+    {
+        const unsigned int repetitions = static_cast<unsigned int>(std::min<std::size_t>(std::max<std::size_t>(kBytesPerMeasurement / size, 1), 20000));
+        printf("%12zu", size);
+        for (const HashFunction& hashFunction : kHashFunctions)
+        {
+            double mbs[2];
+            for (unsigned int offset = 0; offset < 2; ++offset)
+            {
+                volatile std::uint64_t sink = 0;
+                const double ns = tsunit::measureDurationNs([&]() {
+                    sink = hashFunction.funct(alignedPtr + offset, size);
+                }, repetitions);
+                (void)sink;
+                mbs[offset] = (ns > 0.0) ? (double(size) * 1000.0 / ns) : 0.0;
+            }
+            printf(" %10.1f/%10.1f", mbs[0], mbs[1]);
+        }
+        printf("\n");
+    }
+}
+
+/*
+ * Flips every bit of random keys of 16 bytes and counts the flipped output
+ * bits per input bit (avalanche) and per pair of output bits (BIC).
+ */
+void _testAvalanche(const HashFunction& inHash, unsigned int inNrOfKeys, unsigned int inNrOfBicKeys)
+{
+    static const unsigned int kKeySize = 16;
+    static const unsigned int kInputBits = kKeySize * 8;
+
+    std::vector<tsunit::CBitCounter> flips(kInputBits);
+    // BIC: Row j of an input bit counts the flips of all output bits whenever output bit j flips.
+    std::vector<tsunit::CBitCounter> pairs(kInputBits * inHash.bits);
+
+    tsunit::CRandomStream stream(0xa1a7c4e);
+    std::uint8_t key[kKeySize];
+    for (unsigned int keyIdx = 0; keyIdx < inNrOfKeys; ++keyIdx)
+    {
+        stream.fill(key, sizeof(key));
+        const std::uint64_t original = inHash.funct(key, sizeof(key));
+        for (unsigned int inputBit = 0; inputBit < kInputBits; ++inputBit)
+        {
+            key[inputBit / 8] ^= std::uint8_t(1u << (inputBit % 8));
+            const std::uint64_t diff = original ^ inHash.funct(key, sizeof(key));
+            key[inputBit / 8] ^= std::uint8_t(1u << (inputBit % 8));
+
+            flips[inputBit].add(diff);
+            if (keyIdx < inNrOfBicKeys)
+            {
+                for (std::uint64_t bits = diff; 0 != bits; bits &= bits - 1)
+                {
+                    pairs[inputBit * inHash.bits + unsigned(__builtin_ctzll(bits))].add(diff);
+                }
+            }
+        }
+    }
+
+    // The bias of the flip probability p is |2p - 1|, its sigma is 1/sqrt(N).
+    double worstBias = 0.0;
+    for (unsigned int inputBit = 0; inputBit < kInputBits; ++inputBit)
+    {
+        for (unsigned int outputBit = 0; outputBit < inHash.bits; ++outputBit)
+        {
+            const double p = double(flips[inputBit].count(outputBit)) / inNrOfKeys;
+            worstBias = std::max(worstBias, std::fabs(2.0 * p - 1.0));
+        }
+    }
+    const double avalancheSigma = worstBias * std::sqrt(double(inNrOfKeys));
+
+    // The correlation (phi) of two flipped output bits, its sigma is 1/sqrt(N).
+    double worstPhi = 0.0;
+    for (unsigned int inputBit = 0; inputBit < kInputBits; ++inputBit)
+    {
+        for (unsigned int bitA = 0; bitA < inHash.bits; ++bitA)
+        {
+            tsunit::CBitCounter& row = pairs[inputBit * inHash.bits + bitA];
+            const double nA = double(row.count(bitA));
+            for (unsigned int bitB = bitA + 1; bitB < inHash.bits; ++bitB)
+            {
+                const double nB = double(pairs[inputBit * inHash.bits + bitB].count(bitB));
+                const double nAB = double(row.count(bitB));
+                const double n = inNrOfBicKeys;
+                const double denominator = std::sqrt(nA * (n - nA) * nB * (n - nB));
+                const double phi = (denominator > 0.0) ? (n * nAB - nA * nB) / denominator : 1.0;
+                worstPhi = std::max(worstPhi, std::fabs(phi));
+            }
+        }
+    }
+    const double bicSigma = worstPhi * std::sqrt(double(inNrOfBicKeys));
+
+    printf("  avalanche: worst bias %.4f (%5.1f sigma) %-4s   BIC: worst correlation %.4f (%5.1f sigma) %s\n"
+        , worstBias, avalancheSigma, _verdict(avalancheSigma), worstPhi, bicSigma, _verdict(bicSigma));
+}
+
+/*
+ * The z score of the chi-square of the values distributed into 2^16 buckets.
+ */
+double _chiSquareZ(const std::vector<std::uint32_t>& inValues, unsigned int inShift)
+{
+    static const std::size_t kNrOfBuckets = 65536;
+    std::vector<std::uint32_t> buckets(kNrOfBuckets, 0);
+    for (std::uint32_t value : inValues)
+    {
+        ++buckets[(value >> inShift) & (kNrOfBuckets - 1)];
+    }
+    const double expected = double(inValues.size()) / kNrOfBuckets;
+    double chiSquare = 0.0;
+    for (std::uint32_t observed : buckets)
+    {
+        chiSquare += (observed - expected) * (observed - expected) / expected;
+    }
+    const double degreesOfFreedom = kNrOfBuckets - 1;
+    return (chiSquare - degreesOfFreedom) / std::sqrt(2.0 * degreesOfFreedom);
+}
+
+void _reportDistribution(const char* inKeySetName, std::vector<std::uint32_t>& ioValues)
+{
+    const double lowZ = _chiSquareZ(ioValues, 0);
+    const double highZ = _chiSquareZ(ioValues, 16);
+
+    std::sort(ioValues.begin(), ioValues.end());
+    std::size_t collisions = 0;
+    for (std::size_t i = 1; i < ioValues.size(); ++i)
+    {
+        collisions += (ioValues[i - 1] == ioValues[i]) ? 1 : 0;
+    }
+    const double n = double(ioValues.size());
+    const double expectedCollisions = n * (n - 1.0) / 2.0 / 4294967296.0;
+    // The number of collisions is poisson distributed.
+    const double collisionSigma = (collisions - expectedCollisions) / std::sqrt(expectedCollisions);
+
+    printf("  %-10s chi-square low %6.2f high %6.2f sigma %-4s   collisions %zu of %.1f expected %s\n"
+        , inKeySetName, lowZ, highZ, _verdict(std::max(std::fabs(lowZ), std::fabs(highZ)))
+        , collisions, expectedCollisions, (collisionSigma < 6.0) ? "ok" : "FAIL");
+}
+
+void _testDistribution(const HashFunction& inHash, unsigned int inNrOfKeys)
+{
+    std::vector<std::uint32_t> values(inNrOfKeys);
+
+    // Sequential numbers as 4 byte keys.
+    for (unsigned int i = 0; i < inNrOfKeys; ++i)
+    {
+        std::uint8_t key[4];
+        tsunit::serializeBigEndian(key, std::uint32_t(i));
+        values[i] = std::uint32_t(inHash.funct(key, sizeof(key)));
+    }
+    _reportDistribution("sequential", values);
+
+    // Sparse keys: all 128 byte keys of two set bits (the first inNrOfKeys of these).
+    std::vector<std::uint8_t> key(128, 0);
+    unsigned int keyIdx = 0;
+    for (unsigned int bitA = 1; (bitA < key.size() * 8) && (keyIdx < inNrOfKeys); ++bitA)
+    {
+        for (unsigned int bitB = 0; (bitB < bitA) && (keyIdx < inNrOfKeys); ++bitB)
+        {
+            key[bitA / 8] ^= std::uint8_t(1u << (bitA % 8));
+            key[bitB / 8] ^= std::uint8_t(1u << (bitB % 8));
+            values[keyIdx++] = std::uint32_t(inHash.funct(key.data(), key.size()));
+            key[bitA / 8] ^= std::uint8_t(1u << (bitA % 8));
+            key[bitB / 8] ^= std::uint8_t(1u << (bitB % 8));
+        }
+    }
+    _reportDistribution("sparse", values);
+}
+
+/*
+ * The random generators have to deliver uniform bits and uniform numbers.
+ */
+template <typename GENERATOR>
+void _testGenerator(const char* inName, unsigned int inNrOfValues, GENERATOR inGenerator)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::uint32_t> values(inNrOfValues);
+    for (std::uint32_t& value : values)
+    {
+        value = inGenerator();
+    }
+    const double seconds = _seconds(start);
+
+    tsunit::CBitCounter counter;
+    tsunit::CRunCounter runs(32);
+    for (std::uint32_t value : values)
+    {
+        counter.add(value);
+        runs.add(value);
+    }
+    double worstBias = 0.0;
+    for (unsigned int bit = 0; bit < 32; ++bit)
+    {
+        worstBias = std::max(worstBias, std::fabs(2.0 * double(counter.count(bit)) / inNrOfValues - 1.0));
+    }
+    const double biasSigma = worstBias * std::sqrt(double(inNrOfValues));
+
+    printf("%s: %.1f MB/s\n", inName, (seconds > 0.0) ? (inNrOfValues * sizeof(std::uint32_t) / seconds / 1e6) : 0.0);
+    const tsunit::StatisticResult runsTest = runs.test(0.0);
+    printf("  bits: worst bias %.5f (%5.1f sigma) %-4s   runs %5.1f sigma %s\n", worstBias, biasSigma, _verdict(biasSigma), runsTest.deviation, _verdict(runsTest.deviation));
+    _reportDistribution("values", values);
+}
+
+} // namespace
+
+int main()
+{
+    _benchmarkThroughput();
+
+    printf("\nQuality (deviations of more than 6 sigma fail)\n");
+    for (const HashFunction& hashFunction : kHashFunctions)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        printf("%s:\n", hashFunction.name);
+        _testAvalanche(hashFunction, 10000, 4000);
+        _testDistribution(hashFunction, 1u << 19);
+        printf("  (%.2f s)\n", _seconds(start));
+    }
+
+    printf("\n");
+    tsunit::pseudoRandomsetSeed(4711);
+    _testGenerator("pseudoRandom()", 1u << 22, []() { return tsunit::pseudoRandom(); });
+    tsunit::CRandomStream stream(4711);
+    _testGenerator("CRandomStream::next32()", 1u << 22, [&stream]() { return stream.next32(); });
+    return 0;
+}
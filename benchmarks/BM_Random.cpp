@@ -0,0 +1,74 @@
+/* ==========================================================================
+ * @(#)File: BM_Random.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "TSUnitTestAddOns.hpp"
+#include "TSUnit.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// The throughput of the bulk random functions compared to a loop of pseudoRandom().
+
+static void _report(const char* inName, std::size_t inSize, double inNs)
+{
+    printf("%-32s %12.1f MB/s\n", inName, (inNs > 0.0) ? (double(inSize) * 1000.0 / inNs) : 0.0);
+}
+
+int main()
+{
+    std::vector<std::uint8_t> buffer(16 * 1024 * 1024);
+
+    _report("pseudoRandom() loop", buffer.size(), tsunit::measureDurationNs([&]() {
+        std::uint32_t* wordPtr = reinterpret_cast<std::uint32_t*>(buffer.data());
+        for (std::size_t i = 0; i < buffer.size() / sizeof(std::uint32_t); ++i)
+        {
+            wordPtr[i] = tsunit::pseudoRandom();
+        }
+    }, 1));
+
+    _report("pseudoRandomFill()", buffer.size(), tsunit::measureDurationNs([&]() {
+        tsunit::pseudoRandomFill(buffer.data(), buffer.size());
+    }, 3));
+
+    std::vector<double> doubles(buffer.size() / sizeof(double));
+    tsunit::CRandomStream stream(4711);
+    _report("CRandomStream::fillUniformDouble", buffer.size(), tsunit::measureDurationNs([&]() {
+        stream.fillUniformDouble(doubles.data(), doubles.size());
+    }, 3));
+    _report("CRandomStream::fillNormal", buffer.size(), tsunit::measureDurationNs([&]() {
+        stream.fillNormal(doubles.data(), doubles.size());
+    }, 3));
+
+    std::vector<std::uint64_t> values(buffer.size() / sizeof(std::uint64_t));
+    _report("CRandomStream::fillBelow", buffer.size(), tsunit::measureDurationNs([&]() {
+        stream.fillBelow(values.data(), values.size(), 1000);
+    }, 3));
+    return 0;
+}
@@ -0,0 +1,297 @@
+#pragma once
+/* ==========================================================================
+ * @(#)File: CBlockPoolAllocator.hpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "CPoorMansBlockAlloc.hpp"
+#include <new>
+#include <limits>
+#include <type_traits>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+#if (__cplusplus >= 201703L) && defined(__has_include)
+    #if __has_include(<memory_resource>)
+        #include <memory_resource>
+        #include <tuple>
+        #include <utility>
+        #define BLOCK_ALLOC_WITH_PMR 1
+    #endif
+#endif
+
+/*!
+ * \brief An STL allocator that takes single elements from a block pool.
+ *
+ * Every element type - i.e. every node type a container rebinds this
+ * allocator to - has a pool of its own with 2^NR_OF_ELEMENTS_LOG2N slots.
+ * Requests of more than a single element (like the bucket arrays of an
+ * std::unordered_map) and requests that find the pool exhausted are passed
+ * to the global operator new (the aligned one for over-aligned types as of
+ * C++17). So all instances are interchangeable and compare equal.
+ * \note Like CPoorMansBlockAlloc this is not thread-safe: All containers
+ * of the same node type share a pool.
+ * \code
+ * std::map<int, Order, std::less<int>, CBlockPoolAllocator<std::pair<const int, Order>, 16>> orders;
+ * \endcode
+ */
+template <typename T, size_t NR_OF_ELEMENTS_LOG2N = 12>
+class CBlockPoolAllocator
+{
+public:
+    using value_type = T;
+    // At least as large as the link of the free list
+    using Storage = typename std::aligned_storage<(sizeof(T) < sizeof(uint64_t)) ? sizeof(uint64_t) : sizeof(T), alignof(T)>::type;
+    using Pool = CPoorMansBlockAlloc<Storage, NR_OF_ELEMENTS_LOG2N, LastFreedFirst>;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = CBlockPoolAllocator<U, NR_OF_ELEMENTS_LOG2N>;
+    };
+
+    CBlockPoolAllocator() = default;
+
+    template <typename U>
+    CBlockPoolAllocator(const CBlockPoolAllocator<U, NR_OF_ELEMENTS_LOG2N>&) {}
+
+    /*!
+     * \throw std::bad_array_new_length if \p inNrOfElements elements exceed the address space.
+     * \throw std::bad_alloc if the global operator new fails.
+     */
+    T* allocate(size_t inNrOfElements)
+    {
+        Storage* storage = (1 == inNrOfElements) ? pool().alloc() : nullptr;
+        if (nullptr != storage)
+        {
+            return reinterpret_cast<T*>(storage);
+        }
+        if (inNrOfElements > std::numeric_limits<size_t>::max() / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(_operatorNew(inNrOfElements * sizeof(T)));
+    }
+
+    void deallocate(T* inElements, size_t inNrOfElements)
+    {
+        // The pool rejects the pointers it does not own.
+        if ((1 != inNrOfElements) || not pool().free(reinterpret_cast<Storage*>(inElements)))
+        {
+            _operatorDelete(inElements);
+        }
+    }
+
+    /*!
+     * \brief The pool of the element type \p T. It is created on the first
+     * use and never destroyed - so containers with static storage duration
+     * may outlive everything else.
+     */
+    static Pool& pool()
+    {
+        static Pool* const pool = new Pool;
+        return *pool;
+    }
+
+private:
+#if defined(__cpp_aligned_new)
+    static constexpr bool kOverAligned = (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+#else
+    static constexpr bool kOverAligned = false;
+#endif
+
+    static void* _operatorNew(size_t inSize)
+    {
+#if defined(__cpp_aligned_new)
+        if (kOverAligned)
+        {
+            return ::operator new(inSize, std::align_val_t(alignof(T)));
+        }
+#endif
+        return ::operator new(inSize);
+    }
+
+    static void _operatorDelete(void* inBlock)
+    {
+#if defined(__cpp_aligned_new)
+        if (kOverAligned)
+        {
+            ::operator delete(inBlock, std::align_val_t(alignof(T)));
+            return;
+        }
+#endif
+        ::operator delete(inBlock);
+    }
+}; // class CBlockPoolAllocator
+
+template <typename T, typename U, size_t NR_OF_ELEMENTS_LOG2N>
+bool operator==(const CBlockPoolAllocator<T, NR_OF_ELEMENTS_LOG2N>&, const CBlockPoolAllocator<U, NR_OF_ELEMENTS_LOG2N>&)
+{
+    return true;
+}
+
+template <typename T, typename U, size_t NR_OF_ELEMENTS_LOG2N>
+bool operator!=(const CBlockPoolAllocator<T, NR_OF_ELEMENTS_LOG2N>&, const CBlockPoolAllocator<U, NR_OF_ELEMENTS_LOG2N>&)
+{
+    return false;
+}
+
+#if defined(BLOCK_ALLOC_WITH_PMR)
+/*!
+ * \brief The alignment of the blocks of a CBlockPoolResource - that of the
+ * block size, but at most the one of std::max_align_t.
+ */
+constexpr size_t blockPoolAlignmentOf(size_t inBlockSize)
+{
+    return (inBlockSize < alignof(std::max_align_t)) ? inBlockSize : alignof(std::max_align_t);
+}
+
+/*!
+ * \brief A memory resource that serves small blocks from a set of block pools.
+ *
+ * There is a pool of 2^NR_OF_ELEMENTS_LOG2N slots for each of the
+ * BLOCK_SIZES (ascending powers of 2). A request is routed to the pool of
+ * the smallest block that fits its size and its alignment. The requests
+ * larger than the largest block, or that find their pool exhausted, go
+ * upstream.
+ * \note Like std::pmr::unsynchronized_pool_resource this is not thread-safe.
+ * \code
+ * CBlockPoolResource<12, 16, 32, 64, 128> resource;
+ * std::pmr::map<int, int> map(&resource);
+ * \endcode
+ */
+template <size_t NR_OF_ELEMENTS_LOG2N, size_t... BLOCK_SIZES>
+class CBlockPoolResource : public std::pmr::memory_resource
+{
+public:
+    static constexpr size_t kNrOfPools = sizeof...(BLOCK_SIZES);
+    static constexpr size_t kNoPool = kNrOfPools;
+
+    explicit CBlockPoolResource(std::pmr::memory_resource* inUpstream = std::pmr::get_default_resource())
+        : _upstream(inUpstream)
+    {
+        static_assert(_ascendingPowersOf2(), "The block sizes have to be ascending powers of 2");
+    }
+
+    CBlockPoolResource(const CBlockPoolResource&) = delete;
+    CBlockPoolResource& operator=(const CBlockPoolResource&) = delete;
+
+    std::pmr::memory_resource* upstream_resource() const {
+        return _upstream; }
+
+    /*!
+     * \brief The index of the pool a request of \p inBytes and \p inAlignment is routed to.
+     * \return The index in BLOCK_SIZES or kNoPool if the request goes upstream.
+     */
+    static constexpr size_t poolOf(size_t inBytes, size_t inAlignment)
+    {
+        for (size_t idx = 0; idx < kNrOfPools; ++idx)
+        {
+            if ((inBytes <= kBlockSizes[idx]) && (inAlignment <= blockPoolAlignmentOf(kBlockSizes[idx])))
+            {
+                return idx;
+            }
+        }
+        return kNoPool;
+    }
+
+    /*!
+     * \return The number of blocks in use of the pool \p POOL_IDX.
+     */
+    template <size_t POOL_IDX>
+    size_t used() const {
+        return std::get<POOL_IDX>(_pools).used(); }
+
+private:
+    static constexpr size_t kBlockSizes[] = {BLOCK_SIZES...};
+
+    static constexpr bool _ascendingPowersOf2()
+    {
+        for (size_t idx = 0; idx < kNrOfPools; ++idx)
+        {
+            if ((0 == kBlockSizes[idx]) || (0 != (kBlockSizes[idx] & (kBlockSizes[idx] - 1)))
+                || ((idx > 0) && (kBlockSizes[idx] <= kBlockSizes[idx - 1])))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <size_t BLOCK_SIZE>
+    using Pool = CPoorMansBlockAlloc<typename std::aligned_storage<BLOCK_SIZE, blockPoolAlignmentOf(BLOCK_SIZE)>::type,
+        NR_OF_ELEMENTS_LOG2N, LastFreedFirst>;
+
+    void* do_allocate(size_t inBytes, size_t inAlignment) override
+    {
+        void* block = _allocate(poolOf(inBytes, inAlignment), std::index_sequence_for<Pool<BLOCK_SIZES>...>());
+        return (nullptr != block) ? block : _upstream->allocate(inBytes, inAlignment);
+    }
+
+    void do_deallocate(void* inBlock, size_t inBytes, size_t inAlignment) override
+    {
+        // The pool rejects the blocks that have been taken from upstream.
+        if (not _free(poolOf(inBytes, inAlignment), inBlock, std::index_sequence_for<Pool<BLOCK_SIZES>...>()))
+        {
+            _upstream->deallocate(inBlock, inBytes, inAlignment);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& inOther) const noexcept override
+    {
+        return this == &inOther;
+    }
+
+    template <size_t... POOL_IDX>
+    void* _allocate(size_t inPoolIdx, std::index_sequence<POOL_IDX...>)
+    {
+        void* block = nullptr;
+        (static_cast<void>((POOL_IDX == inPoolIdx) && (nullptr != (block = std::get<POOL_IDX>(_pools).alloc()))), ...);
+        return block;
+    }
+
+    template <size_t... POOL_IDX>
+    bool _free(size_t inPoolIdx, void* inBlock, std::index_sequence<POOL_IDX...>)
+    {
+        bool freed = false;
+        (static_cast<void>((POOL_IDX == inPoolIdx) && (freed = _freeIn(std::get<POOL_IDX>(_pools), inBlock))), ...);
+        return freed;
+    }
+
+    template <typename POOL>
+    static bool _freeIn(POOL& ioPool, void* inBlock)
+    {
+        using Block = typename std::remove_pointer<decltype(ioPool.alloc())>::type;
+        return ioPool.free(static_cast<Block*>(inBlock));
+    }
+
+    std::pmr::memory_resource* const _upstream;
+    std::tuple<Pool<BLOCK_SIZES>...> _pools;
+}; // class CBlockPoolResource
+#endif // BLOCK_ALLOC_WITH_PMR
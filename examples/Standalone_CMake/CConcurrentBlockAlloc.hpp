@@ -0,0 +1,204 @@
+#pragma once
+/* ==========================================================================
+ * @(#)File: CConcurrentBlockAlloc.hpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "CPoorMansBlockAlloc.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+ * \brief A lock-free variant of CPoorMansBlockAlloc that may be shared by
+ * several threads.
+ *
+ * A set bit of the bitmap marks a free slot. Every bitmap word is padded to
+ * a cache line of its own so that threads working on neighbouring words
+ * do not false-share. A slot is claimed by a CAS that clears its bit and
+ * released by setting this bit again.
+ *
+ * In contrast to a linked free list the bitmap is not prone to ABA: A CAS
+ * only succeeds if the word still has the value that has been read - and
+ * this value fully describes the state of these 64 slots, no matter what
+ * has happened to them in between.
+ *
+ * An alloc() reserves its slot by the used count first - so it fails fast
+ * if the pool is full and it will find a free bit otherwise (the bit of a
+ * freed slot is set before the count is decremented). The search starts at
+ * the word where the calling thread has been successful recently.
+ */
+template <typename T, size_t NR_OF_ELEMENTS_LOG2N>
+class CConcurrentBlockAlloc
+{
+public:
+    CConcurrentBlockAlloc()
+    {
+        clear();
+    }
+
+    CConcurrentBlockAlloc(const CConcurrentBlockAlloc&) = delete;
+    CConcurrentBlockAlloc& operator=(const CConcurrentBlockAlloc&) = delete;
+
+    /*!
+     * \brief Asks how many storage slots of the allocators type \p T are currently in use.
+     * \note This is a snapshot only if other threads allocate or free concurrently.
+     * \return The number of the used slots of the type \p T.
+     */
+    size_t used() const {
+        return _usedCount.value.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Asks how many storage slots of the allocators type \p T are currently still available.
+     * \note This is a snapshot only if other threads allocate or free concurrently.
+     * \return The number of the available slots of the type \p T.
+     */
+    size_t available() const {
+        return _totalSize() - used();
+    }
+
+    bool empty() const
+    {
+        return 0 == used();
+    }
+
+    bool full() const
+    {
+        return 0 == available();
+    }
+
+    /*!
+     * \brief Attempt to allocate a new slot of the type \p T and return its storage pointer.
+     * \return Upon success a pointer to an storage of an element of the type \p T.
+     * If the allocation fails (because the allocator is full) then a nullptr is returned.
+     * \see free(T*)
+     */
+    T* alloc()
+    {
+        if (_usedCount.value.fetch_add(1, std::memory_order_relaxed) >= _totalSize())
+        {
+            _usedCount.value.fetch_sub(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        // There is a free slot for us - though other threads may claim the
+        // ones we see first.
+        size_t& hint = _threadHint();
+        for (size_t wordIdx = hint;; wordIdx = (wordIdx + 1) % kNrOfWords)
+        {
+            std::atomic<uint64_t>& word = _freeBits[wordIdx].value;
+            uint64_t bits = word.load(std::memory_order_relaxed);
+            while (0 != bits)
+            {
+                const uint64_t claimed = bits & (~bits + 1);
+                if (word.compare_exchange_weak(bits, bits & ~claimed, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    hint = wordIdx;
+                    return &_buffer[wordIdx * 64 + countTrailingZeros(claimed)];
+                }
+            }
+        }
+    }
+
+    /*!
+     * \brief Frees an pointer to a slot of the type \p T that has been allocated previously by alloc().
+     * \param inBuffPtr A Pointer that has been prev. allocated by \ref alloc().
+     * \return true upon success. false on failure (e.g. already freed or if \p is inBuffPtr not an owner of this allocator)
+     * \see alloc()
+     */
+    bool free(T* inBuffPtr)
+    {
+        if (nullptr == inBuffPtr)
+        {
+            return true;
+        }
+        const size_t offset = indexOf(inBuffPtr);
+        if (offset >= _totalSize())
+        {
+            return false;
+        }
+        const uint64_t mask = uint64_t(1) << (offset % 64);
+        if (0 != (_freeBits[offset / 64].value.fetch_or(mask, std::memory_order_release) & mask))
+        {
+            return false; // Has already been free
+        }
+        _usedCount.value.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*!
+     * \brief Asks for the index of a slot of this allocator.
+     * \return The index or a value >= the number of slots if \p inSlot is not a slot of this allocator.
+     */
+    size_t indexOf(const T* inSlot) const {
+        return inSlot - _buffer; }
+
+    /*!
+     * \brief Clears all allocations within this object.
+     * \note This must not be called while other threads use this allocator.
+     */
+    void clear()
+    {
+        for (size_t wordIdx = 0; wordIdx < kNrOfWords; ++wordIdx)
+        {
+            const size_t bitsOfWord = _totalSize() - wordIdx * 64;
+            _freeBits[wordIdx].value.store((bitsOfWord >= 64) ? ~uint64_t(0) : ((uint64_t(1) << bitsOfWord) - 1), std::memory_order_relaxed);
+        }
+        _usedCount.value.store(0, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    template <typename VALUE>
+    struct alignas(kCacheLineSize) CacheLine
+    {
+        std::atomic<VALUE> value;
+    };
+
+    static constexpr size_t _totalSize() { return size_t(1)<<NR_OF_ELEMENTS_LOG2N;}
+    static constexpr size_t kNrOfWords = ((size_t(1)<<NR_OF_ELEMENTS_LOG2N) + 63) / 64;
+
+    /*
+     * The word a thread starts its search at. This is shared by all
+     * allocators of the same type - it is a hint only. The threads start
+     * at different words in order not to contend for the first one.
+     */
+    static size_t& _threadHint()
+    {
+        static std::atomic<size_t> threadCnt(0);
+        static thread_local size_t hint = (threadCnt.fetch_add(1, std::memory_order_relaxed) * 7) % kNrOfWords;
+        return hint;
+    }
+
+    CacheLine<size_t> _usedCount;
+    CacheLine<uint64_t> _freeBits[kNrOfWords];
+    T _buffer[size_t(1)<<NR_OF_ELEMENTS_LOG2N];
+}; // class CConcurrentBlockAlloc
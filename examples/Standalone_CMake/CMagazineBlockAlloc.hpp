@@ -0,0 +1,476 @@
+#pragma once
+/* ==========================================================================
+ * @(#)File: CMagazineBlockAlloc.hpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "CConcurrentBlockAlloc.hpp"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+ * \brief Assigns a small index to every thread that uses a magazine allocator.
+ *
+ * When a thread exits, the magazines of all allocators that it has cached
+ * slots in are flushed to their shared pools. Then its index is handed to
+ * the next new thread.
+ */
+class CMagazineThreadIndex
+{
+public:
+    static constexpr unsigned int kMaxThreads = 64;
+    static constexpr unsigned int kNone = kMaxThreads;
+
+    /*!
+     * \brief Flushes the magazine of the thread \p inThreadIdx of the allocator \p ioAllocator.
+     */
+    using FlushFunction = void (*)(void* ioAllocator, unsigned int inThreadIdx);
+
+    /*!
+     * \return The index of the calling thread [0..kMaxThreads) or kNone if
+     * there are more threads.
+     */
+    static unsigned int current()
+    {
+        static thread_local CMagazineThreadIndex threadIndex;
+        return threadIndex._idx;
+    }
+
+    /*!
+     * \brief Registers an allocator whose magazines are flushed on the exit of a thread.
+     */
+    static void registerAllocator(void* inAllocator, FlushFunction inFlush)
+    {
+        Registry& registry = _registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.allocators.push_back(Allocator{inAllocator, inFlush});
+    }
+
+    /*!
+     * \brief Unregisters an allocator prior to its destruction.
+     */
+    static void unregisterAllocator(void* inAllocator)
+    {
+        Registry& registry = _registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (size_t i = 0; i < registry.allocators.size(); ++i)
+        {
+            if (inAllocator == registry.allocators[i].allocator)
+            {
+                registry.allocators[i] = registry.allocators.back();
+                registry.allocators.pop_back();
+                break;
+            }
+        }
+    }
+
+private:
+    struct Allocator
+    {
+        void* allocator;
+        FlushFunction flush;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<unsigned int> freeIndices;
+        unsigned int nextIdx = 0;
+        std::vector<Allocator> allocators;
+    };
+
+    static Registry& _registry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    CMagazineThreadIndex()
+    {
+        Registry& registry = _registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (not registry.freeIndices.empty())
+        {
+            _idx = registry.freeIndices.back();
+            registry.freeIndices.pop_back();
+        }
+        else if (registry.nextIdx < kMaxThreads)
+        {
+            _idx = registry.nextIdx++;
+        }
+    }
+
+    ~CMagazineThreadIndex()
+    {
+        if (kNone != _idx)
+        {
+            Registry& registry = _registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (const Allocator& allocator : registry.allocators)
+            {
+                allocator.flush(allocator.allocator, _idx);
+            }
+            registry.freeIndices.push_back(_idx);
+        }
+    }
+
+    unsigned int _idx = kNone;
+}; // class CMagazineThreadIndex
+
+/*!
+ * \brief The statistics of a CMagazineBlockAlloc.
+ */
+struct MagazineStatistics
+{
+    uint64_t allocs = 0;            // The calls of alloc()
+    uint64_t hits = 0;              // The allocs served by the magazine of the calling thread
+    uint64_t refills = 0;           // The batches taken from the shared pool
+    uint64_t flushes = 0;           // The batches returned to the shared pool
+    uint64_t crossThreadFrees = 0;  // The slots freed by another thread than the allocating one
+
+    double hitRate() const {
+        return (0 == allocs) ? 0.0 : double(hits) / double(allocs); }
+};
+
+/*!
+ * \brief A block pool with a magazine (a small stack of free slots) per
+ * thread in front of a shared CConcurrentBlockAlloc - as the magazine layer
+ * of the slab allocator by Bonwick.
+ *
+ * alloc() and free() just pop and push the magazine of the calling thread,
+ * which lives on cache lines of its own. Only if the magazine runs empty (or
+ * full) half of it is refilled from (or flushed to) the shared pool at once.
+ * The magazine of an exiting thread is flushed.
+ *
+ * Every slot has an owner tag: the thread whose magazine has taken it from
+ * the shared pool or none if it is in the pool. The tag is stored behind the
+ * storage of its slot, so a free() reads the cache line of the freed slot
+ * only and not a line that other threads tag their slots in. The tags are
+ * written by the refills and the flushes only - alloc() does not touch them,
+ * and free() reads them unless the slot comes from the magazine of another
+ * thread. Such a slot is counted and goes to the magazine of the freeing thread.
+ *
+ * A double free is detected if the slot is in the shared pool or in the
+ * magazine of the freeing thread (which free() searches).
+ *
+ * \note Up to kMaxThreads * MAGAZINE_SIZE slots may be cached by the
+ * magazines - so alloc() may fail while other threads still cache some.
+ * \note A slot that is freed by two different threads is not detected.
+ * \note A slot takes 4 bytes more than \p T for its tag (padded to the alignment of \p T).
+ */
+template <typename T, size_t NR_OF_ELEMENTS_LOG2N, unsigned int MAGAZINE_SIZE = 32>
+class CMagazineBlockAlloc
+{
+    static_assert(MAGAZINE_SIZE >= 2, "A magazine needs at least 2 slots");
+
+public:
+    static constexpr unsigned int kMaxThreads = CMagazineThreadIndex::kMaxThreads;
+
+    CMagazineBlockAlloc()
+    {
+        CMagazineThreadIndex::registerAllocator(this, &CMagazineBlockAlloc::_flushThread);
+    }
+
+    ~CMagazineBlockAlloc()
+    {
+        CMagazineThreadIndex::unregisterAllocator(this);
+    }
+
+    CMagazineBlockAlloc(const CMagazineBlockAlloc&) = delete;
+    CMagazineBlockAlloc& operator=(const CMagazineBlockAlloc&) = delete;
+
+    /*!
+     * \brief Asks how many storage slots are currently in use (not cached).
+     * \note This is a snapshot only if other threads allocate or free concurrently.
+     */
+    size_t used() const {
+        return _pool.used() - _cachedCount();
+    }
+
+    /*!
+     * \brief Asks how many storage slots are currently available (including the cached ones).
+     * \note This is a snapshot only if other threads allocate or free concurrently.
+     */
+    size_t available() const {
+        return _totalSize() - used();
+    }
+
+    bool empty() const
+    {
+        return 0 == used();
+    }
+
+    bool full() const
+    {
+        return 0 == available();
+    }
+
+    /*!
+     * \brief Attempt to allocate a new slot of the type \p T and return its storage pointer.
+     * \return Upon success a pointer to an storage of an element of the type \p T.
+     * If the allocation fails (because neither the magazine of this thread
+     * nor the shared pool has a free slot) then a nullptr is returned.
+     * \see free(T*)
+     */
+    T* alloc()
+    {
+        const unsigned int threadIdx = CMagazineThreadIndex::current();
+        T* slot = nullptr;
+        if (CMagazineThreadIndex::kNone == threadIdx)
+        {
+            Slot* const pooled = _pool.alloc();
+            slot = (nullptr == pooled) ? nullptr : _storageOf(pooled);
+        }
+        else
+        {
+            Magazine& magazine = _magazines[threadIdx];
+            _increment(magazine.allocs);
+            unsigned int count = magazine.count.load(std::memory_order_relaxed);
+            if (0 != count)
+            {
+                _increment(magazine.hits);
+            }
+            else
+            {
+                count = _refill(magazine);
+            }
+            if (0 != count)
+            {
+                slot = magazine.slots[--count];
+                magazine.count.store(count, std::memory_order_relaxed);
+            }
+        }
+        return slot;
+    }
+
+    /*!
+     * \brief Frees an pointer to a slot of the type \p T that has been allocated previously by alloc().
+     * \param inBuffPtr A Pointer that has been prev. allocated by \ref alloc().
+     * \return true upon success. false on failure (e.g. already freed or if \p is inBuffPtr not an owner of this allocator)
+     * \see alloc()
+     */
+    bool free(T* inBuffPtr)
+    {
+        if (nullptr == inBuffPtr)
+        {
+            return true;
+        }
+        Slot* const slot = reinterpret_cast<Slot*>(inBuffPtr);
+        if (_pool.indexOf(slot) >= _totalSize())
+        {
+            return false;
+        }
+        const unsigned int threadIdx = CMagazineThreadIndex::current();
+        if (CMagazineThreadIndex::kNone == threadIdx)
+        {
+            slot->owner.store(kNoOwner, std::memory_order_relaxed);
+            return _pool.free(slot);
+        }
+
+        const unsigned int owner = slot->owner.load(std::memory_order_relaxed);
+        if (kNoOwner == owner)
+        {
+            return false; // Is free in the shared pool
+        }
+        Magazine& magazine = _magazines[threadIdx];
+        unsigned int count = magazine.count.load(std::memory_order_relaxed);
+        if (owner == threadIdx + 1)
+        {
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                if (inBuffPtr == magazine.slots[i])
+                {
+                    return false; // Is free in our magazine
+                }
+            }
+        }
+        else
+        {
+            _increment(magazine.crossThreadFrees);
+            slot->owner.store(threadIdx + 1, std::memory_order_relaxed);
+        }
+        if (MAGAZINE_SIZE == count)
+        {
+            count = _flush(magazine);
+        }
+        magazine.slots[count] = inBuffPtr;
+        magazine.count.store(count + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*!
+     * \brief Returns the slots cached by the magazine of the calling thread
+     * to the shared pool.
+     */
+    void flushThisThread()
+    {
+        const unsigned int threadIdx = CMagazineThreadIndex::current();
+        if (CMagazineThreadIndex::kNone != threadIdx)
+        {
+            _flushThread(this, threadIdx);
+        }
+    }
+
+    /*!
+     * \brief Sums up the statistics of all threads.
+     * \note This is a snapshot only if other threads allocate or free concurrently.
+     */
+    MagazineStatistics statistics() const
+    {
+        MagazineStatistics result;
+        for (const Magazine& magazine : _magazines)
+        {
+            result.allocs += magazine.allocs.load(std::memory_order_relaxed);
+            result.hits += magazine.hits.load(std::memory_order_relaxed);
+            result.refills += magazine.refills.load(std::memory_order_relaxed);
+            result.flushes += magazine.flushes.load(std::memory_order_relaxed);
+            result.crossThreadFrees += magazine.crossThreadFrees.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+private:
+    // The tag of a slot is the index of the thread whose magazine has taken it + 1.
+    static constexpr unsigned int kNoOwner = 0;
+    static constexpr unsigned int kBatchSize = MAGAZINE_SIZE / 2;
+
+    /*
+     * A slot of the shared pool: The storage handed out (at its start) and
+     * the owner tag - on the same cache line unless T is large.
+     */
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+        std::atomic<unsigned int> owner{kNoOwner};
+    };
+
+    /*
+     * The magazine of a thread. It is written by this thread only - the
+     * atomics just allow other threads to read the statistics.
+     */
+    struct alignas(64) Magazine
+    {
+        std::atomic<unsigned int> count{0};
+        T* slots[MAGAZINE_SIZE];
+        std::atomic<uint64_t> allocs{0};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> refills{0};
+        std::atomic<uint64_t> flushes{0};
+        std::atomic<uint64_t> crossThreadFrees{0};
+    };
+
+    static constexpr size_t _totalSize() { return size_t(1)<<NR_OF_ELEMENTS_LOG2N;}
+
+    static T* _storageOf(Slot* inSlot) {
+        return reinterpret_cast<T*>(inSlot->storage); }
+
+    /*
+     * Increments a counter that is written by a single thread only (no
+     * locked read-modify-write).
+     */
+    static void _increment(std::atomic<uint64_t>& ioCounter)
+    {
+        ioCounter.store(ioCounter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /*
+     * Returns all slots of the magazine of the thread inThreadIdx to the
+     * shared pool. This is called by that thread only - or on its exit.
+     */
+    static void _flushThread(void* ioAllocator, unsigned int inThreadIdx)
+    {
+        CMagazineBlockAlloc& allocator = *static_cast<CMagazineBlockAlloc*>(ioAllocator);
+        Magazine& magazine = allocator._magazines[inThreadIdx];
+        const unsigned int count = magazine.count.load(std::memory_order_relaxed);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            allocator._release(magazine.slots[i]);
+        }
+        magazine.count.store(0, std::memory_order_relaxed);
+    }
+
+    void _release(T* inStorage)
+    {
+        Slot* const slot = reinterpret_cast<Slot*>(inStorage);
+        slot->owner.store(kNoOwner, std::memory_order_relaxed);
+        _pool.free(slot);
+    }
+
+    size_t _cachedCount() const
+    {
+        size_t count = 0;
+        for (const Magazine& magazine : _magazines)
+        {
+            count += magazine.count.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    unsigned int _refill(Magazine& ioMagazine)
+    {
+        const unsigned int owner = static_cast<unsigned int>(&ioMagazine - _magazines) + 1;
+        unsigned int count = 0;
+        while (count < kBatchSize)
+        {
+            Slot* const slot = _pool.alloc();
+            if (nullptr == slot)
+            {
+                break;
+            }
+            slot->owner.store(owner, std::memory_order_relaxed);
+            ioMagazine.slots[count++] = _storageOf(slot);
+        }
+        if (0 != count)
+        {
+            _increment(ioMagazine.refills);
+        }
+        return count;
+    }
+
+    unsigned int _flush(Magazine& ioMagazine)
+    {
+        // The oldest (coldest) slots are at the bottom of the stack.
+        for (unsigned int i = 0; i < kBatchSize; ++i)
+        {
+            _release(ioMagazine.slots[i]);
+        }
+        for (unsigned int i = kBatchSize; i < MAGAZINE_SIZE; ++i)
+        {
+            ioMagazine.slots[i - kBatchSize] = ioMagazine.slots[i];
+        }
+        _increment(ioMagazine.flushes);
+        return MAGAZINE_SIZE - kBatchSize;
+    }
+
+    CConcurrentBlockAlloc<Slot, NR_OF_ELEMENTS_LOG2N> _pool;
+    Magazine _magazines[kMaxThreads];
+}; // class CMagazineBlockAlloc
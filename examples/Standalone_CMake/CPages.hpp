@@ -0,0 +1,171 @@
+#pragma once
+/* ==========================================================================
+ * @(#)File: CPages.hpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define BLOCK_ALLOC_WITH_MMAP 1
+#endif
+
+/*!
+ * \brief Takes whole pages from the OS and returns them.
+ *
+ * With mmap() the pages are committed by the OS on their first touch and
+ * returned to it by unmap() or decommit(). Other platforms fall back to the heap.
+ */
+class CPages
+{
+public:
+    static constexpr size_t kHugePageSize = size_t(2) << 20;
+
+    static size_t pageSize()
+    {
+#if defined(BLOCK_ALLOC_WITH_MMAP)
+        static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return pageSize;
+#else
+        return 4096;
+#endif
+    }
+
+    static size_t roundUp(size_t inSize, size_t inAlignment) {
+        return (inSize + inAlignment - 1) & ~(inAlignment - 1); }
+
+    /*!
+     * \brief Maps \p inSize bytes (rounded up to whole pages) at an address
+     * that is a multiple of \p inAlignment (a power of 2).
+     * \param inHugePages Advises the OS to back the pages by huge pages.
+     * \return The pages or nullptr if the OS is out of memory.
+     */
+    static void* map(size_t inSize, size_t inAlignment, bool inHugePages = false)
+    {
+        inSize = roundUp(inSize, pageSize());
+        inAlignment = (inAlignment < pageSize()) ? pageSize() : inAlignment;
+#if defined(BLOCK_ALLOC_WITH_MMAP)
+        // Map a larger window and cut off the unaligned head and the tail.
+        const size_t windowSize = inSize + inAlignment - pageSize();
+        void* const window = mmap(nullptr, windowSize, PROT_READ | PROT_WRITE, kMapFlags, -1, 0);
+        if (MAP_FAILED == window)
+        {
+            return nullptr;
+        }
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(window);
+        const uintptr_t aligned = roundUp(begin, inAlignment);
+        if (aligned > begin)
+        {
+            munmap(window, aligned - begin);
+        }
+        if (begin + windowSize > aligned + inSize)
+        {
+            munmap(reinterpret_cast<void*>(aligned + inSize), begin + windowSize - aligned - inSize);
+        }
+    #if defined(MADV_HUGEPAGE)
+        if (inHugePages)
+        {
+            madvise(reinterpret_cast<void*>(aligned), inSize, MADV_HUGEPAGE);
+        }
+    #endif
+        return reinterpret_cast<void*>(aligned);
+#else
+        (void)inHugePages;
+        // Remember the address of the heap block in front of the aligned pages.
+        void* const block = std::malloc(inSize + inAlignment + sizeof(void*));
+        if (nullptr == block)
+        {
+            return nullptr;
+        }
+        const uintptr_t aligned = roundUp(reinterpret_cast<uintptr_t>(block) + sizeof(void*), inAlignment);
+        reinterpret_cast<void**>(aligned)[-1] = block;
+        return reinterpret_cast<void*>(aligned);
+#endif
+    }
+
+    /*!
+     * \brief Maps \p inSize bytes (a multiple of kHugePageSize) from the
+     * reserved huge pages of the OS (MAP_HUGETLB).
+     * \return The pages or nullptr if there are no (or not enough) huge pages.
+     */
+    static void* mapHugeTlb(size_t inSize)
+    {
+#if defined(BLOCK_ALLOC_WITH_MMAP) && defined(MAP_HUGETLB)
+        // Without MAP_NORESERVE - so this fails now rather than on a touch if there are no huge pages.
+        void* const pages = mmap(nullptr, inSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        return (MAP_FAILED == pages) ? nullptr : pages;
+#else
+        (void)inSize;
+        return nullptr;
+#endif
+    }
+
+    /*!
+     * \brief Returns the physical memory of \p inSize bytes at \p inPages
+     * (both multiples of the page size) to the OS, but keeps them mapped. The
+     * next touch commits fresh zero pages.
+     * \return false if this is not supported.
+     */
+    static bool decommit(void* inPages, size_t inSize)
+    {
+#if defined(BLOCK_ALLOC_WITH_MMAP)
+        return 0 == madvise(inPages, inSize, MADV_DONTNEED);
+#else
+        (void)inPages;
+        (void)inSize;
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Returns the pages of a map() of \p inSize bytes to the OS.
+     */
+    static void unmap(void* inPages, size_t inSize)
+    {
+#if defined(BLOCK_ALLOC_WITH_MMAP)
+        munmap(inPages, roundUp(inSize, pageSize()));
+#else
+        (void)inSize;
+        std::free(static_cast<void**>(inPages)[-1]);
+#endif
+    }
+
+private:
+#if defined(BLOCK_ALLOC_WITH_MMAP)
+    // Reserve no swap for the pages either - they are committed on their first touch.
+    #if defined(MAP_NORESERVE)
+    static constexpr int kMapFlags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+    #else
+    static constexpr int kMapFlags = MAP_PRIVATE | MAP_ANONYMOUS;
+    #endif
+#endif
+}; // class CPages
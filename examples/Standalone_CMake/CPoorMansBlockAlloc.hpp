@@ -29,17 +29,664 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  *
  * ========================================================================== */
+#include <chrono>
 #include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
 
-template <typename T, size_t NR_OF_ELEMENTS_LOG2N>
-class CPoorMansBlockAlloc
+#include "CPages.hpp"
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+/*!
+ * \brief Returns the index of the lowest set bit of \p inWord (which must not be 0).
+ */
+inline unsigned int countTrailingZeros(uint64_t inWord)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned int>(__builtin_ctzll(inWord));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, inWord);
+    return static_cast<unsigned int>(idx);
+#else
+    // De Bruijn multiplication of the isolated lowest bit
+    static const unsigned int kDeBruijnIndex[64] = {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6 };
+    return kDeBruijnIndex[((inWord & (~inWord + 1)) * 0x03f79d71b4cb0a89ull) >> 58];
+#endif
+}
+
+/*
+ * The geometry of a hierarchical bitmap of inNrOfBits bits: Level 0 holds
+ * one bit per slot, every other level one bit per word of the level below.
+ * The top level is a single word.
+ */
+constexpr size_t bitmapWordsOfLevel(size_t inNrOfBits, size_t inLevel)
+{
+    return (0 == inLevel) ? (inNrOfBits + 63) / 64
+        : (bitmapWordsOfLevel(inNrOfBits, inLevel - 1) + 63) / 64;
+}
+
+constexpr size_t bitmapNrOfLevels(size_t inNrOfBits, size_t inLevel = 0)
+{
+    return (1 == bitmapWordsOfLevel(inNrOfBits, inLevel)) ? inLevel + 1
+        : bitmapNrOfLevels(inNrOfBits, inLevel + 1);
+}
+
+constexpr size_t bitmapOffsetOfLevel(size_t inNrOfBits, size_t inLevel)
+{
+    return (0 == inLevel) ? 0
+        : bitmapOffsetOfLevel(inNrOfBits, inLevel - 1) + bitmapWordsOfLevel(inNrOfBits, inLevel - 1);
+}
+
+/*!
+ * \brief A hierarchical bitmap of the free slots of a pool.
+ *
+ * A set bit of level 0 marks a free slot. A set bit of an upper level marks
+ * a word of the level below that has at least a single free slot. So the
+ * lowest free slot is found by descending from the top word by count
+ * trailing zeros - and claiming or releasing a slot just updates the words
+ * on its path. Both take O(levels), i.e. 4 steps for 16M slots.
+ */
+template <size_t NR_OF_BITS>
+class CBlockBitmap
+{
+public:
+    static constexpr size_t kNotFound = ~size_t(0);
+
+    CBlockBitmap()
+    {
+        reset();
+    }
+
+    /*!
+     * \brief Marks all slots as free.
+     */
+    void reset()
+    {
+        for (size_t level = 0; level < kNrOfLevels; ++level)
+        {
+            const size_t nrOfBits = (0 == level) ? NR_OF_BITS : bitmapWordsOfLevel(NR_OF_BITS, level - 1);
+            uint64_t* const words = _level(level);
+            for (size_t idx = 0; idx < bitmapWordsOfLevel(NR_OF_BITS, level); ++idx)
+            {
+                const size_t bitsOfWord = nrOfBits - idx * 64;
+                words[idx] = (bitsOfWord >= 64) ? ~uint64_t(0) : ((uint64_t(1) << bitsOfWord) - 1);
+            }
+        }
+    }
+
+    /*!
+     * \brief Claims the lowest free slot.
+     * \return The index of the slot or kNotFound if there is no free slot.
+     */
+    size_t claimFirst()
+    {
+        if (0 == _level(kNrOfLevels - 1)[0])
+        {
+            return kNotFound;
+        }
+        size_t idx = 0;
+        for (size_t level = kNrOfLevels; level-- > 0;)
+        {
+            idx = idx * 64 + countTrailingZeros(_level(level)[idx]);
+        }
+        _clear(idx);
+        return idx;
+    }
+
+    /*!
+     * \brief Claims up to \p inCount of the lowest free slots - a whole word
+     * of the bitmap at a time.
+     * \param inEmit Called with the index of every claimed slot.
+     * \return The number of the claimed slots.
+     */
+    template <typename EMIT>
+    size_t claimFirstN(size_t inCount, EMIT inEmit)
+    {
+        size_t claimed = 0;
+        while ((claimed < inCount) and (0 != _level(kNrOfLevels - 1)[0]))
+        {
+            size_t wordIdx = 0;
+            for (size_t level = kNrOfLevels; level-- > 1;)
+            {
+                wordIdx = wordIdx * 64 + countTrailingZeros(_level(level)[wordIdx]);
+            }
+            uint64_t& word = _level(0)[wordIdx];
+            while ((0 != word) and (claimed < inCount))
+            {
+                inEmit(wordIdx * 64 + countTrailingZeros(word));
+                word &= word - 1;
+                ++claimed;
+            }
+            if (0 == word)
+            {
+                _clear(wordIdx, 1);
+            }
+        }
+        return claimed;
+    }
+
+    /*!
+     * \brief Claims the slot \p inIdx.
+     * \return false if this slot has not been free.
+     */
+    bool claim(size_t inIdx)
+    {
+        if ((inIdx >= NR_OF_BITS) || not isFree(inIdx))
+        {
+            return false;
+        }
+        _clear(inIdx);
+        return true;
+    }
+
+    /*!
+     * \brief Releases the slot \p inIdx.
+     * \return false if this slot has not been claimed.
+     */
+    bool release(size_t inIdx)
+    {
+        if ((inIdx >= NR_OF_BITS) || isFree(inIdx))
+        {
+            return false;
+        }
+        for (size_t level = 0; level < kNrOfLevels; ++level)
+        {
+            uint64_t& word = _level(level)[inIdx / 64];
+            const bool wasFull = (0 == word);
+            word |= uint64_t(1) << (inIdx % 64);
+            if (not wasFull)
+            {
+                break;
+            }
+            inIdx /= 64;
+        }
+        return true;
+    }
+
+    bool isFree(size_t inIdx) const
+    {
+        return 0 != (_words[inIdx / 64] & (uint64_t(1) << (inIdx % 64)));
+    }
+
+private:
+    static constexpr size_t kNrOfLevels = bitmapNrOfLevels(NR_OF_BITS);
+
+    uint64_t* _level(size_t inLevel) {
+        return _words + bitmapOffsetOfLevel(NR_OF_BITS, inLevel); }
+
+    void _clear(size_t inIdx, size_t inLevel = 0)
+    {
+        for (size_t level = inLevel; level < kNrOfLevels; ++level)
+        {
+            uint64_t& word = _level(level)[inIdx / 64];
+            word &= ~(uint64_t(1) << (inIdx % 64));
+            if (0 != word)
+            {
+                break;
+            }
+            inIdx /= 64;
+        }
+    }
+
+    uint64_t _words[bitmapOffsetOfLevel(NR_OF_BITS, bitmapNrOfLevels(NR_OF_BITS))];
+}; // class CBlockBitmap
+
+/*!
+ * \brief Reuse policy: Hands out the free slot of the lowest index.
+ *
+ * The live slots stay packed at the start of the pool - but a slot that has
+ * just been freed (and is still hot in the cache) is reused only if there is
+ * no lower free one.
+ */
+struct LowestIndexFirst
+{
+    static constexpr bool kLinksInFreeSlots = false;
+
+    template <typename T, size_t NR_OF_SLOTS>
+    class Slots
+    {
+    public:
+        void reset() {
+            _bitmap.reset(); }
+
+        size_t acquire(T*) {
+            return _bitmap.claimFirst(); }
+
+        bool release(T*, size_t inIdx) {
+            return _bitmap.release(inIdx); }
+
+        bool isFree(size_t inIdx) const {
+            return _bitmap.isFree(inIdx); }
+
+        size_t acquireBulk(T* ioSlots, T** outSlots, size_t inCount)
+        {
+            return _bitmap.claimFirstN(inCount, [&](size_t inIdx) { *outSlots++ = ioSlots + inIdx; });
+        }
+
+        // release() in two steps: The bit only (which can be taken back) - and the slot.
+        bool releaseBit(size_t inIdx) {
+            return _bitmap.release(inIdx); }
+
+        void claimBit(size_t inIdx) {
+            _bitmap.claim(inIdx); }
+
+        void link(T*, size_t) {}
+
+    private:
+        CBlockBitmap<NR_OF_SLOTS> _bitmap;
+    };
+};
+
+/*!
+ * \brief Reuse policy: Hands out the slot that has been freed last (LIFO).
+ *
+ * The free slots are chained to a list through their own storage, so there
+ * is no metadata besides the head of the list - and both alloc() and free()
+ * are O(1). Slots that have never been handed out are not linked at all but
+ * taken by a bump index. The bitmap is kept to validate free() against
+ * foreign pointers and double frees.
+ * \note The slots of \p T need to be large enough to hold an index of the
+ * pool (2 bytes for fewer than 64K slots, 4 bytes for fewer than 4G slots).
+ */
+struct LastFreedFirst
+{
+    static constexpr bool kLinksInFreeSlots = true;
+
+    template <typename T, size_t NR_OF_SLOTS>
+    class Slots
+    {
+        using Link = typename std::conditional<(uint64_t(NR_OF_SLOTS) < (uint64_t(1) << 16)), uint16_t,
+            typename std::conditional<(uint64_t(NR_OF_SLOTS) < (uint64_t(1) << 32)), uint32_t, uint64_t>::type>::type;
+        static_assert(sizeof(T) >= sizeof(Link), "The slots are too small to hold the links of the free list");
+
+        static constexpr Link kEndOfList = static_cast<Link>(~Link(0));
+
+    public:
+        void reset()
+        {
+            _bitmap.reset();
+            _head = kEndOfList;
+            _untouched = 0;
+        }
+
+        size_t acquire(T* ioSlots)
+        {
+            size_t idx;
+            if (kEndOfList != _head)
+            {
+                idx = _head;
+                std::memcpy(&_head, static_cast<const void*>(ioSlots + idx), sizeof(Link));
+            }
+            else if (_untouched < NR_OF_SLOTS)
+            {
+                idx = _untouched++;
+            }
+            else
+            {
+                return CBlockBitmap<NR_OF_SLOTS>::kNotFound;
+            }
+            _bitmap.claim(idx);
+            return idx;
+        }
+
+        bool release(T* ioSlots, size_t inIdx)
+        {
+            if (not releaseBit(inIdx))
+            {
+                return false;
+            }
+            link(ioSlots, inIdx);
+            return true;
+        }
+
+        bool isFree(size_t inIdx) const {
+            return _bitmap.isFree(inIdx); }
+
+        size_t acquireBulk(T* ioSlots, T** outSlots, size_t inCount)
+        {
+            size_t acquired = 0;
+            for (; acquired < inCount; ++acquired)
+            {
+                const size_t idx = acquire(ioSlots);
+                if (CBlockBitmap<NR_OF_SLOTS>::kNotFound == idx)
+                {
+                    break;
+                }
+                outSlots[acquired] = ioSlots + idx;
+            }
+            return acquired;
+        }
+
+        // release() in two steps: The bit only (which can be taken back) - and the link in the slot.
+        bool releaseBit(size_t inIdx) {
+            return _bitmap.release(inIdx); }
+
+        void claimBit(size_t inIdx) {
+            _bitmap.claim(inIdx); }
+
+        void link(T* ioSlots, size_t inIdx)
+        {
+            std::memcpy(static_cast<void*>(ioSlots + inIdx), &_head, sizeof(Link));
+            _head = static_cast<Link>(inIdx);
+        }
+
+    private:
+        CBlockBitmap<NR_OF_SLOTS> _bitmap;
+        Link _head = kEndOfList;
+        size_t _untouched = 0;
+    };
+};
+
+/*!
+ * \brief Storage policy: The slots are a member of the pool - so they live
+ * wherever the pool lives (on the stack, on the heap or in static storage).
+ */
+struct InlineStorage
+{
+    template <typename T, size_t NR_OF_SLOTS>
+    class Buffer
+    {
+    public:
+        T* slots() {
+            return reinterpret_cast<T*>(_storage); }
+
+        size_t capacity() const {
+            return NR_OF_SLOTS; }
+
+        size_t decommitGranularity() const {
+            return 0; }
+
+        size_t decommit(size_t, size_t) {
+            return 0; }
+
+    private:
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage[NR_OF_SLOTS];
+    };
+};
+
+/*!
+ * \brief Storage policy: The slots are mapped from the OS.
+ *
+ * Buffers of 2 MB and more are taken from the reserved huge pages
+ * (MAP_HUGETLB) if there are any - otherwise they are aligned to 2 MB and
+ * advised to be backed by transparent huge pages. Either way the pages are
+ * committed on their first touch only, and trim() can return the pages of
+ * the free slots. So a large pool costs little memory and few TLB entries.
+ * \note The capacity of a pool is 0 if the OS has been out of memory.
+ */
+struct MappedStorage
+{
+    template <typename T, size_t NR_OF_SLOTS>
+    class Buffer
+    {
+    public:
+        Buffer()
+        {
+            const size_t size = NR_OF_SLOTS * sizeof(T);
+            if (size >= CPages::kHugePageSize)
+            {
+                _mappedSize = CPages::roundUp(size, CPages::kHugePageSize);
+                _slots = static_cast<T*>(CPages::mapHugeTlb(_mappedSize));
+                _granularity = CPages::kHugePageSize;
+            }
+            if (nullptr == _slots)
+            {
+                const bool huge = (size >= CPages::kHugePageSize);
+                _mappedSize = CPages::roundUp(size, CPages::pageSize());
+                _slots = static_cast<T*>(CPages::map(size, huge ? CPages::kHugePageSize : alignof(T), huge));
+                _granularity = CPages::pageSize();
+            }
+        }
+
+        ~Buffer()
+        {
+            if (nullptr != _slots)
+            {
+                CPages::unmap(_slots, _mappedSize);
+            }
+        }
+
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        T* slots() {
+            return _slots; }
+
+        size_t capacity() const {
+            return (nullptr != _slots) ? NR_OF_SLOTS : 0; }
+
+        /*!
+         * \return The size of the pages - 2 MB if the buffer is mapped from MAP_HUGETLB pages.
+         */
+        size_t decommitGranularity() const {
+            return (nullptr != _slots) ? _granularity : 0; }
+
+        /*!
+         * \brief Decommits \p inSize bytes at \p inOffset (a multiple of the granularity).
+         * \return The number of the decommitted bytes.
+         */
+        size_t decommit(size_t inOffset, size_t inSize)
+        {
+            const size_t size = (inOffset + inSize <= _mappedSize) ? inSize : _mappedSize - inOffset;
+            return CPages::decommit(reinterpret_cast<char*>(_slots) + inOffset, size) ? size : 0;
+        }
+
+    private:
+        T* _slots = nullptr;
+        size_t _mappedSize = 0;
+        size_t _granularity = 0;
+    };
+};
+
+/*!
+ * \brief A snapshot of the statistics of an Instrumented pool.
+ */
+struct CBlockAllocStatistics
+{
+    static constexpr size_t kNrOfOccupancyBins = 10;
+
+    size_t used = 0;
+    size_t capacity = 0;
+    size_t peakUsed = 0;          //!< The high-water mark of used()
+    uint64_t allocs = 0;          //!< The number of the allocated slots
+    uint64_t failedAllocs = 0;    //!< The allocations that failed because the pool was full
+    uint64_t frees = 0;           //!< The number of the freed slots
+    uint64_t doubleFrees = 0;     //!< The frees of slots that were not in use
+    uint64_t invalidFrees = 0;    //!< The frees of pointers that do not belong to the pool
+    uint64_t allocSamples = 0;    //!< The number of the timed alloc() calls
+    uint64_t allocNanosTotal = 0;
+    uint64_t allocNanosMax = 0;
+    uint64_t freeSamples = 0;     //!< The number of the timed free() calls
+    uint64_t freeNanosTotal = 0;
+    uint64_t freeNanosMax = 0;
+    //! The occupancy (used() / capacity in tenths) at the timed alloc() calls
+    uint64_t occupancy[kNrOfOccupancyBins] = {};
+
+    uint64_t meanAllocNanos() const {
+        return (0 != allocSamples) ? allocNanosTotal / allocSamples : 0; }
+
+    uint64_t meanFreeNanos() const {
+        return (0 != freeSamples) ? freeNanosTotal / freeSamples : 0; }
+
+    /*!
+     * \brief Prints the snapshot to \p ioLogger - anything with a printf like
+     * log(const char* fmt, ...), e.g. *tsunit::pLogger.
+     */
+    template <typename LOGGER>
+    void logTo(LOGGER& ioLogger, const char* inName) const
+    {
+        ioLogger.log("%s: %llu of %llu slots used, peak %llu\n", inName,
+            static_cast<unsigned long long>(used), static_cast<unsigned long long>(capacity),
+            static_cast<unsigned long long>(peakUsed));
+        ioLogger.log("  allocs %llu (failed %llu), frees %llu (double %llu, invalid %llu)\n",
+            static_cast<unsigned long long>(allocs), static_cast<unsigned long long>(failedAllocs),
+            static_cast<unsigned long long>(frees), static_cast<unsigned long long>(doubleFrees),
+            static_cast<unsigned long long>(invalidFrees));
+        ioLogger.log("  alloc %llu ns mean, %llu ns max (%llu samples), free %llu ns mean, %llu ns max (%llu samples)\n",
+            static_cast<unsigned long long>(meanAllocNanos()), static_cast<unsigned long long>(allocNanosMax),
+            static_cast<unsigned long long>(allocSamples), static_cast<unsigned long long>(meanFreeNanos()),
+            static_cast<unsigned long long>(freeNanosMax), static_cast<unsigned long long>(freeSamples));
+        ioLogger.log("  occupancy:");
+        for (size_t bin = 0; bin < kNrOfOccupancyBins; ++bin)
+        {
+            ioLogger.log(" %llu", static_cast<unsigned long long>(occupancy[bin]));
+        }
+        ioLogger.log("\n");
+    }
+};
+
+/*!
+ * \brief Instrumentation policy: Nothing is recorded. The hooks are empty
+ * and the Probe is an empty base - so this costs neither time nor space.
+ */
+struct NoInstrumentation
+{
+    class Probe
+    {
+    protected:
+        struct Sample {};
+
+        Sample _beginAlloc() {
+            return Sample(); }
+
+        Sample _beginFree() {
+            return Sample(); }
+
+        void _allocated(const Sample&, size_t, size_t, size_t, size_t) {}
+        void _freed(const Sample&, size_t, size_t, size_t) {}
+        void _resetStatistics() {}
+    };
+};
+
+/*!
+ * \brief Instrumentation policy: Records the high-water mark, the failed
+ * allocations, the double and invalid frees - and times every
+ * 2^SAMPLE_PERIOD_LOG2th alloc() and free() (which records the occupancy
+ * as well). statistics() takes a snapshot.
+ * \note Like the pool the counters are not thread safe.
+ */
+template <unsigned int SAMPLE_PERIOD_LOG2 = 6>
+struct Instrumented
 {
-    T _buffer[1<<NR_OF_ELEMENTS_LOG2N];
-    uint8_t _usedFlags = 0b00000000;
-    uint8_t _usedCount = 0;
+    class Probe
+    {
+    protected:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Sample
+        {
+            bool timed;
+            Clock::time_point start;
+        };
+
+        Sample _beginAlloc()
+        {
+            const bool timed = (0 == (_allocCalls++ & kSampleMask));
+            return Sample{timed, timed ? Clock::now() : Clock::time_point()};
+        }
+
+        Sample _beginFree()
+        {
+            const bool timed = (0 == (_freeCalls++ & kSampleMask));
+            return Sample{timed, timed ? Clock::now() : Clock::time_point()};
+        }
+
+        void _allocated(const Sample& inSample, size_t inCount, size_t inRequested, size_t inUsed, size_t inCapacity)
+        {
+            if (inSample.timed)
+            {
+                _record(inSample, _stats.allocSamples, _stats.allocNanosTotal, _stats.allocNanosMax);
+                const size_t bin = (0 != inCapacity) ? inUsed * CBlockAllocStatistics::kNrOfOccupancyBins / inCapacity : 0;
+                ++_stats.occupancy[(bin < CBlockAllocStatistics::kNrOfOccupancyBins) ? bin : CBlockAllocStatistics::kNrOfOccupancyBins - 1];
+            }
+            _stats.allocs += inCount;
+            _stats.failedAllocs += (inCount < inRequested) ? 1 : 0;
+            _stats.peakUsed = (inUsed > _stats.peakUsed) ? inUsed : _stats.peakUsed;
+        }
+
+        void _freed(const Sample& inSample, size_t inCount, size_t inDoubleFrees, size_t inInvalidFrees)
+        {
+            if (inSample.timed)
+            {
+                _record(inSample, _stats.freeSamples, _stats.freeNanosTotal, _stats.freeNanosMax);
+            }
+            _stats.frees += inCount;
+            _stats.doubleFrees += inDoubleFrees;
+            _stats.invalidFrees += inInvalidFrees;
+        }
+
+        void _resetStatistics()
+        {
+            _stats = CBlockAllocStatistics();
+            _allocCalls = 0;
+            _freeCalls = 0;
+        }
+
+        CBlockAllocStatistics _snapshot(size_t inUsed, size_t inCapacity) const
+        {
+            CBlockAllocStatistics stats = _stats;
+            stats.used = inUsed;
+            stats.capacity = inCapacity;
+            return stats;
+        }
+
+    private:
+        static constexpr uint64_t kSampleMask = (uint64_t(1) << SAMPLE_PERIOD_LOG2) - 1;
+
+        static void _record(const Sample& inSample, uint64_t& ioSamples, uint64_t& ioTotal, uint64_t& ioMax)
+        {
+            const uint64_t nanos = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - inSample.start).count());
+            ++ioSamples;
+            ioTotal += nanos;
+            ioMax = (nanos > ioMax) ? nanos : ioMax;
+        }
+
+        CBlockAllocStatistics _stats;
+        uint64_t _allocCalls = 0;
+        uint64_t _freeCalls = 0;
+    };
+};
+
+/*!
+ * \brief A pool of 2^NR_OF_ELEMENTS_LOG2N slots of the type \p T.
+ *
+ * The slots are uninitialized storage: alloc() and free() hand out and take
+ * back raw storage, emplace() and destroy() construct and destruct objects
+ * of the type \p T in place. So creating a pool constructs nothing.
+ * \tparam REUSE_POLICY Which free slot alloc() hands out:
+ * LowestIndexFirst (default) or LastFreedFirst.
+ * \tparam STORAGE_POLICY Where the slots live: InlineStorage (default) or MappedStorage.
+ * \tparam INSTRUMENTATION_POLICY What is recorded: NoInstrumentation (default) or Instrumented<>.
+ */
+template <typename T, size_t NR_OF_ELEMENTS_LOG2N, typename REUSE_POLICY = LowestIndexFirst,
+    typename STORAGE_POLICY = InlineStorage, typename INSTRUMENTATION_POLICY = NoInstrumentation>
+class CPoorMansBlockAlloc : private INSTRUMENTATION_POLICY::Probe
+{
+    typedef typename INSTRUMENTATION_POLICY::Probe Probe;
+
+    typename STORAGE_POLICY::template Buffer<T, size_t(1)<<NR_OF_ELEMENTS_LOG2N> _storage;
+    typename REUSE_POLICY::template Slots<T, size_t(1)<<NR_OF_ELEMENTS_LOG2N> _freeSlots;
+    size_t _usedCount = 0;
 
 public:
+    class Handle;
+
     CPoorMansBlockAlloc() = default;
+    CPoorMansBlockAlloc(const CPoorMansBlockAlloc&) = delete;
+    CPoorMansBlockAlloc& operator=(const CPoorMansBlockAlloc&) = delete;
 
     /*!
      * \brief Asks how many storage slots of the allocators type \p T are currently in use.
@@ -62,7 +709,7 @@ public:
      * \see used() const
      */
     size_t available() const {
-        return _totalSize() - _usedCount;
+        return _storage.capacity() - _usedCount;
     }
 
     /*!
@@ -98,7 +745,10 @@ public:
      */
     T* alloc()
     {
-        return full() ? nullptr : _allocateNextFreeIndex();
+        const typename Probe::Sample sample = this->_beginAlloc();
+        T* const slot = full() ? nullptr : _allocateNextFreeIndex();
+        this->_allocated(sample, (nullptr != slot) ? 1 : 0, 1, _usedCount, _storage.capacity());
+        return slot;
     }
 
     /*!
@@ -117,68 +767,366 @@ public:
         }
         else
         {
+            const typename Probe::Sample sample = this->_beginFree();
+            const size_t offset = inBuffPtr - _slots();
+            const bool owned = (offset < _totalSize());
             if (not empty())
             {
-                size_t offset = inBuffPtr - _buffer;
-                if (offset < _totalSize())
+                // Just release slots that are actually used
+                success = owned and _freeSlots.release(_slots(), offset);
+                if (success)
                 {
-                    const uint32_t mask(1<<offset);
-                    if (_usedFlags & mask) // Just release slots that are actually used
-                    {
-                        _usedFlags &= ~mask;
-                        --_usedCount;
-                        success = true;
-                    }
-                    else
-                    {
-                        success = false;
-                    }
-                }
-                else
-                {
-                    success = false;
+                    --_usedCount;
                 }
             }
             else
             {
                 success = false;
             }
+            this->_freed(sample, success ? 1 : 0, (owned and not success) ? 1 : 0, owned ? 0 : 1);
         }
         return success;
     }
 
+    /*!
+     * \brief Allocates \p inCount slots at once - or none at all.
+     *
+     * Unlike \p inCount calls of alloc() this checks the capacity and updates
+     * the counter of the used slots once, and LowestIndexFirst claims a whole
+     * word (64 slots) of the bitmap at a time.
+     * \param outSlots Receives the \p inCount slots.
+     * \return true upon success. false if there are less than \p inCount slots available.
+     * \see allocSome(T**, size_t)
+     * \see freeBulk(T* const*, size_t)
+     */
+    bool allocBulk(T** outSlots, size_t inCount)
+    {
+        const typename Probe::Sample sample = this->_beginAlloc();
+        const bool success = (inCount <= available());
+        if (success)
+        {
+            _usedCount += _freeSlots.acquireBulk(_slots(), outSlots, inCount);
+        }
+        this->_allocated(sample, success ? inCount : 0, inCount, _usedCount, _storage.capacity());
+        return success;
+    }
+
+    /*!
+     * \brief Allocates up to \p inCount slots at once.
+     * \param outSlots Receives the allocated slots.
+     * \return The number of the allocated slots - less than \p inCount if the allocator became full.
+     * \see allocBulk(T**, size_t)
+     */
+    size_t allocSome(T** outSlots, size_t inCount)
+    {
+        const typename Probe::Sample sample = this->_beginAlloc();
+        const size_t count = (inCount < available()) ? inCount : available();
+        _usedCount += _freeSlots.acquireBulk(_slots(), outSlots, count);
+        this->_allocated(sample, count, inCount, _usedCount, _storage.capacity());
+        return count;
+    }
+
+    /*!
+     * \brief Frees \p inCount slots at once - or none at all.
+     * \param inSlots The slots to free. nullptr entries are skipped.
+     * \return true upon success. false if a slot is not in use (e.g. it is
+     * listed twice) or does not belong to this allocator - then no slot is freed.
+     * \see freeSome(T* const*, size_t)
+     */
+    bool freeBulk(T* const* inSlots, size_t inCount)
+    {
+        return inCount == _freeBulk(inSlots, inCount, true);
+    }
+
+    /*!
+     * \brief Frees the valid ones of \p inCount slots.
+     * \param inSlots The slots to free. nullptr entries are skipped.
+     * \return The number of the slots that have been freed - the nullptr
+     * entries count as freed (like free(nullptr) succeeds).
+     * \see freeBulk(T* const*, size_t)
+     */
+    size_t freeSome(T* const* inSlots, size_t inCount)
+    {
+        return _freeBulk(inSlots, inCount, false);
+    }
+
+    /*!
+     * \brief Returns the memory of the pages that hold free slots only to the
+     * OS (madvise(MADV_DONTNEED)) - the next alloc() of such a slot commits a
+     * fresh page. This takes effect with MappedStorage only.
+     * \note The free slots of LastFreedFirst hold the links of its list, so
+     * this is not available for it.
+     * \return The number of the bytes that have been decommitted.
+     */
+    size_t trim()
+    {
+        static_assert(not REUSE_POLICY::kLinksInFreeSlots, "The free slots of this reuse policy must not be decommitted");
+        const size_t granularity = _storage.decommitGranularity();
+        const size_t bufferSize = _totalSize() * sizeof(T);
+        size_t decommitted = 0;
+        for (size_t offset = 0; (0 != granularity) and (offset < bufferSize); offset += granularity)
+        {
+            const size_t end = (offset + granularity < bufferSize) ? offset + granularity : bufferSize;
+            bool allFree = true;
+            for (size_t idx = offset / sizeof(T); allFree and (idx <= (end - 1) / sizeof(T)); ++idx)
+            {
+                allFree = _freeSlots.isFree(idx);
+            }
+            if (allFree)
+            {
+                decommitted += _storage.decommit(offset, granularity);
+            }
+        }
+        return decommitted;
+    }
+
+    /*!
+     * \brief Constructs an object of the type \p T in a new slot.
+     * \param inArgs The arguments of the constructor.
+     * \return The object or nullptr if the allocator is full.
+     * \see destroy(T*)
+     */
+    template <typename... ARGS>
+    T* emplace(ARGS&&... inArgs)
+    {
+        T* const slot = alloc();
+        if (nullptr == slot)
+        {
+            return nullptr;
+        }
+        PendingSlot pending{this, slot};
+        T* const object = new (slot) T(std::forward<ARGS>(inArgs)...);
+        pending.slot = nullptr;
+        return object;
+    }
+
+    /*!
+     * \brief Destructs an object of emplace() and frees its slot.
+     * \return true upon success (or if \p inObject is nullptr). false if
+     * \p inObject is not a slot in use of this allocator - then nothing is destructed.
+     * \see emplace(ARGS&&...)
+     */
+    bool destroy(T* inObject)
+    {
+        if (nullptr == inObject)
+        {
+            return true;
+        }
+        const size_t offset = inObject - _slots();
+        if ((offset >= _totalSize()) or _freeSlots.isFree(offset))
+        {
+            const bool owned = (offset < _totalSize());
+            this->_freed(this->_beginFree(), 0, owned ? 1 : 0, owned ? 0 : 1);
+            return false;
+        }
+        inObject->~T();
+        return free(inObject);
+    }
+
+    /*!
+     * \brief Constructs an object of the type \p T in a new slot, owned by a Handle.
+     * \return The handle - which is empty if the allocator is full.
+     */
+    template <typename... ARGS>
+    Handle make(ARGS&&... inArgs)
+    {
+        return Handle(*this, emplace(std::forward<ARGS>(inArgs)...));
+    }
+
     /*!
      * \brief Clears all allocations within this object. This call effectively
      * resets all allocation buffers.
      * \note Users of these pointers should never rely on these contents afterwards.
+     * No destructors are run.
      */
     void clear()
     {
         _usedCount = 0;
-        _usedFlags = 0b00000000;
+        _freeSlots.reset();
+    }
+
+    /*!
+     * \brief Takes a snapshot of the statistics - available with the
+     * Instrumented policy only.
+     * \see CBlockAllocStatistics::logTo()
+     */
+    CBlockAllocStatistics statistics() const
+    {
+        return this->_snapshot(_usedCount, _storage.capacity());
+    }
+
+    /*!
+     * \brief Resets the statistics (but not the pool) - e.g. after a warm-up.
+     * The high-water mark starts over at the current used().
+     */
+    void resetStatistics()
+    {
+        this->_resetStatistics();
+        this->_allocated(typename Probe::Sample(), 0, 0, _usedCount, _storage.capacity());
     }
 
 private:
 
-    constexpr size_t _mask()      const { return (1<<NR_OF_ELEMENTS_LOG2N) -1;}
-    constexpr size_t _totalSize() const { return (1<<NR_OF_ELEMENTS_LOG2N);}
+    // Returns the slot of emplace() if the constructor throws.
+    struct PendingSlot
+    {
+        CPoorMansBlockAlloc* allocator;
+        T* slot;
 
-    static constexpr uint8_t kIndexNotFound = 0xff;
-    T* _allocateNextFreeIndex()
+        ~PendingSlot()
+        {
+            allocator->free(slot);
+        }
+    };
+
+    static constexpr size_t _totalSize() { return size_t(1)<<NR_OF_ELEMENTS_LOG2N;}
+
+    T* _slots() {
+        return _storage.slots(); }
+
+    /*
+     * Returns the number of the freed slots (including the nullptr entries).
+     * All or nothing releases just the bits of the bitmap first - which also
+     * detects the double entries. The slots are not touched (e.g. by the
+     * links of LastFreedFirst) before all entries have passed.
+     */
+    size_t _freeBulk(T* const* inSlots, size_t inCount, bool inAllOrNothing)
     {
-        T* foundSlot = nullptr;
-        for (unsigned int idx = 0; idx < _totalSize(); ++idx)
+        const typename Probe::Sample sample = this->_beginFree();
+        size_t freed = 0;
+        size_t skipped = 0;
+        size_t doubleFrees = 0;
+        size_t invalidFrees = 0;
+        for (size_t i = 0; i < inCount; ++i)
         {
-            const uint32_t mask(1 << idx);
-            if (not (_usedFlags & mask))
+            if (nullptr == inSlots[i])
             {
-                _usedFlags |= mask;
-                foundSlot = &_buffer[idx];
-                ++_usedCount;
-                break;
+                ++skipped;
+                continue;
+            }
+            const size_t offset = inSlots[i] - _slots();
+            const bool owned = (offset < _totalSize());
+            if (owned and (inAllOrNothing ? _freeSlots.releaseBit(offset) : _freeSlots.release(_slots(), offset)))
+            {
+                ++freed;
+                continue;
+            }
+            ++(owned ? doubleFrees : invalidFrees);
+            if (inAllOrNothing)
+            {
+                // Take back the bits of the preceding entries
+                while (i-- > 0)
+                {
+                    if (nullptr != inSlots[i])
+                    {
+                        _freeSlots.claimBit(inSlots[i] - _slots());
+                    }
+                }
+                this->_freed(sample, 0, doubleFrees, invalidFrees);
+                return 0;
+            }
+        }
+        if (inAllOrNothing)
+        {
+            for (size_t i = 0; i < inCount; ++i)
+            {
+                if (nullptr != inSlots[i])
+                {
+                    _freeSlots.link(_slots(), inSlots[i] - _slots());
+                }
             }
         }
-        return foundSlot;
+        _usedCount -= freed;
+        this->_freed(sample, freed, doubleFrees, invalidFrees);
+        return freed + skipped;
+    }
+
+    T* _allocateNextFreeIndex()
+    {
+        const size_t idx = _freeSlots.acquire(_slots());
+        ++_usedCount;
+        return _slots() + idx;
     }
 
 };
+
+/*!
+ * \brief Owns an object of CPoorMansBlockAlloc::make() - like a std::unique_ptr,
+ * it destroys the object when it goes out of scope.
+ */
+template <typename T, size_t NR_OF_ELEMENTS_LOG2N, typename REUSE_POLICY, typename STORAGE_POLICY,
+    typename INSTRUMENTATION_POLICY>
+class CPoorMansBlockAlloc<T, NR_OF_ELEMENTS_LOG2N, REUSE_POLICY, STORAGE_POLICY, INSTRUMENTATION_POLICY>::Handle
+{
+public:
+    Handle() = default;
+
+    Handle(CPoorMansBlockAlloc& ioAllocator, T* inObject)
+        : _allocator(&ioAllocator)
+        , _object(inObject)
+    {
+    }
+
+    Handle(Handle&& ioOther)
+        : _allocator(ioOther._allocator)
+        , _object(ioOther.release())
+    {
+    }
+
+    Handle& operator=(Handle&& ioOther)
+    {
+        if (this != &ioOther)
+        {
+            reset();
+            _allocator = ioOther._allocator;
+            _object = ioOther.release();
+        }
+        return *this;
+    }
+
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+    ~Handle()
+    {
+        reset();
+    }
+
+    T* get() const {
+        return _object; }
+
+    T& operator*() const {
+        return *_object; }
+
+    T* operator->() const {
+        return _object; }
+
+    explicit operator bool() const {
+        return nullptr != _object; }
+
+    /*!
+     * \brief Gives up the ownership - the object has to be destroyed by the caller.
+     */
+    T* release()
+    {
+        T* const object = _object;
+        _object = nullptr;
+        return object;
+    }
+
+    /*!
+     * \brief Destroys the object (if any).
+     */
+    void reset()
+    {
+        if (nullptr != _object)
+        {
+            _allocator->destroy(_object);
+            _object = nullptr;
+        }
+    }
+
+private:
+    CPoorMansBlockAlloc* _allocator = nullptr;
+    T* _object = nullptr;
+};
@@ -0,0 +1,481 @@
+#pragma once
+/* ==========================================================================
+ * @(#)File: CSlabAlloc.hpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "CPoorMansBlockAlloc.hpp"
+#include "CPages.hpp"
+#include <new>
+#include <type_traits>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+constexpr size_t log2Of(size_t inValue)
+{
+    return (inValue <= 1) ? 0 : 1 + log2Of(inValue / 2);
+}
+
+/*!
+ * \brief A size-class allocator of small blocks (16 up to 512 bytes).
+ *
+ * Every size class (16, 32, ... 512 bytes) takes its blocks from slabs: A
+ * slab is a CPoorMansBlockAlloc with 2 MB of blocks, mapped from the OS at
+ * an address that is a multiple of kSlabAlignment, with a small header at
+ * its start. So the slab of any block is found by masking the address of the
+ * block - deallocate() needs no size. Before it reads the header, it looks
+ * the slab up in a sorted index of the slabs of this allocator (a binary
+ * search), so a foreign pointer is rejected without touching its memory.
+ *
+ * The slabs of a class are kept in a list with the full ones at its end, so
+ * allocate() takes a block from the head or maps a new slab. A slab that
+ * becomes empty is returned to the OS unless it is the only one of its class
+ * with free blocks (which avoids a map/unmap for every alloc/free at the
+ * boundary of a slab).
+ *
+ * Larger blocks (or stricter alignments) get a mapping of their own with
+ * the same header - so they are found just like the small ones.
+ * \note This is not thread-safe.
+ */
+class CSlabAlloc
+{
+public:
+    static constexpr size_t kMinBlockSize = 16;
+    static constexpr size_t kMaxBlockSize = 512;
+    static constexpr size_t kNrOfClasses = 6;
+    static constexpr size_t kLargeClass = kNrOfClasses;
+    static constexpr size_t kSlabLog2 = 21;                           // The blocks of a slab fill a huge page
+    static constexpr size_t kSlabAlignment = size_t(2) << kSlabLog2;  // Leaves room for the header and the bitmap
+
+    CSlabAlloc() = default;
+    CSlabAlloc(const CSlabAlloc&) = delete;
+    CSlabAlloc& operator=(const CSlabAlloc&) = delete;
+
+    /*!
+     * \brief Returns all slabs to the OS - regardless of the blocks that are still in use.
+     */
+    ~CSlabAlloc()
+    {
+        for (SlabList& slabs : _slabs)
+        {
+            while (nullptr != slabs.head)
+            {
+                _release(slabs, slabs.head);
+            }
+        }
+        while (nullptr != _largeBlocks.head)
+        {
+            _release(_largeBlocks, _largeBlocks.head);
+        }
+    }
+
+    /*!
+     * \brief The size class of a request.
+     * \return The index of the class [0..kNrOfClasses) or kLargeClass.
+     */
+    static size_t classOf(size_t inSize, size_t inAlignment = alignof(std::max_align_t))
+    {
+        // The class by the number of 16 byte units: 1 -> 16 bytes, 2 -> 32, 3..4 -> 64, ...
+        static const unsigned char kClassOfUnits[] = {
+            0, 0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4,
+            5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5 };
+        const size_t size = (inSize < inAlignment) ? inAlignment : inSize;
+        return (size > kMaxBlockSize) ? kLargeClass : kClassOfUnits[(size + kMinBlockSize - 1) / kMinBlockSize];
+    }
+
+    /*!
+     * \brief Allocates a block of at least \p inSize bytes at a multiple of \p inAlignment.
+     * \param inAlignment A power of 2.
+     * \return The block or nullptr if the OS is out of memory.
+     */
+    void* allocate(size_t inSize, size_t inAlignment = alignof(std::max_align_t))
+    {
+        const size_t sizeClass = classOf(inSize, inAlignment);
+        if (kLargeClass == sizeClass)
+        {
+            return _allocateLarge(inSize, inAlignment);
+        }
+
+        const SlabClass& slabClass = _slabClass(sizeClass);
+        SlabList& slabs = _slabs[sizeClass];
+        if ((nullptr == slabs.head) || slabClass.full(slabs.head))
+        {
+            void* const memory = CPages::map(slabClass.slabSize, kSlabAlignment, true);
+            if (nullptr == memory)
+            {
+                return nullptr;
+            }
+            if (not _slabIndex.insert(memory))
+            {
+                CPages::unmap(memory, slabClass.slabSize);
+                return nullptr;
+            }
+            SlabHeader* const slab = slabClass.construct(memory);
+            _initHeader(slab, sizeClass, slabClass.blockSize, slabClass.slabSize, 0);
+            _pushFront(slabs, slab);
+        }
+
+        SlabHeader* const slab = slabs.head;
+        void* const block = slabClass.alloc(slab);
+        if (slabClass.full(slab))
+        {
+            _unlink(slabs, slab);
+            _pushBack(slabs, slab);
+        }
+        return block;
+    }
+
+    /*!
+     * \brief Returns a block of allocate().
+     * \param inBlock A block of this allocator, nullptr or any other pointer.
+     * \return true upon success. false if the block is not in use or not owned by this allocator.
+     */
+    bool deallocate(void* inBlock)
+    {
+        if (nullptr == inBlock)
+        {
+            return true;
+        }
+        SlabHeader* const slab = _slabOf(inBlock);
+        if (not _slabIndex.contains(slab))
+        {
+            return false;
+        }
+        if (kLargeClass == slab->sizeClass)
+        {
+            const bool isBlock = (inBlock == reinterpret_cast<char*>(slab) + slab->blockOffset);
+            if (isBlock)
+            {
+                _release(_largeBlocks, slab);
+            }
+            return isBlock;
+        }
+
+        const SlabClass& slabClass = _slabClass(slab->sizeClass);
+        SlabList& slabs = _slabs[slab->sizeClass];
+        const bool wasFull = slabClass.full(slab);
+        if ((0 != (reinterpret_cast<uintptr_t>(inBlock) % slab->blockSize)) || not slabClass.free(slab, inBlock))
+        {
+            return false;
+        }
+        if (wasFull)
+        {
+            _unlink(slabs, slab);
+            _pushFront(slabs, slab);
+        }
+        if (slabClass.empty(slab))
+        {
+            const SlabHeader* const other = (slabs.head != slab) ? slabs.head : slab->next;
+            if ((nullptr != other) && not slabClass.full(other))
+            {
+                _release(slabs, slab);
+            }
+        }
+        return true;
+    }
+
+    /*!
+     * \return The usable size of a block of this allocator or 0 if \p inBlock
+     * is not within a slab of this allocator.
+     */
+    size_t sizeOf(const void* inBlock) const
+    {
+        const SlabHeader* const slab = _slabOf(inBlock);
+        return _slabIndex.contains(slab) ? slab->blockSize : 0;
+    }
+
+    /*!
+     * \return The number of slabs of the small blocks that are currently mapped.
+     */
+    size_t nrOfSlabs() const
+    {
+        size_t nrOfSlabs = 0;
+        for (const SlabList& slabs : _slabs)
+        {
+            nrOfSlabs += slabs.count;
+        }
+        return nrOfSlabs;
+    }
+
+    /*!
+     * \return The number of large blocks that are currently in use.
+     */
+    size_t nrOfLargeBlocks() const
+    {
+        return _largeBlocks.count;
+    }
+
+private:
+    struct SlabHeader
+    {
+        SlabHeader* prev;
+        SlabHeader* next;
+        size_t sizeClass;
+        size_t blockSize;
+        size_t blockOffset;  // Of the block of a large class
+        size_t mappedSize;
+    };
+
+    struct SlabList
+    {
+        SlabHeader* head = nullptr;
+        SlabHeader* tail = nullptr;
+        size_t count = 0;
+    };
+
+    /*
+     * The addresses of the mapped slabs in ascending order. They are kept in
+     * pages of their own - so there is neither an operator new nor an
+     * exception - which grow by doubling.
+     */
+    class SlabIndex
+    {
+    public:
+        SlabIndex() = default;
+        SlabIndex(const SlabIndex&) = delete;
+        SlabIndex& operator=(const SlabIndex&) = delete;
+
+        ~SlabIndex()
+        {
+            if (nullptr != _slabs)
+            {
+                CPages::unmap(_slabs, _capacity * sizeof(uintptr_t));
+            }
+        }
+
+        bool contains(const void* inSlab) const
+        {
+            const uintptr_t slab = reinterpret_cast<uintptr_t>(inSlab);
+            const size_t idx = _lowerBound(slab);
+            return (idx < _count) && (slab == _slabs[idx]);
+        }
+
+        /*
+         * Returns false if the index cannot grow (the OS is out of memory).
+         */
+        bool insert(const void* inSlab)
+        {
+            if ((_count == _capacity) && not _grow())
+            {
+                return false;
+            }
+            const uintptr_t slab = reinterpret_cast<uintptr_t>(inSlab);
+            const size_t idx = _lowerBound(slab);
+            std::memmove(_slabs + idx + 1, _slabs + idx, (_count - idx) * sizeof(uintptr_t));
+            _slabs[idx] = slab;
+            ++_count;
+            return true;
+        }
+
+        void erase(const void* inSlab)
+        {
+            const size_t idx = _lowerBound(reinterpret_cast<uintptr_t>(inSlab));
+            std::memmove(_slabs + idx, _slabs + idx + 1, (_count - idx - 1) * sizeof(uintptr_t));
+            --_count;
+        }
+
+    private:
+        size_t _lowerBound(uintptr_t inSlab) const
+        {
+            size_t first = 0;
+            size_t count = _count;
+            while (0 != count)
+            {
+                const size_t half = count / 2;
+                if (_slabs[first + half] < inSlab)
+                {
+                    first += half + 1;
+                    count -= half + 1;
+                }
+                else
+                {
+                    count = half;
+                }
+            }
+            return first;
+        }
+
+        bool _grow()
+        {
+            const size_t capacity = (0 == _capacity) ? CPages::pageSize() / sizeof(uintptr_t) : 2 * _capacity;
+            uintptr_t* const slabs = static_cast<uintptr_t*>(CPages::map(capacity * sizeof(uintptr_t), CPages::pageSize()));
+            if (nullptr == slabs)
+            {
+                return false;
+            }
+            if (nullptr != _slabs)
+            {
+                std::memcpy(slabs, _slabs, _count * sizeof(uintptr_t));
+                CPages::unmap(_slabs, _capacity * sizeof(uintptr_t));
+            }
+            _slabs = slabs;
+            _capacity = capacity;
+            return true;
+        }
+
+        uintptr_t* _slabs = nullptr;
+        size_t _count = 0;
+        size_t _capacity = 0;
+    };
+
+    template <size_t BLOCK_SIZE>
+    struct Slab
+    {
+        using Block = typename std::aligned_storage<BLOCK_SIZE, BLOCK_SIZE>::type;
+
+        SlabHeader header;
+        CPoorMansBlockAlloc<Block, kSlabLog2 - log2Of(BLOCK_SIZE), LastFreedFirst> pool;
+
+        static Slab* of(SlabHeader* inHeader) {
+            return reinterpret_cast<Slab*>(inHeader); }
+
+        // Default initialized - so the blocks are left untouched until they are handed out.
+        static SlabHeader* construct(void* ioMemory) {
+            return &(new (ioMemory) Slab)->header; }
+
+        static void* alloc(SlabHeader* ioHeader) {
+            return of(ioHeader)->pool.alloc(); }
+
+        static bool free(SlabHeader* ioHeader, void* inBlock) {
+            return of(ioHeader)->pool.free(static_cast<Block*>(inBlock)); }
+
+        static bool empty(const SlabHeader* inHeader) {
+            return of(const_cast<SlabHeader*>(inHeader))->pool.empty(); }
+
+        static bool full(const SlabHeader* inHeader) {
+            return of(const_cast<SlabHeader*>(inHeader))->pool.full(); }
+    };
+
+    /*
+     * The operations on the slabs of a size class.
+     */
+    struct SlabClass
+    {
+        size_t blockSize;
+        size_t slabSize;
+        SlabHeader* (*construct)(void*);
+        void* (*alloc)(SlabHeader*);
+        bool (*free)(SlabHeader*, void*);
+        bool (*empty)(const SlabHeader*);
+        bool (*full)(const SlabHeader*);
+    };
+
+    template <size_t BLOCK_SIZE>
+    static SlabClass _slabClassOf()
+    {
+        using SlabType = Slab<BLOCK_SIZE>;
+        static_assert(sizeof(SlabType) <= kSlabAlignment, "A slab has to fit into its alignment");
+        return SlabClass{BLOCK_SIZE, sizeof(SlabType), &SlabType::construct, &SlabType::alloc,
+            &SlabType::free, &SlabType::empty, &SlabType::full};
+    }
+
+    static const SlabClass& _slabClass(size_t inSizeClass)
+    {
+        static const SlabClass kSlabClasses[kNrOfClasses] = {
+            _slabClassOf<16>(), _slabClassOf<32>(), _slabClassOf<64>(),
+            _slabClassOf<128>(), _slabClassOf<256>(), _slabClassOf<512>() };
+        return kSlabClasses[inSizeClass];
+    }
+
+    static SlabHeader* _slabOf(const void* inBlock)
+    {
+        return reinterpret_cast<SlabHeader*>(reinterpret_cast<uintptr_t>(inBlock) & ~(kSlabAlignment - 1));
+    }
+
+    static void _initHeader(SlabHeader* ioSlab, size_t inSizeClass, size_t inBlockSize, size_t inMappedSize, size_t inBlockOffset)
+    {
+        ioSlab->prev = nullptr;
+        ioSlab->next = nullptr;
+        ioSlab->sizeClass = inSizeClass;
+        ioSlab->blockSize = inBlockSize;
+        ioSlab->blockOffset = inBlockOffset;
+        ioSlab->mappedSize = inMappedSize;
+    }
+
+    void* _allocateLarge(size_t inSize, size_t inAlignment)
+    {
+        // The block has to start within the first kSlabAlignment bytes to find its header.
+        if (inAlignment >= kSlabAlignment)
+        {
+            return nullptr;
+        }
+        const size_t blockOffset = CPages::roundUp(sizeof(SlabHeader), inAlignment);
+        void* const memory = CPages::map(blockOffset + inSize, kSlabAlignment);
+        if (nullptr == memory)
+        {
+            return nullptr;
+        }
+        if (not _slabIndex.insert(memory))
+        {
+            CPages::unmap(memory, blockOffset + inSize);
+            return nullptr;
+        }
+        SlabHeader* const slab = static_cast<SlabHeader*>(memory);
+        _initHeader(slab, kLargeClass, inSize, blockOffset + inSize, blockOffset);
+        _pushFront(_largeBlocks, slab);
+        return static_cast<char*>(memory) + blockOffset;
+    }
+
+    void _release(SlabList& ioSlabs, SlabHeader* ioSlab)
+    {
+        _unlink(ioSlabs, ioSlab);
+        _slabIndex.erase(ioSlab);
+        CPages::unmap(ioSlab, ioSlab->mappedSize);
+    }
+
+    static void _pushFront(SlabList& ioSlabs, SlabHeader* ioSlab)
+    {
+        ioSlab->prev = nullptr;
+        ioSlab->next = ioSlabs.head;
+        (nullptr != ioSlabs.head ? ioSlabs.head->prev : ioSlabs.tail) = ioSlab;
+        ioSlabs.head = ioSlab;
+        ++ioSlabs.count;
+    }
+
+    static void _pushBack(SlabList& ioSlabs, SlabHeader* ioSlab)
+    {
+        ioSlab->prev = ioSlabs.tail;
+        ioSlab->next = nullptr;
+        (nullptr != ioSlabs.tail ? ioSlabs.tail->next : ioSlabs.head) = ioSlab;
+        ioSlabs.tail = ioSlab;
+        ++ioSlabs.count;
+    }
+
+    static void _unlink(SlabList& ioSlabs, SlabHeader* ioSlab)
+    {
+        (nullptr != ioSlab->prev ? ioSlab->prev->next : ioSlabs.head) = ioSlab->next;
+        (nullptr != ioSlab->next ? ioSlab->next->prev : ioSlabs.tail) = ioSlab->prev;
+        --ioSlabs.count;
+    }
+
+    SlabList _slabs[kNrOfClasses];
+    SlabList _largeBlocks;
+    SlabIndex _slabIndex;
+}; // class CSlabAlloc
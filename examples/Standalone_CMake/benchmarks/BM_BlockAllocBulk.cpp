@@ -0,0 +1,141 @@
+/* ==========================================================================
+ * @(#)File: BM_BlockAllocBulk.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "CPoorMansBlockAlloc.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// The cost per object of batches (allocBulk()/freeBulk()) versus single
+// calls (alloc()/free()) of CPoorMansBlockAlloc. A pool of 2^16 packets is
+// kept half full (every other slot in use), then batches of 32 up to 256
+// packets are allocated and freed again.
+
+namespace {
+
+struct Packet
+{
+    uint8_t payload[64];
+};
+
+constexpr size_t kPoolLog2N = 16;
+constexpr size_t kNrOfObjects = 1 << 24;  // Per measurement
+constexpr size_t kMaxBatchSize = 256;
+
+template <typename POLICY>
+class CBench
+{
+public:
+    using Allocator = CPoorMansBlockAlloc<Packet, kPoolLog2N, POLICY>;
+
+    CBench()
+        : _allocator(new Allocator)
+    {
+        std::vector<Packet*> packets;
+        while (not _allocator->full())
+        {
+            packets.push_back(_allocator->alloc());
+        }
+        for (size_t i = 0; i < packets.size(); i += 2)
+        {
+            _allocator->free(packets[i]);
+        }
+    }
+
+    double single(size_t inBatchSize)
+    {
+        return _measure(inBatchSize, [this](size_t inCount) {
+            for (size_t i = 0; i < inCount; ++i)
+            {
+                _batch[i] = _allocator->alloc();
+            }
+            _sink += reinterpret_cast<uintptr_t>(_batch[inCount - 1]);
+            for (size_t i = 0; i < inCount; ++i)
+            {
+                _allocator->free(_batch[i]);
+            }
+        });
+    }
+
+    double bulk(size_t inBatchSize)
+    {
+        return _measure(inBatchSize, [this](size_t inCount) {
+            _allocator->allocBulk(_batch, inCount);
+            _sink += reinterpret_cast<uintptr_t>(_batch[inCount - 1]);
+            _allocator->freeBulk(_batch, inCount);
+        });
+    }
+
+    uintptr_t sink() const {
+        return _sink; }
+
+private:
+    template <typename ROUND>
+    double _measure(size_t inBatchSize, ROUND inRound)
+    {
+        const size_t nrOfRounds = kNrOfObjects / inBatchSize;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < nrOfRounds; ++round)
+        {
+            inRound(inBatchSize);
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count() / (nrOfRounds * inBatchSize);
+    }
+
+    std::unique_ptr<Allocator> _allocator;
+    Packet* _batch[kMaxBatchSize];
+    uintptr_t _sink = 0;
+};
+
+template <typename POLICY>
+uintptr_t _run(const char* inPolicy)
+{
+    CBench<POLICY> bench;
+    for (size_t batchSize = 32; batchSize <= kMaxBatchSize; batchSize *= 2)
+    {
+        const double single = bench.single(batchSize);
+        const double bulk = bench.bulk(batchSize);
+        std::printf("%-18s %6zu %12.2f %12.2f %8.2fx\n", inPolicy, batchSize, single, bulk, single / bulk);
+    }
+    return bench.sink();
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("%-18s %6s %12s %12s %9s\n", "Policy", "Batch", "single ns", "bulk ns", "speedup");
+    uintptr_t sink = _run<LowestIndexFirst>("LowestIndexFirst");
+    sink += _run<LastFreedFirst>("LastFreedFirst");
+    return (0 == sink) ? 1 : 0;
+}
@@ -0,0 +1,271 @@
+/* ==========================================================================
+ * @(#)File: BM_BlockAllocReuse.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "CPoorMansBlockAlloc.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <random>
+#include <algorithm>
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+// The cache behaviour of the reuse policies of CPoorMansBlockAlloc.
+// A pool of 2^18 cache lines (16 MB) is half occupied in a random pattern,
+// then objects are replaced:
+//  - Churn:  Free a random live object and allocate a new one in its place.
+//  - Bursts: Allocate 64 short living objects, touch them and free them again.
+// LowestIndexFirst hands out the lowest hole (somewhere in the pool),
+// LastFreedFirst the slot that has just been freed - which is still in the cache.
+// The cache misses are counted by the hardware counters (Linux perf events)
+// where these are accessible, the time is taken in any case.
+
+namespace {
+
+struct Node
+{
+    uint64_t payload[8];
+};
+
+constexpr size_t kPoolLog2N = 18;
+constexpr size_t kNrOfSlots = size_t(1) << kPoolLog2N;
+constexpr size_t kNrOfOperations = 4000000;
+constexpr size_t kBurstSize = 64;
+
+class CCacheMissCounter
+{
+public:
+    CCacheMissCounter()
+    {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CCacheMissCounter()
+    {
+#if defined(__linux__)
+        if (available())
+        {
+            close(_fd);
+        }
+#endif
+    }
+
+    bool available() const {
+        return _fd >= 0; }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (available())
+        {
+            ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t stop()
+    {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (available())
+        {
+            ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (static_cast<ssize_t>(sizeof(count)) != read(_fd, &count, sizeof(count)))
+            {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int _fd = -1;
+};
+
+struct Result
+{
+    double nsPerOperation;
+    double missesPerOperation;
+};
+
+void _touch(Node* ioNode, uint64_t inValue)
+{
+    for (uint64_t& word : ioNode->payload)
+    {
+        word = inValue;
+    }
+}
+
+/*
+ * Fills the pool and frees every other slot in a random order - so the
+ * holes as well as the live objects are scattered across the whole pool.
+ */
+template <typename ALLOCATOR>
+std::vector<Node*> _fragment(ALLOCATOR& ioAllocator, std::mt19937_64& ioRandom)
+{
+    std::vector<Node*> nodes;
+    while (not ioAllocator.full())
+    {
+        nodes.push_back(ioAllocator.alloc());
+        _touch(nodes.back(), nodes.size());
+    }
+    std::shuffle(nodes.begin(), nodes.end(), ioRandom);
+    for (size_t i = nodes.size() / 2; i < nodes.size(); ++i)
+    {
+        ioAllocator.free(nodes[i]);
+    }
+    nodes.resize(nodes.size() / 2);
+    return nodes;
+}
+
+template <typename POLICY>
+Result _churn()
+{
+    using Allocator = CPoorMansBlockAlloc<Node, kPoolLog2N, POLICY>;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+    std::mt19937_64 random(42);
+    std::vector<Node*> live = _fragment(*allocator, random);
+    std::vector<uint32_t> victims(kNrOfOperations);
+    for (uint32_t& victim : victims)
+    {
+        victim = static_cast<uint32_t>(random() % live.size());
+    }
+
+    CCacheMissCounter misses;
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    misses.start();
+    for (size_t i = 0; i < kNrOfOperations; ++i)
+    {
+        Node*& node = live[victims[i]];
+        checksum += node->payload[0];
+        allocator->free(node);
+        node = allocator->alloc();
+        _touch(node, i);
+    }
+    const uint64_t nrOfMisses = misses.stop();
+    const auto stop = std::chrono::steady_clock::now();
+
+    if (0 == checksum)
+    {
+        std::printf("(unlikely checksum)\n");
+    }
+    return Result{std::chrono::duration<double, std::nano>(stop - start).count() / kNrOfOperations,
+        misses.available() ? double(nrOfMisses) / kNrOfOperations : -1.0};
+}
+
+template <typename POLICY>
+Result _bursts()
+{
+    using Allocator = CPoorMansBlockAlloc<Node, kPoolLog2N, POLICY>;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+    std::mt19937_64 random(42);
+    const std::vector<Node*> live = _fragment(*allocator, random);
+
+    CCacheMissCounter misses;
+    Node* burst[kBurstSize];
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    misses.start();
+    for (size_t i = 0; i < kNrOfOperations / kBurstSize; ++i)
+    {
+        for (Node*& node : burst)
+        {
+            node = allocator->alloc();
+            _touch(node, i);
+        }
+        for (size_t n = kBurstSize; n-- > 0;)
+        {
+            checksum += burst[n]->payload[7];
+            allocator->free(burst[n]);
+        }
+        // Something else reads a random live object in between
+        Node* const node = live[random() % live.size()];
+        checksum += node->payload[0];
+    }
+    const uint64_t nrOfMisses = misses.stop();
+    const auto stop = std::chrono::steady_clock::now();
+
+    if (0 == checksum)
+    {
+        std::printf("(unlikely checksum)\n");
+    }
+    const size_t nrOfOperations = (kNrOfOperations / kBurstSize) * kBurstSize;
+    return Result{std::chrono::duration<double, std::nano>(stop - start).count() / nrOfOperations,
+        misses.available() ? double(nrOfMisses) / nrOfOperations : -1.0};
+}
+
+void _print(const char* inScenario, const char* inPolicy, const Result& inResult)
+{
+    if (inResult.missesPerOperation < 0.0)
+    {
+        std::printf("%-8s %-18s %10.2f %14s\n", inScenario, inPolicy, inResult.nsPerOperation, "n/a");
+    }
+    else
+    {
+        std::printf("%-8s %-18s %10.2f %14.3f\n", inScenario, inPolicy, inResult.nsPerOperation, inResult.missesPerOperation);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("Pool of %zu slots of %zu bytes, half occupied\n\n", kNrOfSlots, sizeof(Node));
+    std::printf("%-8s %-18s %10s %14s\n", "Scenario", "Policy", "ns/op", "misses/op");
+    _print("Churn", "LowestIndexFirst", _churn<LowestIndexFirst>());
+    _print("Churn", "LastFreedFirst", _churn<LastFreedFirst>());
+    _print("Bursts", "LowestIndexFirst", _bursts<LowestIndexFirst>());
+    _print("Bursts", "LastFreedFirst", _bursts<LastFreedFirst>());
+    if (not CCacheMissCounter().available())
+    {
+        std::printf("\nThe cache miss counter is not accessible (see /proc/sys/kernel/perf_event_paranoid).\n");
+    }
+    return 0;
+}
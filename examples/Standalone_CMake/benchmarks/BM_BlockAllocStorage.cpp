@@ -0,0 +1,100 @@
+/* ==========================================================================
+ * @(#)File: BM_BlockAllocStorage.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "CPoorMansBlockAlloc.hpp"
+#include "CPoorMansBlockAlloc.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <random>
+
+// The storage policies of CPoorMansBlockAlloc on a large pool: 2^23 objects
+// of 16 bytes (128 MB) are allocated, then touched in a random order - which
+// costs a TLB miss on nearly every access with 4 KB pages. InlineStorage
+// puts the buffer onto the heap along with the pool, MappedStorage maps it
+// from huge pages (or advises transparent huge pages).
+
+namespace {
+
+struct Object
+{
+    uint64_t key;
+    uint64_t value;
+};
+
+constexpr size_t kPoolLog2N = 23;
+constexpr size_t kNrOfAccesses = 20000000;
+
+template <typename STORAGE>
+void _run(const char* inStorage)
+{
+    using Allocator = CPoorMansBlockAlloc<Object, kPoolLog2N, LowestIndexFirst, STORAGE>;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+    std::vector<Object*> objects(size_t(1) << kPoolLog2N);
+
+    const auto startOfFill = std::chrono::steady_clock::now();
+    allocator->allocBulk(objects.data(), objects.size());
+    for (Object* object : objects)
+    {
+        object->key = reinterpret_cast<uintptr_t>(object);
+        object->value = 0;
+    }
+    const auto stopOfFill = std::chrono::steady_clock::now();
+
+    std::mt19937_64 random(42);
+    std::vector<uint32_t> order(kNrOfAccesses);
+    for (uint32_t& idx : order)
+    {
+        idx = static_cast<uint32_t>(random() % objects.size());
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t idx : order)
+    {
+        objects[idx]->value += objects[idx]->key;
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    std::printf("%-14s %12.2f %12.2f\n", inStorage,
+        std::chrono::duration<double, std::milli>(stopOfFill - startOfFill).count(),
+        std::chrono::duration<double, std::nano>(stop - start).count() / kNrOfAccesses);
+    allocator->freeBulk(objects.data(), objects.size());
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("%-14s %12s %12s\n", "Storage", "fill ms", "access ns");
+    _run<InlineStorage>("InlineStorage");
+    _run<MappedStorage>("MappedStorage");
+    return 0;
+}
@@ -0,0 +1,179 @@
+/* ==========================================================================
+ * @(#)File: BM_NodeContainers.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "CPoorMansBlockAlloc.hpp"
+#include "CBlockPoolAllocator.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <map>
+#include <unordered_map>
+
+// The throughput of the node containers with and without the block pools:
+// 100000 elements are inserted in a random order and erased in another
+// random order - 10 rounds per container and allocator.
+//  - std::allocator:       The global heap.
+//  - CBlockPoolAllocator:  A pool per node type.
+//  - CBlockPoolResource:   std::pmr containers on pools of 16..128 bytes.
+//  - unsynchronized_pool:  std::pmr::unsynchronized_pool_resource for reference.
+
+namespace {
+
+constexpr size_t kNrOfElements = 100000;
+constexpr size_t kNrOfRounds = 10;
+constexpr size_t kPoolLog2N = 17;
+
+using PoolResource = CBlockPoolResource<kPoolLog2N, 16, 32, 64, 128>;
+
+template <typename T>
+using PoolAllocator = CBlockPoolAllocator<T, kPoolLog2N>;
+
+struct Keys
+{
+    std::vector<int> inserts;
+    std::vector<int> erases;
+};
+
+const Keys& _keys()
+{
+    static Keys keys;
+    if (keys.inserts.empty())
+    {
+        std::mt19937 random(42);
+        for (size_t i = 0; i < kNrOfElements; ++i)
+        {
+            keys.inserts.push_back(static_cast<int>(i));
+        }
+        keys.erases = keys.inserts;
+        std::shuffle(keys.inserts.begin(), keys.inserts.end(), random);
+        std::shuffle(keys.erases.begin(), keys.erases.end(), random);
+    }
+    return keys;
+}
+
+template <typename MAP>
+void _fillAndDrainMap(MAP& ioMap)
+{
+    for (int key : _keys().inserts)
+    {
+        ioMap.emplace(key, key);
+    }
+    for (int key : _keys().erases)
+    {
+        ioMap.erase(key);
+    }
+}
+
+template <typename LIST>
+void _fillAndDrainList(LIST& ioList)
+{
+    // Insert at the front and at the back, then erase from the middle outwards.
+    for (int key : _keys().inserts)
+    {
+        if (0 == (key % 2))
+        {
+            ioList.push_front(key);
+        }
+        else
+        {
+            ioList.push_back(key);
+        }
+    }
+    while (not ioList.empty())
+    {
+        ioList.pop_back();
+        if (not ioList.empty())
+        {
+            ioList.pop_front();
+        }
+    }
+}
+
+/*
+ * Runs the rounds of \p inRound on a fresh container made by \p inMake.
+ * \return The nanoseconds per inserted (and erased) element.
+ */
+template <typename MAKE, typename ROUND>
+double _measure(MAKE inMake, ROUND inRound)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < kNrOfRounds; ++round)
+    {
+        auto container = inMake();
+        inRound(container);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (kNrOfRounds * kNrOfElements);
+}
+
+void _print(const char* inContainer, const char* inAllocator, double inNsPerElement)
+{
+    std::printf("%-14s %-20s %10.2f\n", inContainer, inAllocator, inNsPerElement);
+}
+
+} // namespace
+
+int main()
+{
+    // Large pools do not fit onto the stack
+    std::unique_ptr<PoolResource> resource(new PoolResource);
+    std::pmr::unsynchronized_pool_resource unsynchronized;
+
+    const auto fillAndDrainList = [](auto& ioList) { _fillAndDrainList(ioList); };
+    const auto fillAndDrainMap = [](auto& ioMap) { _fillAndDrainMap(ioMap); };
+
+    std::printf("%-14s %-20s %10s\n", "Container", "Allocator", "ns/element");
+    _print("list", "std::allocator", _measure([] { return std::list<int>(); }, fillAndDrainList));
+    _print("list", "CBlockPoolAllocator", _measure([] { return std::list<int, PoolAllocator<int>>(); }, fillAndDrainList));
+    _print("list", "CBlockPoolResource", _measure([&] { return std::pmr::list<int>(resource.get()); }, fillAndDrainList));
+    _print("list", "unsynchronized_pool", _measure([&] { return std::pmr::list<int>(&unsynchronized); }, fillAndDrainList));
+
+    using MapValue = std::pair<const int, int>;
+    _print("map", "std::allocator", _measure([] { return std::map<int, int>(); }, fillAndDrainMap));
+    _print("map", "CBlockPoolAllocator", _measure([] {
+        return std::map<int, int, std::less<int>, PoolAllocator<MapValue>>(); }, fillAndDrainMap));
+    _print("map", "CBlockPoolResource", _measure([&] { return std::pmr::map<int, int>(resource.get()); }, fillAndDrainMap));
+    _print("map", "unsynchronized_pool", _measure([&] { return std::pmr::map<int, int>(&unsynchronized); }, fillAndDrainMap));
+
+    _print("unordered_map", "std::allocator", _measure([] { return std::unordered_map<int, int>(); }, fillAndDrainMap));
+    _print("unordered_map", "CBlockPoolAllocator", _measure([] {
+        return std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, PoolAllocator<MapValue>>(); }, fillAndDrainMap));
+    _print("unordered_map", "CBlockPoolResource", _measure([&] {
+        return std::pmr::unordered_map<int, int>(resource.get()); }, fillAndDrainMap));
+    _print("unordered_map", "unsynchronized_pool", _measure([&] {
+        return std::pmr::unordered_map<int, int>(&unsynchronized); }, fillAndDrainMap));
+    return 0;
+}
@@ -0,0 +1,95 @@
+/* ==========================================================================
+ * @(#)File: PT_CPoorMansBlockAlloc.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+/*
+ * The performance tests of CPoorMansBlockAlloc: These assert wall clock
+ * budgets - so their results depend on the load of the machine. Hence they
+ * are not part of the default ctest run, but labeled "performance":
+ *   ctest -C Performance -L performance
+ */
+#include "TSUnit.hpp"
+#include "CPoorMansBlockAlloc.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+TSUNIT_TEST(Performancetests, checkIfAMillionAllocAndFreeCallsStayWithinBudget)
+{
+    using ThisType = uint8_t[8];
+    CPoorMansBlockAlloc<ThisType, 3> allocator;
+
+    UT_EXPECT_DURATION_BELOW_N(std::chrono::milliseconds(500), 3, {
+        for (unsigned int i = 0; i < 1000000; ++i)
+        {
+            allocator.free(allocator.alloc());
+        }
+    });
+    UT_EXPECT_TRUE(allocator.empty());
+}
+
+TSUNIT_TEST(Performancetests, checkIfP99OfAnAllocIsBelowBudget)
+{
+    using ThisType = uint8_t[8];
+    CPoorMansBlockAlloc<ThisType, 3> allocator;
+
+    UT_EXPECT_PERCENTILE_BELOW(99, std::chrono::microseconds(50), 10000, {
+        allocator.free(allocator.alloc());
+    });
+}
+
+TSUNIT_TEST(Performancetests, checkIfAllocationsOfALargePoolStayWithinBudget)
+{
+    using Allocator = CPoorMansBlockAlloc<uint32_t, 20>;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+
+    // Every other slot is occupied - a linear search would take ages.
+    std::vector<uint32_t*> pointers;
+    for (size_t i = 0; i < (size_t(1) << 20); ++i)
+    {
+        uint32_t* const pointer = allocator->alloc();
+        if (0 == (i % 2))
+        {
+            pointers.push_back(pointer);
+        }
+    }
+    for (uint32_t* pointer : pointers)
+    {
+        allocator->free(pointer);
+    }
+
+    UT_EXPECT_DURATION_BELOW_N(std::chrono::milliseconds(500), 3, {
+        for (unsigned int i = 0; i < 1000000; ++i)
+        {
+            allocator->free(allocator->alloc());
+        }
+    });
+    UT_EXPECT_EQ(size_t(1) << 19, allocator->used());
+}
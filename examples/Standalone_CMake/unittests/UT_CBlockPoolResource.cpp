@@ -0,0 +1,120 @@
+/* ==========================================================================
+ * @(#)File: UT_CBlockPoolResource.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+/*
+ * The tests of the C++17 parts of CBlockPoolAllocator.hpp: the memory
+ * resource and the over-aligned elements. This module is built as C++17 -
+ * unlike the other tests.
+ */
+#include "TSUnit.hpp"
+#include "CBlockPoolAllocator.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#if not defined(BLOCK_ALLOC_WITH_PMR)
+    #error "The tests of CBlockPoolResource need C++17 and <memory_resource>"
+#endif
+
+TSUNIT_TEST(StlAdapters, checkIfTheMemoryResourceRoutesBySizeAndAlignment)
+{
+    using Resource = CBlockPoolResource<4, 16, 64>;
+    static_assert(0 == Resource::poolOf(8, 8), "");
+    static_assert(1 == Resource::poolOf(17, 8), "");
+    static_assert(Resource::kNoPool == Resource::poolOf(65, 8), "");
+    static_assert(Resource::kNoPool == Resource::poolOf(16, 64), "");
+
+    Resource resource;
+    void* const small = resource.allocate(8, 8);
+    void* const large = resource.allocate(100, 8);
+    void* const aligned = resource.allocate(64, 64);
+    UT_EXPECT_EQ(size_t(1), resource.used<0>());
+    UT_EXPECT_EQ(size_t(0), resource.used<1>());
+
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < 17; ++i)
+    {
+        blocks.push_back(resource.allocate(48, 16));
+    }
+    UT_EXPECT_EQ(size_t(16), resource.used<1>());
+
+    for (void* block : blocks)
+    {
+        resource.deallocate(block, 48, 16);
+    }
+    resource.deallocate(aligned, 64, 64);
+    resource.deallocate(large, 100, 8);
+    resource.deallocate(small, 8, 8);
+    UT_EXPECT_EQ(size_t(0), resource.used<0>());
+    UT_EXPECT_EQ(size_t(0), resource.used<1>());
+
+    std::unique_ptr<CBlockPoolResource<8, 32, 64, 128>> mapResource(new CBlockPoolResource<8, 32, 64, 128>);
+    {
+        std::pmr::map<int, int> map(mapResource.get());
+        for (int i = 0; i < 1000; ++i)
+        {
+            map[i] = i;
+        }
+        UT_EXPECT_EQ(size_t(1000), map.size());
+    }
+    UT_EXPECT_EQ(size_t(0), mapResource->used<0>() + mapResource->used<1>() + mapResource->used<2>());
+}
+
+namespace {
+struct alignas(256) Page
+{
+    uint8_t bytes[256];
+};
+} // namespace
+
+TSUNIT_TEST(StlAdapters, checkIfOverAlignedArraysAreAligned)
+{
+    static_assert(alignof(Page) > __STDCPP_DEFAULT_NEW_ALIGNMENT__, "");
+    using Allocator = CBlockPoolAllocator<Page, 2>;
+    Allocator allocator;
+
+    // Arrays bypass the pool - they come from the aligned operator new.
+    std::vector<Page*> arrays;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        arrays.push_back(allocator.allocate(3));
+        UT_EXPECT_EQ(uintptr_t(0), reinterpret_cast<uintptr_t>(arrays.back()) % alignof(Page));
+    }
+    Page* const single = allocator.allocate(1);
+    UT_EXPECT_EQ(uintptr_t(0), reinterpret_cast<uintptr_t>(single) % alignof(Page));
+
+    allocator.deallocate(single, 1);
+    for (Page* array : arrays)
+    {
+        allocator.deallocate(array, 3);
+    }
+    UT_EXPECT_TRUE(Allocator::pool().empty());
+}
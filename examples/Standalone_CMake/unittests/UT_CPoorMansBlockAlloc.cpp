@@ -30,7 +30,27 @@
  * ========================================================================== */
 #include "TSUnit.hpp"
 #include "CPoorMansBlockAlloc.hpp"
+#include "CConcurrentBlockAlloc.hpp"
+#include "CMagazineBlockAlloc.hpp"
+#include "CBlockPoolAllocator.hpp"
+#include "CSlabAlloc.hpp"
 #include <unordered_set>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <limits>
+#include <new>
+#if defined(TSUNIT_WITH_THREADS)
+    #include <thread>
+#endif
 
 static const uint8_t kTestData[] = {
     0x67, 0xc6, 0x69, 0x73, 0x51, 0xff, 0x4a, 0xec,
@@ -472,3 +492,968 @@ TSUNIT_TEST(Basictests, checkIfFreeingAnEntryMoreThanOnceBailsAnFailure)
     UT_EXPECT_FALSE(allocator.free(returnPtr[2]));
 
 }
+
+/*
+ * Allocates all slots of a pool (in ascending order), frees every third
+ * one and expects that these are handed out again - lowest first.
+ */
+template <size_t NR_OF_ELEMENTS_LOG2N>
+static void _checkFullCycle()
+{
+    using Allocator = CPoorMansBlockAlloc<uint32_t, NR_OF_ELEMENTS_LOG2N>;
+    constexpr size_t kNrOfElements = size_t(1) << NR_OF_ELEMENTS_LOG2N;
+    // Large pools would not fit onto the stack
+    std::unique_ptr<Allocator> allocator(new Allocator);
+    std::vector<uint32_t*> pointers(kNrOfElements);
+
+    // Count the misses per property - one failed assertion per slot would flood the log.
+    size_t nrOfNullptrs = 0;
+    size_t nrOfGaps = 0;
+    for (size_t i = 0; i < kNrOfElements; ++i)
+    {
+        pointers[i] = allocator->alloc();
+        nrOfNullptrs += (nullptr == pointers[i]) ? 1 : 0;
+        nrOfGaps += ((0 != i) and (pointers[i] != pointers[i - 1] + 1)) ? 1 : 0;
+    }
+    UT_EXPECT_EQ(size_t(0), nrOfNullptrs);
+    UT_EXPECT_EQ(size_t(0), nrOfGaps);
+    UT_EXPECT_TRUE(allocator->full());
+    UT_EXPECT_TRUE(nullptr == allocator->alloc());
+    UT_EXPECT_EQ(kNrOfElements, allocator->used());
+
+    size_t nrOfRejectedFrees = 0;
+    size_t nrOfDoubleFrees = 0;
+    for (size_t i = 0; i < kNrOfElements; i += 3)
+    {
+        nrOfRejectedFrees += allocator->free(pointers[i]) ? 0 : 1;
+        nrOfDoubleFrees += allocator->free(pointers[i]) ? 1 : 0;
+    }
+    UT_EXPECT_EQ(size_t(0), nrOfRejectedFrees);
+    UT_EXPECT_EQ(size_t(0), nrOfDoubleFrees);
+    UT_EXPECT_EQ((kNrOfElements + 2) / 3, allocator->available());
+
+    size_t nrOfOtherSlots = 0;
+    for (size_t i = 0; i < kNrOfElements; i += 3)
+    {
+        nrOfOtherSlots += (pointers[i] == allocator->alloc()) ? 0 : 1;
+    }
+    UT_EXPECT_EQ(size_t(0), nrOfOtherSlots);
+    UT_EXPECT_TRUE(allocator->full());
+
+    nrOfRejectedFrees = 0;
+    for (uint32_t* pointer : pointers)
+    {
+        nrOfRejectedFrees += allocator->free(pointer) ? 0 : 1;
+    }
+    UT_EXPECT_EQ(size_t(0), nrOfRejectedFrees);
+    UT_EXPECT_TRUE(allocator->empty());
+    UT_EXPECT_EQ(kNrOfElements, allocator->available());
+}
+
+TSUNIT_TEST(LargePools, checkIfPoolsAcrossTheBitmapLevelsWork)
+{
+    _checkFullCycle<0>();
+    _checkFullCycle<4>();   // Beyond the former limit of 8 slots
+    _checkFullCycle<6>();   // A single word
+    _checkFullCycle<7>();   // Two levels
+    _checkFullCycle<12>();  // Two full levels
+    _checkFullCycle<13>();  // Three levels
+}
+
+TSUNIT_TEST(LargePools, checkIfAMillionSlotsCanBeAllocated)
+{
+    _checkFullCycle<20>();
+}
+
+TSUNIT_TEST(LargePools, checkIfForeignPointersAreRejected)
+{
+    using Allocator = CPoorMansBlockAlloc<uint64_t, 16>;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+    std::unique_ptr<Allocator> otherAllocator(new Allocator);
+
+    uint64_t* const pointer = allocator->alloc();
+    uint64_t notPooled = 0;
+    UT_EXPECT_FALSE(allocator->free(&notPooled));
+    UT_EXPECT_FALSE(allocator->free(pointer + 1));
+    UT_EXPECT_FALSE(otherAllocator->free(pointer));
+    UT_EXPECT_TRUE(allocator->free(pointer));
+    UT_EXPECT_TRUE(allocator->empty());
+}
+
+TSUNIT_TEST(ReusePolicies, checkIfTheLastFreedSlotIsReusedFirst)
+{
+    CPoorMansBlockAlloc<uint32_t, 4, LastFreedFirst> allocator;
+    uint32_t* pointers[16];
+    for (size_t i = 0; i < 16; ++i)
+    {
+        pointers[i] = allocator.alloc();
+        *pointers[i] = static_cast<uint32_t>(i);
+    }
+    UT_EXPECT_TRUE(allocator.full());
+    UT_EXPECT_TRUE(nullptr == allocator.alloc());
+
+    UT_EXPECT_TRUE(allocator.free(pointers[3]));
+    UT_EXPECT_TRUE(allocator.free(pointers[11]));
+    UT_EXPECT_TRUE(allocator.free(pointers[7]));
+    UT_EXPECT_FALSE(allocator.free(pointers[11]));  // Double free
+    UT_EXPECT_FALSE(allocator.free(pointers[0] + 16)); // Not part of the pool
+    UT_EXPECT_EQ(size_t(3), allocator.available());
+
+    UT_EXPECT_TRUE(pointers[7] == allocator.alloc());
+    UT_EXPECT_TRUE(pointers[11] == allocator.alloc());
+    UT_EXPECT_TRUE(pointers[3] == allocator.alloc());
+    UT_EXPECT_TRUE(allocator.full());
+
+    // The links of the free list must not have touched the live slots
+    bool untouched = true;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        untouched = untouched and ((3 == i) || (7 == i) || (11 == i) || (i == *pointers[i]));
+    }
+    UT_EXPECT_TRUE(untouched);
+
+    allocator.clear();
+    UT_EXPECT_TRUE(allocator.empty());
+    UT_EXPECT_TRUE(pointers[0] == allocator.alloc());
+}
+
+TSUNIT_TEST(ReusePolicies, checkIfALargeLifoPoolHandsOutEverySlotOnce)
+{
+    using Allocator = CPoorMansBlockAlloc<uint32_t, 16, LastFreedFirst>;
+    constexpr size_t kNrOfElements = size_t(1) << 16;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+
+    // Churn a little before filling the pool, so the list and the untouched slots mix
+    std::vector<uint32_t*> pointers;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        pointers.push_back(allocator->alloc());
+    }
+    for (size_t i = 0; i < pointers.size(); i += 2)
+    {
+        allocator->free(pointers[i]);
+    }
+    pointers.clear();
+    while (not allocator->full())
+    {
+        pointers.push_back(allocator->alloc());
+    }
+    UT_EXPECT_TRUE(nullptr == allocator->alloc());
+
+    std::unordered_set<uint32_t*> distinct(pointers.begin(), pointers.end());
+    UT_EXPECT_EQ(kNrOfElements - 500, distinct.size());
+
+    for (uint32_t* pointer : distinct)
+    {
+        allocator->free(pointer);
+    }
+    UT_EXPECT_EQ(size_t(500), allocator->used());
+}
+
+/*
+ * Allocates and frees in batches across the words of the bitmap.
+ */
+template <typename REUSE_POLICY>
+static void _checkBulkOperations()
+{
+    using Allocator = CPoorMansBlockAlloc<uint64_t, 8, REUSE_POLICY>;
+    Allocator allocator;
+    uint64_t* slots[256];
+
+    // Leave a hole every 3 slots, so a batch spans fragmented words.
+    UT_EXPECT_TRUE(allocator.allocBulk(slots, 100));
+    size_t nrOfRejectedFrees = 0;
+    for (size_t i = 0; i < 100; i += 3)
+    {
+        nrOfRejectedFrees += allocator.free(slots[i]) ? 0 : 1;
+    }
+    UT_EXPECT_EQ(size_t(0), nrOfRejectedFrees);
+    UT_EXPECT_EQ(size_t(66), allocator.used());
+
+    uint64_t* batch[256];
+    UT_EXPECT_FALSE(allocator.allocBulk(batch, 191));
+    UT_EXPECT_EQ(size_t(66), allocator.used());
+    UT_EXPECT_TRUE(allocator.allocBulk(batch, 190));
+    UT_EXPECT_TRUE(allocator.full());
+    std::unordered_set<uint64_t*> distinct(batch, batch + 190);
+    for (size_t i = 0; i < 100; ++i)
+    {
+        distinct.insert(slots[i]);
+    }
+    UT_EXPECT_EQ(size_t(256), distinct.size());
+
+    // A double entry fails the whole batch
+    uint64_t* const skipped = batch[10];
+    batch[10] = batch[20];
+    UT_EXPECT_FALSE(allocator.freeBulk(batch, 190));
+    UT_EXPECT_TRUE(allocator.full());
+    batch[10] = nullptr;
+    UT_EXPECT_EQ(size_t(190), allocator.freeSome(batch, 190));
+    UT_EXPECT_EQ(size_t(67), allocator.used());
+    UT_EXPECT_FALSE(allocator.free(batch[20]));
+
+    UT_EXPECT_EQ(size_t(189), allocator.allocSome(batch, 256));
+    UT_EXPECT_TRUE(allocator.full());
+    UT_EXPECT_EQ(size_t(0), allocator.allocSome(batch, 1));
+    UT_EXPECT_EQ(size_t(189), allocator.freeSome(batch, 189));
+
+    // Just the slots that are still in use (not the holes) are freed
+    uint64_t notPooled = 0;
+    slots[0] = &notPooled;
+    UT_EXPECT_TRUE(allocator.free(skipped));
+    UT_EXPECT_EQ(size_t(66), allocator.freeSome(slots, 100));
+    UT_EXPECT_TRUE(allocator.empty());
+}
+
+TSUNIT_TEST(BulkOperations, checkTheBatchesOfTheLowestIndexPolicy)
+{
+    _checkBulkOperations<LowestIndexFirst>();
+}
+
+TSUNIT_TEST(BulkOperations, checkTheBatchesOfTheLifoPolicy)
+{
+    _checkBulkOperations<LastFreedFirst>();
+}
+
+/*
+ * A batch that fails (by its last entry) must neither free a slot nor touch
+ * the contents of one - the free list of LastFreedFirst links the free slots.
+ */
+template <typename REUSE_POLICY>
+static void _checkARejectedBatch()
+{
+    CPoorMansBlockAlloc<uint64_t, 4, REUSE_POLICY> allocator;
+    uint64_t* slots[16];
+    UT_EXPECT_TRUE(allocator.allocBulk(slots, 8));
+    for (size_t i = 0; i < 8; ++i)
+    {
+        *slots[i] = 0x1122334455667788ull + i;
+    }
+    UT_EXPECT_TRUE(allocator.free(slots[7]));
+
+    uint64_t notPooled = 0;
+    uint64_t* const withADoubleEntry[] = {slots[0], slots[1], nullptr, slots[2], slots[0]};
+    uint64_t* const withAFreeSlot[] = {slots[3], slots[4], slots[7]};
+    uint64_t* const withAForeignSlot[] = {slots[5], slots[6], &notPooled};
+    UT_EXPECT_FALSE(allocator.freeBulk(withADoubleEntry, 5));
+    UT_EXPECT_FALSE(allocator.freeBulk(withAFreeSlot, 3));
+    UT_EXPECT_FALSE(allocator.freeBulk(withAForeignSlot, 3));
+    UT_EXPECT_EQ(size_t(7), allocator.used());
+
+    size_t nrOfChangedSlots = 0;
+    for (size_t i = 0; i < 7; ++i)
+    {
+        nrOfChangedSlots += (0x1122334455667788ull + i == *slots[i]) ? 0 : 1;
+    }
+    UT_EXPECT_EQ(size_t(0), nrOfChangedSlots);
+
+    // The free list is intact: The only free slot comes first - then the untouched ones.
+    UT_EXPECT_EQ(slots[7], allocator.alloc());
+    UT_EXPECT_TRUE(allocator.freeBulk(slots, 8));
+    UT_EXPECT_TRUE(allocator.empty());
+    UT_EXPECT_TRUE(allocator.allocBulk(slots, 16));
+    UT_EXPECT_EQ(size_t(16), std::unordered_set<uint64_t*>(slots, slots + 16).size());
+}
+
+TSUNIT_TEST(BulkOperations, checkIfARejectedBatchLeavesTheSlotsUntouched)
+{
+    _checkARejectedBatch<LowestIndexFirst>();
+    _checkARejectedBatch<LastFreedFirst>();
+}
+
+TSUNIT_TEST(BulkOperations, checkIfABatchTakesTheLowestSlots)
+{
+    CPoorMansBlockAlloc<uint32_t, 7> allocator;
+    uint32_t* slots[128];
+    UT_EXPECT_TRUE(allocator.allocBulk(slots, 128));
+    UT_EXPECT_TRUE(allocator.freeBulk(slots + 60, 10));
+
+    uint32_t* batch[10];
+    UT_EXPECT_TRUE(allocator.allocBulk(batch, 10));
+    UT_EXPECT_TRUE(std::equal(batch, batch + 10, slots + 60));
+}
+
+TSUNIT_TEST(MappedStorage, checkIfAMappedPoolWorks)
+{
+    using Allocator = CPoorMansBlockAlloc<uint64_t, 20, LowestIndexFirst, MappedStorage>;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+    UT_EXPECT_EQ(size_t(1) << 20, allocator->available());
+
+    std::vector<uint64_t*> slots;
+    while (not allocator->full())
+    {
+        slots.push_back(allocator->alloc());
+        *slots.back() = slots.size();
+    }
+    // Large buffers start at a huge page
+    UT_EXPECT_EQ(uintptr_t(0), reinterpret_cast<uintptr_t>(slots.front()) % CPages::kHugePageSize);
+    UT_EXPECT_EQ(uint64_t(1) << 20, *slots.back());
+    UT_EXPECT_TRUE(allocator->freeBulk(slots.data(), slots.size()));
+}
+
+#if defined(BLOCK_ALLOC_WITH_MMAP)
+TSUNIT_TEST(MappedStorage, checkIfTrimDecommitsThePagesOfTheFreeSlots)
+{
+    using Allocator = CPoorMansBlockAlloc<uint64_t, 20, LowestIndexFirst, MappedStorage>;
+    constexpr size_t kBufferSize = (size_t(1) << 20) * sizeof(uint64_t);
+    std::unique_ptr<Allocator> allocator(new Allocator);
+
+    std::vector<uint64_t*> slots(size_t(1) << 20);
+    UT_EXPECT_TRUE(allocator->allocBulk(slots.data(), slots.size()));
+    for (uint64_t* slot : slots)
+    {
+        *slot = 42;
+    }
+    UT_EXPECT_EQ(size_t(0), allocator->trim());
+
+    // Keep a single slot of the first page
+    UT_EXPECT_TRUE(allocator->freeBulk(slots.data() + 1, slots.size() - 1));
+    const size_t decommitted = allocator->trim();
+    UT_EXPECT_TRUE((decommitted > 0) and (decommitted < kBufferSize));
+    UT_EXPECT_EQ(uint64_t(42), *slots[0]);
+
+    // The decommitted pages come back as fresh zero pages
+    uint64_t* const last = slots.back();
+    UT_EXPECT_TRUE(allocator->free(slots[0]));
+    UT_EXPECT_EQ(kBufferSize, allocator->trim());
+    UT_EXPECT_TRUE(allocator->allocBulk(slots.data(), slots.size()));
+    UT_EXPECT_EQ(uint64_t(0), *last);
+}
+#endif // defined(BLOCK_ALLOC_WITH_MMAP)
+
+TSUNIT_TEST(Instrumentation, checkIfNoInstrumentationCostsNoSpace)
+{
+    using Allocator = CPoorMansBlockAlloc<uint64_t, 8>;
+    UT_EXPECT_EQ(sizeof(InlineStorage::Buffer<uint64_t, 256>) + sizeof(LowestIndexFirst::Slots<uint64_t, 256>)
+        + sizeof(size_t), sizeof(Allocator));
+}
+
+TSUNIT_TEST(Instrumentation, checkTheCountersAndTheHighWaterMark)
+{
+    using Allocator = CPoorMansBlockAlloc<uint64_t, 4, LowestIndexFirst, InlineStorage, Instrumented<>>;
+    Allocator allocator;
+    uint64_t foreign = 0;
+
+    std::vector<uint64_t*> slots;
+    while (not allocator.full())
+    {
+        slots.push_back(allocator.alloc());
+    }
+    UT_EXPECT_EQ(static_cast<uint64_t*>(nullptr), allocator.alloc());
+    UT_EXPECT_TRUE(allocator.free(slots[3]));
+    UT_EXPECT_FALSE(allocator.free(slots[3]));
+    UT_EXPECT_FALSE(allocator.free(&foreign));
+    UT_EXPECT_FALSE(allocator.destroy(slots[3]));
+    UT_EXPECT_TRUE(allocator.free(nullptr));
+
+    CBlockAllocStatistics stats = allocator.statistics();
+    UT_EXPECT_EQ(size_t(15), stats.used);
+    UT_EXPECT_EQ(size_t(16), stats.capacity);
+    UT_EXPECT_EQ(size_t(16), stats.peakUsed);
+    UT_EXPECT_EQ(uint64_t(16), stats.allocs);
+    UT_EXPECT_EQ(uint64_t(1), stats.failedAllocs);
+    UT_EXPECT_EQ(uint64_t(1), stats.frees);
+    UT_EXPECT_EQ(uint64_t(2), stats.doubleFrees);
+    UT_EXPECT_EQ(uint64_t(1), stats.invalidFrees);
+
+    // The bulk operations count each slot - and each failed batch once
+    uint64_t* batch[4] = {slots[0], slots[1], slots[0], &foreign};
+    UT_EXPECT_FALSE(allocator.allocBulk(batch, 2));
+    UT_EXPECT_EQ(size_t(2), allocator.freeSome(batch, 4));
+    stats = allocator.statistics();
+    UT_EXPECT_EQ(uint64_t(2), stats.failedAllocs);
+    UT_EXPECT_EQ(uint64_t(3), stats.frees);
+    UT_EXPECT_EQ(uint64_t(3), stats.doubleFrees);
+    UT_EXPECT_EQ(uint64_t(2), stats.invalidFrees);
+
+    // The high-water mark starts over at the current usage
+    allocator.resetStatistics();
+    stats = allocator.statistics();
+    UT_EXPECT_EQ(size_t(13), stats.peakUsed);
+    UT_EXPECT_EQ(uint64_t(0), stats.allocs + stats.failedAllocs + stats.frees + stats.doubleFrees + stats.invalidFrees);
+}
+
+namespace {
+/*
+ * Collects the lines of CBlockAllocStatistics::logTo().
+ */
+struct CCollectingLogger
+{
+    std::string text;
+
+    void log(const char* inFormat, ...)
+    {
+        char line[256];
+        va_list args;
+        va_start(args, inFormat);
+        vsnprintf(line, sizeof(line), inFormat, args);
+        va_end(args);
+        text += line;
+    }
+};
+} // namespace
+
+TSUNIT_TEST(Instrumentation, checkTheSamplesAgainstASizingBudget)
+{
+    using Allocator = CPoorMansBlockAlloc<uint64_t, 10, LastFreedFirst, InlineStorage, Instrumented<2>>;
+    constexpr size_t kBudget = 600;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+
+    // A workload that holds up to 500 slots
+    std::vector<uint64_t*> slots;
+    for (size_t round = 0; round < 4; ++round)
+    {
+        while (allocator->used() < 500)
+        {
+            slots.push_back(allocator->alloc());
+        }
+        while (allocator->used() > 100)
+        {
+            allocator->free(slots.back());
+            slots.pop_back();
+        }
+    }
+    const CBlockAllocStatistics stats = allocator->statistics();
+    UT_EXPECT_TRUE(stats.peakUsed <= kBudget);
+    UT_EXPECT_EQ(size_t(500), stats.peakUsed);
+    UT_EXPECT_EQ(uint64_t(0), stats.failedAllocs);
+
+    // Every 4th call is timed
+    UT_EXPECT_EQ((stats.allocs + 3) / 4, stats.allocSamples);
+    UT_EXPECT_EQ((stats.frees + 3) / 4, stats.freeSamples);
+    UT_EXPECT_TRUE(stats.allocNanosMax >= stats.meanAllocNanos());
+    uint64_t occupancySamples = 0;
+    uint64_t samplesAboveHalf = 0;
+    for (size_t bin = 0; bin < CBlockAllocStatistics::kNrOfOccupancyBins; ++bin)
+    {
+        occupancySamples += stats.occupancy[bin];
+        samplesAboveHalf += (bin >= CBlockAllocStatistics::kNrOfOccupancyBins / 2) ? stats.occupancy[bin] : 0;
+    }
+    UT_EXPECT_EQ(stats.allocSamples, occupancySamples);
+    // 1024 slots: Never more than half of them are in use
+    UT_EXPECT_EQ(uint64_t(0), samplesAboveHalf);
+
+    CCollectingLogger logger;
+    stats.logTo(logger, "Pool");
+    UT_EXPECT_TRUE(std::string::npos != logger.text.find("Pool: 100 of 1024 slots used, peak 500"));
+    if (nullptr != tsunit::pLogger)
+    {
+        stats.logTo(*tsunit::pLogger, "Instrumentation::checkTheSamplesAgainstASizingBudget");
+    }
+}
+
+namespace {
+/*
+ * Counts its living instances - and has no default constructor.
+ */
+class CCounted
+{
+public:
+    static int living;
+
+    CCounted(int inValue, const char* inName)
+        : value(inValue)
+        , name(inName)
+    {
+        ++living;
+    }
+
+    ~CCounted()
+    {
+        --living;
+    }
+
+    int value;
+    const char* name;
+};
+
+int CCounted::living = 0;
+} // namespace
+
+TSUNIT_TEST(ObjectLifecycle, checkIfAPoolConstructsNothingUpFront)
+{
+    using Allocator = CPoorMansBlockAlloc<CCounted, 16>;
+    std::unique_ptr<Allocator> allocator(new Allocator);
+    UT_EXPECT_EQ(0, CCounted::living);
+    UT_EXPECT_TRUE(allocator->empty());
+}
+
+TSUNIT_TEST(ObjectLifecycle, checkIfEmplaceAndDestroyRunTheConstructorAndTheDestructor)
+{
+    CPoorMansBlockAlloc<CCounted, 2, LastFreedFirst> allocator;
+    CCounted* const first = allocator.emplace(1, "first");
+    CCounted* const second = allocator.emplace(2, "second");
+    UT_EXPECT_EQ(2, CCounted::living);
+    UT_EXPECT_EQ(1, first->value);
+    UT_EXPECT_EQ(std::string("second"), std::string(second->name));
+
+    CCounted notPooled(3, "notPooled");
+    UT_EXPECT_FALSE(allocator.destroy(&notPooled));
+    UT_EXPECT_TRUE(allocator.destroy(first));
+    UT_EXPECT_FALSE(allocator.destroy(first));  // Neither destructed nor freed twice
+    UT_EXPECT_TRUE(allocator.destroy(nullptr));
+    UT_EXPECT_EQ(2, CCounted::living);
+    UT_EXPECT_EQ(size_t(1), allocator.used());
+
+    CCounted* const others[] = {allocator.emplace(4, "third"), allocator.emplace(5, "fourth"), allocator.emplace(6, "fifth")};
+    UT_EXPECT_TRUE(nullptr == allocator.emplace(7, "sixth"));
+    UT_EXPECT_EQ(5, CCounted::living);
+
+    bool destroyed = allocator.destroy(second);
+    for (CCounted* other : others)
+    {
+        destroyed = destroyed and allocator.destroy(other);
+    }
+    UT_EXPECT_TRUE(destroyed);
+    UT_EXPECT_EQ(1, CCounted::living);  // notPooled
+}
+
+TSUNIT_TEST(ObjectLifecycle, checkIfAHandleDestroysItsObject)
+{
+    using Allocator = CPoorMansBlockAlloc<CCounted, 1>;
+    Allocator allocator;
+    {
+        Allocator::Handle handle = allocator.make(1, "first");
+        UT_EXPECT_TRUE(static_cast<bool>(handle));
+        UT_EXPECT_EQ(1, handle->value);
+        UT_EXPECT_EQ(1, CCounted::living);
+
+        Allocator::Handle moved(std::move(handle));
+        UT_EXPECT_FALSE(static_cast<bool>(handle));
+        UT_EXPECT_EQ(1, (*moved).value);
+
+        Allocator::Handle other = allocator.make(2, "second");
+        Allocator::Handle none = allocator.make(3, "third");
+        UT_EXPECT_FALSE(static_cast<bool>(none));
+        UT_EXPECT_TRUE(allocator.full());
+
+        moved = std::move(other);  // Destroys the first one
+        UT_EXPECT_EQ(1, CCounted::living);
+        UT_EXPECT_EQ(2, moved->value);
+    }
+    UT_EXPECT_EQ(0, CCounted::living);
+    UT_EXPECT_TRUE(allocator.empty());
+
+    Allocator::Handle released = allocator.make(4, "fourth");
+    CCounted* const object = released.release();
+    UT_EXPECT_FALSE(static_cast<bool>(released));
+    UT_EXPECT_TRUE(allocator.destroy(object));
+    UT_EXPECT_EQ(0, CCounted::living);
+}
+
+// All of them count the instances of CCounted - so they must not run at the same time (see --jobs).
+TSUNIT_EXCLUSIVE(ObjectLifecycle, checkIfAPoolConstructsNothingUpFront, livingCCounted);
+TSUNIT_EXCLUSIVE(ObjectLifecycle, checkIfEmplaceAndDestroyRunTheConstructorAndTheDestructor, livingCCounted);
+TSUNIT_EXCLUSIVE(ObjectLifecycle, checkIfAHandleDestroysItsObject, livingCCounted);
+
+TSUNIT_TEST(ConcurrentPools, checkTheSingleThreadedBehaviour)
+{
+    CConcurrentBlockAlloc<uint64_t, 7> pool;
+    CConcurrentBlockAlloc<uint64_t, 7>* const allocator = &pool;
+
+    std::unordered_set<uint64_t*> pointers;
+    for (unsigned int i = 0; i < 128; ++i)
+    {
+        pointers.insert(allocator->alloc());
+    }
+    UT_EXPECT_EQ(size_t(128), pointers.size());
+    UT_EXPECT_EQ(0u, pointers.count(nullptr));
+    UT_EXPECT_TRUE(allocator->full());
+    UT_EXPECT_EQ(nullptr, allocator->alloc());
+    UT_EXPECT_EQ(size_t(128), allocator->used());
+
+    uint64_t notPooled = 0;
+    UT_EXPECT_FALSE(allocator->free(&notPooled));
+    UT_EXPECT_TRUE(allocator->free(nullptr));
+    for (uint64_t* pointer : pointers)
+    {
+        UT_EXPECT_TRUE(allocator->free(pointer));
+    }
+    UT_EXPECT_FALSE(allocator->free(*pointers.begin()));
+    UT_EXPECT_TRUE(allocator->empty());
+    UT_EXPECT_EQ(size_t(128), allocator->available());
+}
+
+#if defined(TSUNIT_WITH_THREADS)
+/*
+ * The threads of _checkIfNoSlotIsHandedOutTwice() return their cached slots
+ * to the pool - just the magazines cache any.
+ */
+template <typename T, size_t NR_OF_ELEMENTS_LOG2N>
+static void _flushThisThread(CConcurrentBlockAlloc<T, NR_OF_ELEMENTS_LOG2N>&)
+{
+}
+
+template <typename T, size_t NR_OF_ELEMENTS_LOG2N, unsigned int MAGAZINE_SIZE>
+static void _flushThisThread(CMagazineBlockAlloc<T, NR_OF_ELEMENTS_LOG2N, MAGAZINE_SIZE>& ioAllocator)
+{
+    ioAllocator.flushThisThread();
+}
+
+/*
+ * Several threads allocate and free slots of a shared pool. Every slot is
+ * marked as owned while it is allocated - a slot that is handed out twice
+ * is detected by its mark and by its contents.
+ * \return The number of allocations that failed as the pool ran dry.
+ */
+template <typename ALLOCATOR>
+static unsigned long _checkIfNoSlotIsHandedOutTwice(ALLOCATOR& ioAllocator, unsigned int inSlotsPerRound)
+{
+    constexpr unsigned int kNrOfThreads = 8;
+    constexpr unsigned int kNrOfRounds = 2000;
+
+    // The slots need not be contiguous (e.g. tagged ones) - so they are numbered by their order.
+    std::vector<uint64_t*> allSlots;
+    while (uint64_t* const pointer = ioAllocator.alloc())
+    {
+        allSlots.push_back(pointer);
+    }
+    std::sort(allSlots.begin(), allSlots.end());
+    const auto slotIdx = [&allSlots](uint64_t* inSlot) {
+        return std::lower_bound(allSlots.begin(), allSlots.end(), inSlot) - allSlots.begin(); };
+    for (uint64_t* pointer : allSlots)
+    {
+        ioAllocator.free(pointer);
+    }
+    _flushThisThread(ioAllocator);
+
+    const size_t nrOfSlots = allSlots.size();
+    std::unique_ptr<std::atomic<unsigned int>[]> owner(new std::atomic<unsigned int>[nrOfSlots]);
+    for (size_t i = 0; i < nrOfSlots; ++i)
+    {
+        owner[i].store(0);
+    }
+
+    std::atomic<unsigned long> conflicts(0);
+    std::atomic<unsigned long> failedAllocs(0);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t <= kNrOfThreads; ++t)
+    {
+        threads.push_back(std::thread([&, t]() {
+            std::vector<uint64_t*> pointers;
+            for (unsigned int round = 0; round < kNrOfRounds; ++round)
+            {
+                for (unsigned int i = 0; i < inSlotsPerRound; ++i)
+                {
+                    uint64_t* const pointer = ioAllocator.alloc();
+                    if (nullptr == pointer)
+                    {
+                        ++failedAllocs;
+                        continue;
+                    }
+                    conflicts += (0 != owner[slotIdx(pointer)].exchange(t)) ? 1 : 0;
+                    *pointer = (uint64_t(t) << 32) | round;
+                    pointers.push_back(pointer);
+                }
+                for (uint64_t* pointer : pointers)
+                {
+                    conflicts += ((*pointer != ((uint64_t(t) << 32) | round))
+                               || (t != owner[slotIdx(pointer)].exchange(0))
+                               || not ioAllocator.free(pointer)) ? 1 : 0;
+                }
+                pointers.clear();
+            }
+            _flushThisThread(ioAllocator);
+        }));
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    UT_EXPECT_EQ(0ul, conflicts.load());
+    UT_EXPECT_TRUE(ioAllocator.empty());
+    return failedAllocs.load();
+}
+
+TSUNIT_TEST(ConcurrentPools, checkIfNoSlotIsHandedOutTwice)
+{
+    // Over-aligned (cache lines) - thus not allocated by new prior to C++17
+    CConcurrentBlockAlloc<uint64_t, 8> pool;
+
+    // 300 slots > 256 - so the pool runs full even if the threads do not overlap (e.g. under --jobs)
+    UT_EXPECT_TRUE(_checkIfNoSlotIsHandedOutTwice(pool, 300) > 0);
+}
+#endif // defined(TSUNIT_WITH_THREADS)
+
+TSUNIT_TEST(MagazinePools, checkTheSingleThreadedBehaviour)
+{
+    CMagazineBlockAlloc<uint64_t, 8, 8> allocator;
+
+    std::unordered_set<uint64_t*> pointers;
+    for (unsigned int i = 0; i < 256; ++i)
+    {
+        pointers.insert(allocator.alloc());
+    }
+    UT_EXPECT_EQ(size_t(256), pointers.size());
+    UT_EXPECT_EQ(0u, pointers.count(nullptr));
+    UT_EXPECT_TRUE(allocator.full());
+    UT_EXPECT_EQ(nullptr, allocator.alloc());
+
+    // Every 4th alloc (half a magazine) refills the magazine
+    MagazineStatistics statistics = allocator.statistics();
+    UT_EXPECT_EQ(uint64_t(257), statistics.allocs);
+    UT_EXPECT_EQ(uint64_t(64), statistics.refills);
+    UT_EXPECT_EQ(uint64_t(192), statistics.hits);
+
+    uint64_t notPooled = 0;
+    UT_EXPECT_FALSE(allocator.free(&notPooled));
+    UT_EXPECT_TRUE(allocator.free(nullptr));
+    for (uint64_t* pointer : pointers)
+    {
+        UT_EXPECT_TRUE(allocator.free(pointer));
+    }
+    UT_EXPECT_FALSE(allocator.free(*pointers.begin()));
+    UT_EXPECT_TRUE(allocator.empty());
+    UT_EXPECT_EQ(size_t(256), allocator.available());
+    UT_EXPECT_EQ(uint64_t(0), allocator.statistics().crossThreadFrees);
+    UT_EXPECT_TRUE(allocator.statistics().flushes > 0);
+
+    // The magazine serves an alloc after a free of the same thread
+    statistics = allocator.statistics();
+    for (unsigned int i = 0; i < 10000; ++i)
+    {
+        allocator.free(allocator.alloc());
+    }
+    UT_EXPECT_EQ(statistics.hits + 10000, allocator.statistics().hits);
+    UT_EXPECT_EQ(statistics.refills, allocator.statistics().refills);
+    UT_EXPECT_TRUE(allocator.statistics().hitRate() > 0.95);
+
+    allocator.flushThisThread();
+    UT_EXPECT_TRUE(allocator.empty());
+}
+
+#if defined(TSUNIT_WITH_THREADS)
+TSUNIT_TEST(MagazinePools, checkIfFreesOfOtherThreadsAreCounted)
+{
+    CMagazineBlockAlloc<uint64_t, 8, 8> allocator;
+
+    CMagazineThreadIndex::current(); // This thread must not take over the index of the producer
+
+    std::vector<uint64_t*> pointers;
+    std::thread producer([&]() {
+        for (unsigned int i = 0; i < 100; ++i)
+        {
+            pointers.push_back(allocator.alloc());
+        }
+    });
+    producer.join();
+    UT_EXPECT_EQ(size_t(100), allocator.used());
+
+    for (uint64_t* pointer : pointers)
+    {
+        UT_EXPECT_TRUE(allocator.free(pointer));
+    }
+    UT_EXPECT_EQ(uint64_t(100), allocator.statistics().crossThreadFrees);
+    UT_EXPECT_TRUE(allocator.empty());
+}
+
+TSUNIT_TEST(MagazinePools, checkIfTheMagazineOfAnExitingThreadIsFlushed)
+{
+    CMagazineBlockAlloc<uint64_t, 4, 8> allocator;
+    CMagazineThreadIndex::current(); // This thread must not take over the index of the worker
+
+    std::thread worker([&]() {
+        uint64_t* const pointer = allocator.alloc();
+        UT_EXPECT_TRUE(allocator.free(pointer));
+        UT_EXPECT_FALSE(allocator.free(pointer)); // Is in the magazine of this thread
+    });
+    worker.join();
+
+    // All 16 slots are back in the shared pool - none is stuck in the magazine of the worker.
+    std::vector<uint64_t*> pointers;
+    while (uint64_t* const pointer = allocator.alloc())
+    {
+        pointers.push_back(pointer);
+    }
+    UT_EXPECT_EQ(size_t(16), pointers.size());
+    for (uint64_t* pointer : pointers)
+    {
+        UT_EXPECT_TRUE(allocator.free(pointer));
+    }
+    allocator.flushThisThread();
+    UT_EXPECT_TRUE(allocator.empty());
+}
+
+TSUNIT_TEST(MagazinePools, checkIfNoSlotIsHandedOutTwice)
+{
+    CMagazineBlockAlloc<uint64_t, 10, 16> pool;
+
+    _checkIfNoSlotIsHandedOutTwice(pool, 100);
+    UT_EXPECT_TRUE(pool.statistics().hitRate() > 0.5);
+}
+#endif // defined(TSUNIT_WITH_THREADS)
+
+namespace {
+struct Order
+{
+    uint64_t id;
+    double price;
+    uint32_t quantity;
+};
+} // namespace
+
+TSUNIT_TEST(StlAdapters, checkIfSingleElementsComeFromThePool)
+{
+    using Allocator = CBlockPoolAllocator<Order, 4>;
+    Allocator allocator;
+    UT_EXPECT_TRUE(Allocator::pool().empty());
+
+    std::vector<Order*> orders;
+    for (size_t i = 0; i < 17; ++i)
+    {
+        orders.push_back(allocator.allocate(1));
+    }
+    // The 17th one did not fit into the pool anymore
+    UT_EXPECT_TRUE(Allocator::pool().full());
+    Order* const array = allocator.allocate(3);
+    UT_EXPECT_TRUE(Allocator::pool().full());
+
+    allocator.deallocate(array, 3);
+    for (Order* order : orders)
+    {
+        allocator.deallocate(order, 1);
+    }
+    UT_EXPECT_TRUE(Allocator::pool().empty());
+
+    // Rebound allocators are interchangeable
+    CBlockPoolAllocator<int, 4> rebound(allocator);
+    UT_EXPECT_TRUE(rebound == allocator);
+    UT_EXPECT_FALSE(rebound != allocator);
+}
+
+TSUNIT_TEST(StlAdapters, checkIfNodeContainersWork)
+{
+    std::list<int, CBlockPoolAllocator<int, 6>> list;
+    std::map<int, int, std::less<int>, CBlockPoolAllocator<std::pair<const int, int>, 6>> map;
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+        CBlockPoolAllocator<std::pair<const int, int>, 6>> unorderedMap;
+
+    // More elements than slots - the rest goes to the heap.
+    for (int i = 0; i < 200; ++i)
+    {
+        list.push_back(i);
+        map[i] = 2 * i;
+        unorderedMap[i] = 3 * i;
+    }
+    for (int i = 0; i < 200; i += 2)
+    {
+        map.erase(i);
+        unorderedMap.erase(i);
+    }
+    list.remove_if([](int inValue) { return 0 == (inValue % 2); });
+
+    bool valid = (100 == list.size()) and (100 == map.size()) and (100 == unorderedMap.size());
+    int expected = 1;
+    for (int value : list)
+    {
+        valid = valid and (expected == value) and (2 * value == map[value]) and (3 * value == unorderedMap[value]);
+        expected += 2;
+    }
+    UT_EXPECT_TRUE(valid);
+}
+
+TSUNIT_TEST(StlAdapters, checkIfAnOversizedRequestIsRejected)
+{
+    CBlockPoolAllocator<Order, 4> allocator;
+
+    bool rejected = false;
+    try
+    {
+        allocator.allocate(std::numeric_limits<size_t>::max() / sizeof(Order) + 1);
+    }
+    catch (const std::bad_array_new_length&)
+    {
+        rejected = true;
+    }
+    UT_EXPECT_TRUE(rejected);
+}
+
+TSUNIT_TEST(SlabAllocator, checkTheSizeClasses)
+{
+    UT_EXPECT_EQ(size_t(0), CSlabAlloc::classOf(1));
+    UT_EXPECT_EQ(size_t(0), CSlabAlloc::classOf(16));
+    UT_EXPECT_EQ(size_t(1), CSlabAlloc::classOf(17));
+    UT_EXPECT_EQ(size_t(2), CSlabAlloc::classOf(33));
+    UT_EXPECT_EQ(size_t(5), CSlabAlloc::classOf(512));
+    UT_EXPECT_EQ(CSlabAlloc::kLargeClass, CSlabAlloc::classOf(513));
+    UT_EXPECT_EQ(size_t(2), CSlabAlloc::classOf(8, 64));  // By the alignment
+    UT_EXPECT_EQ(CSlabAlloc::kLargeClass, CSlabAlloc::classOf(8, 4096));
+}
+
+TSUNIT_TEST(SlabAllocator, checkIfBlocksOfAllSizesAreAlignedAndDistinct)
+{
+    CSlabAlloc allocator;
+    std::vector<std::pair<uint8_t*, size_t>> blocks;
+    bool valid = true;
+    for (size_t size = 1; size <= 2048; size += 7)
+    {
+        const size_t alignment = size_t(1) << (size % 8);
+        uint8_t* const block = static_cast<uint8_t*>(allocator.allocate(size, alignment));
+        valid = valid and (nullptr != block) and (0 == reinterpret_cast<uintptr_t>(block) % alignment)
+            and (allocator.sizeOf(block) >= size);
+        std::memset(block, static_cast<int>(size), size);
+        blocks.push_back(std::make_pair(block, size));
+    }
+    UT_EXPECT_TRUE(valid);
+    UT_EXPECT_EQ(CSlabAlloc::kNrOfClasses, allocator.nrOfSlabs());
+    UT_EXPECT_TRUE(allocator.nrOfLargeBlocks() > 0);
+
+    bool untouched = true;
+    for (const std::pair<uint8_t*, size_t>& block : blocks)
+    {
+        for (size_t i = 0; i < block.second; ++i)
+        {
+            untouched = untouched and (static_cast<uint8_t>(block.second) == block.first[i]);
+        }
+        valid = valid and allocator.deallocate(block.first);
+    }
+    UT_EXPECT_TRUE(untouched);
+    UT_EXPECT_TRUE(valid);
+    UT_EXPECT_EQ(size_t(0), allocator.nrOfLargeBlocks());
+}
+
+TSUNIT_TEST(SlabAllocator, checkIfSlabsAreAddedAndReturnedOnDemand)
+{
+    CSlabAlloc allocator;
+    // A slab holds 4096 blocks of 512 bytes
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        blocks.push_back(allocator.allocate(500));
+    }
+    UT_EXPECT_EQ(size_t(3), allocator.nrOfSlabs());
+
+    for (void* block : blocks)
+    {
+        allocator.deallocate(block);
+    }
+    // Just the last slab is kept
+    UT_EXPECT_EQ(size_t(1), allocator.nrOfSlabs());
+}
+
+TSUNIT_TEST(SlabAllocator, checkIfInvalidBlocksAreRejected)
+{
+    CSlabAlloc allocator;
+    CSlabAlloc otherAllocator;
+    char* const small = static_cast<char*>(allocator.allocate(40));
+    char* const large = static_cast<char*>(allocator.allocate(100000));
+
+    UT_EXPECT_TRUE(allocator.deallocate(nullptr));
+    UT_EXPECT_FALSE(otherAllocator.deallocate(small));
+    UT_EXPECT_EQ(size_t(0), otherAllocator.sizeOf(small));
+
+    // The slab of a foreign pointer would be unmapped memory.
+    uint64_t onStack = 0;
+    std::unique_ptr<uint64_t> onHeap(new uint64_t(0));
+    UT_EXPECT_FALSE(allocator.deallocate(&onStack));
+    UT_EXPECT_FALSE(allocator.deallocate(onHeap.get()));
+    UT_EXPECT_EQ(size_t(0), allocator.sizeOf(&onStack));
+    UT_EXPECT_EQ(size_t(64), allocator.sizeOf(small));
+
+    UT_EXPECT_FALSE(allocator.deallocate(small + 1));
+    UT_EXPECT_FALSE(allocator.deallocate(large + 1));
+    UT_EXPECT_TRUE(allocator.deallocate(small));
+    UT_EXPECT_FALSE(allocator.deallocate(small));
+    UT_EXPECT_TRUE(allocator.deallocate(large));
+}
@@ -30,13 +30,17 @@
  * ========================================================================== */
 #pragma once
 #include <cstdlib>
+#include <cstdint>
 
 template <typename T, size_t NR_OF_ELEMENTS_LOG2N>
 class CPoorMansBlockAlloc
 {
+    // One bit per slot - a single byte would just cover pools of up to 8 slots.
+    static constexpr size_t kNrOfFlagWords = ((size_t(1) << NR_OF_ELEMENTS_LOG2N) + 63) / 64;
+
     T _buffer[1<<NR_OF_ELEMENTS_LOG2N];
-    uint8_t _usedFlags = 0b00000000;
-    uint8_t _usedCount = 0;
+    uint64_t _usedFlags[kNrOfFlagWords] = {};
+    size_t _usedCount = 0;
 
 public:
     CPoorMansBlockAlloc() = default;
@@ -122,10 +126,11 @@ public:
                 size_t offset = inBuffPtr - _buffer;
                 if (offset < _totalSize())
                 {
-                    const uint32_t mask(1<<offset);
-                    if (_usedFlags & mask) // Just release slots that are actually used
+                    const uint64_t mask(uint64_t(1) << (offset % 64));
+                    uint64_t& flags = _usedFlags[offset / 64];
+                    if (flags & mask) // Just release slots that are actually used
                     {
-                        _usedFlags &= ~mask;
+                        flags &= ~mask;
                         --_usedCount;
                         success = true;
                     }
@@ -155,24 +160,27 @@ public:
     void clear()
     {
         _usedCount = 0;
-        _usedFlags = 0b00000000;
+        for (uint64_t& flags : _usedFlags)
+        {
+            flags = 0;
+        }
     }
 
 private:
 
-    constexpr size_t _mask()      const { return (1<<NR_OF_ELEMENTS_LOG2N) -1;}
-    constexpr size_t _totalSize() const { return (1<<NR_OF_ELEMENTS_LOG2N);}
+    constexpr size_t _mask()      const { return (size_t(1)<<NR_OF_ELEMENTS_LOG2N) -1;}
+    constexpr size_t _totalSize() const { return (size_t(1)<<NR_OF_ELEMENTS_LOG2N);}
 
-    static constexpr uint8_t kIndexNotFound = 0xff;
     T* _allocateNextFreeIndex()
     {
         T* foundSlot = nullptr;
-        for (unsigned int idx = 0; idx < _totalSize(); ++idx)
+        for (size_t idx = 0; idx < _totalSize(); ++idx)
         {
-            const uint32_t mask(1 << idx);
-            if (not (_usedFlags & mask))
+            const uint64_t mask(uint64_t(1) << (idx % 64));
+            uint64_t& flags = _usedFlags[idx / 64];
+            if (not (flags & mask))
             {
-                _usedFlags |= mask;
+                flags |= mask;
                 foundSlot = &_buffer[idx];
                 ++_usedCount;
                 break;
@@ -290,6 +290,26 @@ TSUNIT_TEST(Basictests, checkIfAttemptingToFreeMorePointersThanAllocatedWillFail
     UT_EXPECT_FALSE(allocator.free(returnPtr[2]));
 }
 
+TSUNIT_TEST(Basictests, checkIfPoolsOfMoreThanEightSlotsCanBeUsedCompletely)
+{
+    using ThisType = uint8_t[8];
+    CPoorMansBlockAlloc<ThisType, 7> allocator;
+
+    std::unordered_set<ThisType*> allPointers;
+    while (not allocator.full())
+    {
+        allPointers.insert(allocator.alloc());
+    }
+    UT_EXPECT_EQ(128, allPointers.size());
+    UT_EXPECT_EQ(nullptr, allocator.alloc());
+
+    for (ThisType* pointer : allPointers)
+    {
+        UT_EXPECT_TRUE(allocator.free(pointer));
+    }
+    UT_EXPECT_TRUE(allocator.empty());
+}
+
 class TestFixture1 : public tsunit::Test
 {
     template <typename T>
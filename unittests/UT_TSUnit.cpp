@@ -39,6 +39,8 @@ TSUNIT_TEST(Standardtests, allMacros)
 }
 
 #include <string>
+#include <limits>
+#include <atomic>
 
 class FixtureTests : public tsunit::Test
 {
@@ -79,6 +81,14 @@ private:
 
 std::string FixtureTests::fixtureCallOrder;
 
+// The fixture tests record their calls in the same string, so they have to
+// run in this order - even if the tests are shuffled or run in parallel.
+TSUNIT_AFTER(FixtureTests, secondCall, FixtureTests, firstCall);
+TSUNIT_AFTER(FixtureTests, thirdCall, FixtureTests, secondCall);
+TSUNIT_AFTER(FixtureTests, fourthCall, FixtureTests, thirdCall);
+TSUNIT_AFTER(FixtureTests, fifthCall, FixtureTests, fourthCall);
+TSUNIT_AFTER(FixtureTests, checkcalls, FixtureTests, fifthCall);
+
 TSUNIT_TESTF(FixtureTests, firstCall)
 {
 }
@@ -103,4 +113,241 @@ TSUNIT_TESTF(FixtureTests, fifthCall)
 TSUNIT_TEST(FixtureTests, checkcalls)
 {
     UT_EXPECT_EQ("CSTDCSHolla!THolla!DCSTDCSTDCSTD", FixtureTests::fixtureCallOrder);
+
+    // Start over for the next repetition
+    FixtureTests::fixtureCallOrder.clear();
+}
+
+static std::atomic<unsigned int> exclusiveUsers(0);
+static std::atomic<unsigned int> maxExclusiveUsers(0);
+
+static void useExclusively()
+{
+    const unsigned int users = ++exclusiveUsers;
+    if (users > maxExclusiveUsers)
+    {
+        maxExclusiveUsers = users;
+    }
+    const tsunit::Clock::time_point until = tsunit::Clock::now() + std::chrono::milliseconds(5);
+    while (tsunit::Clock::now() < until) {}
+    --exclusiveUsers;
+}
+
+TSUNIT_EXCLUSIVE(ResourceTests, firstUser, exclusiveUsers);
+TSUNIT_EXCLUSIVE(ResourceTests, secondUser, exclusiveUsers);
+TSUNIT_EXCLUSIVE(ResourceTests, thirdUser, exclusiveUsers);
+TSUNIT_EXCLUSIVE(ResourceTests, checkExclusiveUse, exclusiveUsers);
+
+TSUNIT_TEST(ResourceTests, firstUser)
+{
+    useExclusively();
+}
+
+TSUNIT_TEST(ResourceTests, secondUser)
+{
+    useExclusively();
+}
+
+TSUNIT_TEST(ResourceTests, thirdUser)
+{
+    useExclusively();
+}
+
+TSUNIT_TEST(ResourceTests, checkExclusiveUse)
+{
+    UT_EXPECT_EQ(1, maxExclusiveUsers);
+}
+
+TSUNIT_AFTER(ResourceTests, checkExclusiveUse, ResourceTests, firstUser);
+TSUNIT_AFTER(ResourceTests, checkExclusiveUse, ResourceTests, secondUser);
+TSUNIT_AFTER(ResourceTests, checkExclusiveUse, ResourceTests, thirdUser);
+
+TSUNIT_TEST(LatencyBudget, checkPercentileByNearestRank)
+{
+    std::vector<double> samples;
+    for (unsigned int i = 100; i > 0; --i)
+    {
+        samples.push_back(i);
+    }
+
+    UT_EXPECT_EQ(1.0,   tsunit::percentile(samples, 0));
+    UT_EXPECT_EQ(50.0,  tsunit::percentile(samples, 50));
+    UT_EXPECT_EQ(99.0,  tsunit::percentile(samples, 99));
+    UT_EXPECT_EQ(100.0, tsunit::percentile(samples, 100));
+
+    std::vector<double> noSamples;
+    UT_EXPECT_EQ(0.0, tsunit::percentile(noSamples, 99));
+}
+
+TSUNIT_TEST(LatencyBudget, checkMeasuredDurationOfABusyWait)
+{
+    const double measuredNs = tsunit::measureDurationNs([]() {
+        const tsunit::Clock::time_point until = tsunit::Clock::now() + std::chrono::milliseconds(2);
+        while (tsunit::Clock::now() < until) {}
+    }, 3);
+
+    UT_EXPECT_TRUE(tsunit::clockOverheadNs() >= 0.0);
+    UT_EXPECT_TRUE(measuredNs >= 1.9e6);
+    UT_EXPECT_TRUE(measuredNs <  1.0e9);
+}
+
+TSUNIT_TEST(LatencyBudget, checkBudgetMacros)
+{
+    volatile unsigned int counter = 0;
+
+    UT_EXPECT_DURATION_BELOW(std::chrono::seconds(1), {
+        for (unsigned int i = 0; i < 1000; ++i) { ++counter; }
+    });
+
+    UT_EXPECT_DURATION_BELOW_N(std::chrono::seconds(1), 5, ++counter);
+
+    UT_EXPECT_PERCENTILE_BELOW(99, std::chrono::milliseconds(100), 1000, ++counter);
+}
+
+static std::atomic<unsigned long long> parameterSum(0);
+static std::atomic<unsigned int> parameterCnt(0);
+
+TSUNIT_TEST_P(ParameterizedTests, rangeOfNumbers, tsunit::range(0, 10000))
+{
+    UT_EXPECT_TRUE((param >= 0) && (param < 10000));
+    parameterSum += param;
+    ++parameterCnt;
+}
+
+TSUNIT_TEST_P(ParameterizedTests, rangeWithStep, tsunit::range(1.0, 2.0, 0.25))
+{
+    UT_EXPECT_TRUE((param >= 1.0) && (param < 2.0));
+    ++parameterCnt;
+}
+
+TSUNIT_TEST_P(ParameterizedTests, listOfStrings, tsunit::values<std::string>({"alpha", "beta", "gamma"}))
+{
+    UT_EXPECT_FALSE(param.empty());
+    ++parameterCnt;
+}
+
+/*
+ * A generator that is able to produce many numbers without storing them.
+ */
+class SquareNumbers
+{
+public:
+    using value_type = unsigned long long;
+
+    explicit SquareNumbers(unsigned int inCount) : _count(inCount) {}
+
+    bool hasNext() const { return _next < _count; }
+    value_type next() { const value_type n = _next++; return n * n; }
+
+private:
+    unsigned int _next = 0;
+    const unsigned int _count;
+};
+
+TSUNIT_TEST_P(ParameterizedTests, customGenerator, SquareNumbers(1000))
+{
+    const unsigned long long root = static_cast<unsigned long long>(std::sqrt(double(param)) + 0.5);
+    UT_EXPECT_EQ(root * root, param);
+    ++parameterCnt;
+}
+
+/*
+ * Collects all values of a generator.
+ */
+template <typename GENERATOR>
+static std::vector<typename GENERATOR::value_type> allValuesOf(GENERATOR inGenerator)
+{
+    std::vector<typename GENERATOR::value_type> values;
+    while (inGenerator.hasNext())
+    {
+        values.push_back(inGenerator.next());
+    }
+    return values;
+}
+
+TSUNIT_TEST(ParameterizedTests, rangeCountsDown)
+{
+    UT_EXPECT_TRUE(tsunit::range(10, 0, -3).valid());
+    UT_EXPECT_TRUE((std::vector<int>{10, 7, 4, 1}) == allValuesOf(tsunit::range(10, 0, -3)));
+    UT_EXPECT_TRUE((std::vector<double>{2.0, 1.5}) == allValuesOf(tsunit::range(2.0, 1.0, -0.5)));
+    UT_EXPECT_TRUE(allValuesOf(tsunit::range(5, 5, -1)).empty());
+}
+
+TSUNIT_TEST(ParameterizedTests, rangeReachesTheLimitsOfItsType)
+{
+    constexpr int kMin = std::numeric_limits<int>::min();
+    constexpr int kMax = std::numeric_limits<int>::max();
+    UT_EXPECT_TRUE((std::vector<int>{kMin, -1, kMax - 1}) == allValuesOf(tsunit::range(kMin, kMax, kMax)));
+    UT_EXPECT_TRUE((std::vector<int>{kMax, -1}) == allValuesOf(tsunit::range(kMax, kMin, kMin)));
+    UT_EXPECT_TRUE((std::vector<int>{kMax - 2, kMax - 1}) == allValuesOf(tsunit::range(kMax - 2, kMax, 1)));
+    UT_EXPECT_TRUE((std::vector<int>{kMin + 2, kMin + 1}) == allValuesOf(tsunit::range(kMin + 2, kMin, -1)));
+
+    auto wholeRange = tsunit::range(kMin, kMax, 1);
+    UT_EXPECT_EQ(kMin, wholeRange.next());
+    UT_EXPECT_EQ(kMin + 1, wholeRange.next());
+    UT_EXPECT_TRUE(wholeRange.hasNext());
+}
+
+TSUNIT_TEST(ParameterizedTests, rangeRejectsAStepOfZero)
+{
+    UT_EXPECT_FALSE(tsunit::range(0, 10, 0).valid());
+    UT_EXPECT_FALSE(tsunit::range(0, 10, 0).hasNext());
+    UT_EXPECT_FALSE(tsunit::range(1.0, 2.0, 0.0).valid());
+    UT_EXPECT_FALSE(tsunit::range(5u, 5u, 0u).valid());
+}
+
+TSUNIT_TEST(ParameterizedTests, rangeRejectsAStepAwayFromTheEnd)
+{
+    UT_EXPECT_FALSE(tsunit::range(0, 10, -1).valid());
+    UT_EXPECT_FALSE(tsunit::range(0, 10, -1).hasNext());
+    UT_EXPECT_FALSE(tsunit::range(10, 0, 1).valid());
+    UT_EXPECT_FALSE(tsunit::range(10, 0, 1).hasNext());
+    UT_EXPECT_FALSE(tsunit::range(2.0, 1.0, 0.25).valid());
+    UT_EXPECT_FALSE(tsunit::range(10u, 0u).valid());
+    UT_EXPECT_TRUE(tsunit::range(0u, 10u).valid());
+}
+
+TSUNIT_AFTER(ParameterizedTests, checkAllInstancesRun, ParameterizedTests, rangeOfNumbers);
+TSUNIT_AFTER(ParameterizedTests, checkAllInstancesRun, ParameterizedTests, rangeWithStep);
+TSUNIT_AFTER(ParameterizedTests, checkAllInstancesRun, ParameterizedTests, listOfStrings);
+TSUNIT_AFTER(ParameterizedTests, checkAllInstancesRun, ParameterizedTests, customGenerator);
+
+TSUNIT_TEST(ParameterizedTests, checkAllInstancesRun)
+{
+    UT_EXPECT_EQ(10000u + 4u + 3u + 1000u, parameterCnt);
+    UT_EXPECT_EQ(10000ull * 9999ull / 2, parameterSum);
+    UT_EXPECT_TRUE(tsunit::totalStatistics().runInstancesCnt() >= parameterCnt);
+    UT_EXPECT_EQ(0, tsunit::totalStatistics().failedInstancesCnt());
+
+    // Start over for the next repetition
+    parameterCnt = 0;
+    parameterSum = 0;
+}
+
+// The ID of a test is known at compile time
+static_assert(0x081e0e07b4d9f795ull == tsunit::testId("", ""), "FNV-1a of \"::\"");
+static_assert(tsunit::testId("TestIds", "lookup") == TSUNIT_TEST_ID(TestIds, lookup), "");
+static_assert(tsunit::testId("TestIds", "lookup") != tsunit::testId("TestId", "slookup"), "");
+
+TSUNIT_TEST(TestIds, lookup)
+{
+    const tsunit::TestCaseRegistrar& registrar = tsunit::TestCaseRegistrar::sharedInstance();
+
+    const tsunit::TestListEntry* const byId = registrar.find(TSUNIT_TEST_ID(TestIds, lookup));
+    UT_EXPECT_TRUE(nullptr != byId);
+    if (nullptr == byId)
+    {
+        return;
+    }
+    UT_EXPECT_EQ(std::string("TestIds"), byId->groupName);
+    UT_EXPECT_EQ(std::string("lookup"), byId->testCaseName);
+    UT_EXPECT_TRUE(byId == registrar.find("TestIds", "lookup"));
+
+    // Fixtures and parameterized tests get their IDs too
+    const tsunit::TestListEntry* const fixture = registrar.find("FixtureTests", "firstCall");
+    UT_EXPECT_TRUE((nullptr != fixture) and (tsunit::testId("FixtureTests", "firstCall") == fixture->id));
+    UT_EXPECT_TRUE(nullptr != registrar.find(tsunit::testId("ParameterizedTests", "rangeOfNumbers")));
+
+    UT_EXPECT_TRUE(nullptr == registrar.find("TestIds", "unknown"));
+    UT_EXPECT_TRUE(nullptr == registrar.find(tsunit::testId("TestId", "slookup")));
 }
@@ -0,0 +1,150 @@
+/* ==========================================================================
+ * @(#)File: UT_TSUnitProperties.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+#include "TSUnitProperties.hpp"
+#include "TSUnit.hpp"
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+TSUNIT_TEST(Properties, holdsForAllCases)
+{
+    UT_EXPECT_PROPERTY(tsunit::anyInt<int>(-1000, 1000), 100000, [](int x) {
+        return (x + 3) - 3 == x;
+    });
+
+    UT_EXPECT_PROPERTY_SEED(tsunit::anyFloat<double>(-1.0, 1.0), 10000, 4711, [](double x) {
+        return (x >= -1.0) and (x <= 1.0);
+    });
+
+    UT_EXPECT_PROPERTY(tsunit::anyBytes(100), 10000, [](const std::vector<std::uint8_t>& bytes) {
+        return bytes.size() <= 100;
+    });
+}
+
+TSUNIT_TEST(Properties, generatorsStayWithinTheirRange)
+{
+    UT_EXPECT_PROPERTY(tsunit::anyInt<std::int64_t>(-5, 5), 10000, [](std::int64_t x) {
+        return (x >= -5) and (x <= 5);
+    });
+
+    UT_EXPECT_PROPERTY(tsunit::anyInt<std::uint8_t>(200, 255), 10000, [](std::uint8_t x) {
+        return x >= 200;
+    });
+
+    // The full scale of an integer type
+    UT_EXPECT_PROPERTY(tsunit::anyInt<std::int64_t>(), 10000, [](std::int64_t) {
+        return true;
+    });
+}
+
+TSUNIT_TEST(Properties, intShrinksToTheBoundary)
+{
+    const auto above = tsunit::checkProperty(tsunit::anyInt<int>(0, 100000), 10000, 4711, [](int x) {
+        return x < 1000;
+    });
+    UT_EXPECT_TRUE(above.failed);
+    UT_EXPECT_EQ(above.counterexample, 1000);
+    UT_EXPECT_EQ(above.seed, 4711u);
+
+    const auto below = tsunit::checkProperty(tsunit::anyInt<int>(-100000, -10), 10000, 4711, [](int x) {
+        return x > -5000;
+    });
+    UT_EXPECT_TRUE(below.failed);
+    UT_EXPECT_EQ(below.counterexample, -5000);
+}
+
+TSUNIT_TEST(Properties, floatShrinksTowardsZero)
+{
+    const auto result = tsunit::checkProperty(tsunit::anyFloat<double>(0.0, 1000.0), 10000, 4711, [](double x) {
+        return x < 100.5;
+    });
+    UT_EXPECT_TRUE(result.failed);
+    UT_EXPECT_TRUE(result.counterexample >= 100.5);
+    UT_EXPECT_TRUE(result.counterexample < 201.0);
+}
+
+TSUNIT_TEST(Properties, bytesShrinkToTheMinimalBuffer)
+{
+    const auto result = tsunit::checkProperty(tsunit::anyBytes(64), 10000, 4711, [](const std::vector<std::uint8_t>& bytes) {
+        return bytes.size() < 5;
+    });
+    UT_EXPECT_TRUE(result.failed);
+    UT_EXPECT_TRUE(result.counterexample == std::vector<std::uint8_t>(5, 0));
+}
+
+TSUNIT_TEST(Properties, containersShrinkElementWise)
+{
+    const auto vectors = tsunit::checkProperty(tsunit::anyVector(tsunit::anyInt<int>(0, 50), 20), 10000, 4711, [](const std::vector<int>& v) {
+        return std::accumulate(v.begin(), v.end(), 0) < 100;
+    });
+    UT_EXPECT_TRUE(vectors.failed);
+    UT_EXPECT_EQ(std::accumulate(vectors.counterexample.begin(), vectors.counterexample.end(), 0), 100);
+
+    const auto pairs = tsunit::checkProperty(tsunit::anyPair(tsunit::anyInt<int>(0, 1000), tsunit::anyInt<int>(0, 1000)), 10000, 4711
+                                           , [](const std::pair<int, int>& p) {
+        return p.first + p.second < 500;
+    });
+    UT_EXPECT_TRUE(pairs.failed);
+    UT_EXPECT_EQ(pairs.counterexample.first + pairs.counterexample.second, 500);
+}
+
+TSUNIT_TEST(Properties, reportsTheFirstFailedCase)
+{
+    const auto generator = tsunit::anyInt<unsigned int>(0, 1000000);
+    const auto property = [](unsigned int x) { return (x % 997) != 0; };
+
+    unsigned long long firstFailedCase = 0;
+    for (;; ++firstFailedCase)
+    {
+        tsunit::CPropertyRandom random(4711, firstFailedCase);
+        if (not property(generator.generate(random)))
+        {
+            break;
+        }
+    }
+
+    // The same no matter how many threads checked the cases.
+    const auto result = tsunit::checkProperty(generator, 1000000, 4711, property);
+    UT_EXPECT_TRUE(result.failed);
+    UT_EXPECT_EQ(result.failedCase, firstFailedCase);
+    UT_EXPECT_FALSE(property(result.counterexample));
+
+    const auto replayed = tsunit::checkProperty(generator, 1000000, 4711, property);
+    UT_EXPECT_EQ(replayed.failedCase, result.failedCase);
+    UT_EXPECT_EQ(replayed.shrinks, result.shrinks);
+}
+
+TSUNIT_TEST(Properties, passedPropertyIsNotShrunk)
+{
+    const auto result = tsunit::checkProperty(tsunit::anyInt<int>(0, 10), 1000, 4711, [](int) { return true; });
+    UT_EXPECT_FALSE(result.failed);
+    UT_EXPECT_EQ(result.shrinks, 0u);
+}
@@ -30,8 +30,16 @@
  * ========================================================================== */
 #include "TSUnitTestAddOns.hpp"
 #include "TSUnit.hpp"
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <cmath>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
 
 TSUNIT_TEST(TestAddOns, ROTL)
 {
@@ -67,47 +75,8 @@ TSUNIT_TEST(TestAddOns_PseudoRandom, CheckEntropy)
 {
     tsunit::pseudoRandomsetSeed(2312);
 
-    std::uint32_t cnt[32] = {0};
-
-    constexpr std::size_t kIterations = 10000;
-    for (unsigned int i=0; i < kIterations; ++i)
-    {
-        const std::uint32_t num =tsunit::pseudoRandom();
-        // Loop throught the 32 bits and sum up all bits set.
-        for (unsigned int j= 0; j<32; ++j)
-        {
-            if (num & (1ul<<j))
-            {
-                ++cnt[j];
-            }
-        }
-    }
-
-    unsigned long sumCnt = 0;
-    // Loop throught the 32 bits and sum up all bits set in total.
-    for (unsigned int i=0; i < 32; ++i)
-    {
-        sumCnt += cnt[i];
-    }
-
-    // Treat a deviation of +/- 4% as acceptable
-    constexpr unsigned int kMaxDAcceptableDeviationPercent = 4; // The +/- Deviation in %
-
-    const uint32_t averageCnt = sumCnt >> 5; // 32
-    const unsigned int absDeviation = (kMaxDAcceptableDeviationPercent * averageCnt) / 100;
-    const unsigned int maxDeviation = averageCnt + absDeviation;
-    const unsigned int minDeviation = averageCnt - absDeviation;
-
-    // Loop throught the 32 bits...
-    for (unsigned int i=0; i < 32; ++i)
-    {
-        const bool success((cnt[i] >= minDeviation) && (cnt[i] <= maxDeviation));
-        if (!success)
-        {
-            UT_EXPECT_TRUE(success);
-            break;
-        }
-    }
+    // Treat a deviation of +/- 4.5% (from the half of the numbers) as acceptable
+    UT_EXPECT_UNIFORM_BITS([]() { return tsunit::pseudoRandom(); }, 10000, 0.045);
 }
 
 TSUNIT_TEST(TestAddOns_PseudoRandom, CheckReproducebility)
@@ -152,92 +121,765 @@ TSUNIT_TEST(TestAddOns_PseudoRandom, CheckReproducebility)
 
 TSUNIT_TEST(TestAddOns_Hash, CheckEntropyWithZeroInput)
 {
-    std::uint32_t cnt[32]= {0};
-
     std::uint8_t testData[71] = {0};
     tsunit::CHasher hash;
 
-    constexpr std::size_t kIterations = 10000;
-    for (unsigned int i=0; i < kIterations; ++i)
+    // Treat a deviation of +/- 3% as acceptable
+    UT_EXPECT_UNIFORM_BITS([&]() { return hash.add(testData, sizeof(testData)).value(); }, 10000, 0.03);
+}
+
+TSUNIT_TEST(TestAddOns_Hash, CheckEntropy)
+{
+    const char testData[] = "Das Reh springt hoch, das Reh springt weit, das darf es auch, es hat ja Zeit...";
+    tsunit::CHasher hash;
+
+    // Treat a deviation of +/- 3% as acceptable
+    UT_EXPECT_UNIFORM_BITS([&]() { return hash.add(testData, sizeof(testData)).value(); }, 10000, 0.03);
+}
+
+TSUNIT_TEST(TestAddOns_Hash, CheckKnownHashes)
+{
+    // These have been calculated by the original (byte by byte) implementation.
+    const char* text[] = {"", "a", "TSUnit", "The quick brown fox jumps over the lazy dog"};
+    const std::uint32_t expectedHash[] = {0xac3b843bul, 0x1943f772ul, 0x6efbd31bul, 0x4990c07ful};
+
+    for (unsigned int i=0; i < dimof(text); ++i)
     {
-        hash.add(testData, sizeof(testData));
-        std::uint32_t num = hash.value();
-        int j=0;
+        UT_EXPECT_EQ(tsunit::hash(text[i], std::strlen(text[i])), expectedHash[i]);
+        UT_EXPECT_EQ(tsunit::hashReference(text[i], std::strlen(text[i])), expectedHash[i]);
+    }
+
+    std::uint8_t buffer[1000];
+    for (unsigned int i=0; i < dimof(buffer); ++i)
+    {
+        buffer[i] = std::uint8_t(i * 7 + 3);
+    }
+    UT_EXPECT_EQ(tsunit::hash(buffer, sizeof(buffer)), 0x7c3e987aul);
+}
+
+TSUNIT_TEST(TestAddOns_Hash, CheckEqualToReference)
+{
+    std::uint8_t buffer[4096];
+    tsunit::pseudoRandomsetSeed(4711);
+    for (unsigned int i=0; i < dimof(buffer); ++i)
+    {
+        buffer[i] = std::uint8_t(tsunit::pseudoRandom());
+    }
 
-        for (unsigned int j= 0; j<32; ++j)
+    // All sizes, and all alignments of the start
+    for (unsigned int size=0; size < 300; ++size)
+    {
+        for (unsigned int offset=0; offset < 8; ++offset)
+        {
+            if (tsunit::hash(buffer + offset, size) != tsunit::hashReference(buffer + offset, size))
+            {
+                UT_EXPECT_EQ(tsunit::hash(buffer + offset, size), tsunit::hashReference(buffer + offset, size));
+                return;
+            }
+        }
+    }
+    UT_EXPECT_EQ(tsunit::hash(buffer, sizeof(buffer)), tsunit::hashReference(buffer, sizeof(buffer)));
+
+    // Every single byte value
+    for (unsigned int value=0; value < 256; ++value)
+    {
+        const std::uint8_t byte = std::uint8_t(value);
+        if (tsunit::hash(&byte, 1) != tsunit::hashReference(&byte, 1))
         {
-            cnt[j] += (0 != (num & (1ul << j)));
+            UT_EXPECT_EQ(tsunit::hash(&byte, 1), tsunit::hashReference(&byte, 1));
+            return;
         }
     }
+}
 
-    unsigned int sumCnt = 0;
+TSUNIT_TEST(TestAddOns_HashMultiLane, CheckKnownHashes)
+{
+    // Stored hashes must stay valid - so the hashes of a version never change.
+    const char* text[] = {"", "a", "TSUnit", "The quick brown fox jumps over the lazy dog"};
+    const std::uint32_t expectedHash[] = {0xcc38673eul, 0xdaf91415ul, 0xdf1ef8f6ul, 0xc5edd0d9ul};
 
-    // Loop throught the 32 bits and sum up the total cnt
-    for (unsigned int i=0; i < 32; ++i)
+    for (unsigned int i=0; i < dimof(text); ++i)
     {
-        sumCnt += cnt[i];
+        UT_EXPECT_EQ(tsunit::hash(text[i], std::strlen(text[i]), tsunit::HashVersion::MULTILANE_V1), expectedHash[i]);
     }
 
-    // Treat a deviation of +/- 3% as acceptable
-    constexpr unsigned int kMaxDAcceptableDeviationPercent = 3; // The +/- Deviation in %
+    std::uint8_t buffer[1000];
+    for (unsigned int i=0; i < dimof(buffer); ++i)
+    {
+        buffer[i] = std::uint8_t(i * 7 + 3);
+    }
+    UT_EXPECT_EQ(tsunit::hash(buffer, sizeof(buffer), tsunit::HashVersion::MULTILANE_V1), 0x12740fcaul);
+}
+
+TSUNIT_TEST(TestAddOns_HashMultiLane, CheckEqualToScalar)
+{
+    std::uint8_t buffer[4096];
+    tsunit::pseudoRandomsetSeed(4711);
+    for (unsigned int i=0; i < dimof(buffer); ++i)
+    {
+        buffer[i] = std::uint8_t(tsunit::pseudoRandom());
+    }
+
+    // All sizes, and all alignments of the start
+    for (unsigned int size=0; size < 300; ++size)
+    {
+        for (unsigned int offset=0; offset < 8; ++offset)
+        {
+            const std::uint32_t multiLaneHash = tsunit::hash(buffer + offset, size, tsunit::HashVersion::MULTILANE_V1);
+            if (multiLaneHash != tsunit::hashMultiLaneScalar(buffer + offset, size))
+            {
+                UT_EXPECT_EQ(multiLaneHash, tsunit::hashMultiLaneScalar(buffer + offset, size));
+                return;
+            }
+        }
+    }
+    UT_EXPECT_EQ(tsunit::hash(buffer, sizeof(buffer), tsunit::HashVersion::MULTILANE_V1)
+               , tsunit::hashMultiLaneScalar(buffer, sizeof(buffer)));
+}
+
+TSUNIT_TEST(TestAddOns_HashMultiLane, CheckHasher)
+{
+    const char text[] = "The quick brown fox jumps over the lazy dog";
+
+    tsunit::CHasher legacyHasher;
+    tsunit::CHasher multiLaneHasher(0x5acB4821ul, tsunit::HashVersion::MULTILANE_V1);
+    legacyHasher.add(text, sizeof(text));
+    multiLaneHasher.add(text, sizeof(text));
+    UT_EXPECT_TRUE(legacyHasher.value() != multiLaneHasher.value());
+
+    std::uint8_t buffer[512];
+    tsunit::pseudoRandomsetSeed(4711);
+    for (unsigned int i=0; i < dimof(buffer); ++i)
+    {
+        buffer[i] = std::uint8_t(tsunit::pseudoRandom());
+    }
+
+    // The same as chaining the hashes of the scalar reference by hand - for
+    // all sizes and misaligned starts, so every length of the tail is covered.
+    multiLaneHasher.reset();
+    std::uint32_t expected = 0x5acB4821ul;
+    for (unsigned int size=0; size < 300; ++size)
+    {
+        for (unsigned int offset=0; offset < 8; ++offset)
+        {
+            multiLaneHasher.add(buffer + offset, size);
+            const std::uint32_t reference = tsunit::hashMultiLaneScalar(buffer + offset, size);
+            expected = tsunit::rotl<7>(expected) ^ (tsunit::rotr<12>(expected) - reference);
+            if (expected != multiLaneHasher.value())
+            {
+                UT_EXPECT_EQ(expected, multiLaneHasher.value());
+                return;
+            }
+        }
+    }
+    UT_EXPECT_EQ(expected, multiLaneHasher.value());
+}
+
+TSUNIT_TEST(TestAddOns_Hasher, CheckKnownHashes)
+{
+    // These have been calculated by the original (byte by byte) implementation.
+    tsunit::CHasher hasher;
+    hasher += std::uint8_t(0x42);
+    UT_EXPECT_EQ(hasher.value(), 0x6f749c68ul);
+    hasher += std::uint16_t(0x1234);
+    UT_EXPECT_EQ(hasher.value(), 0xdbe04464ul);
+    hasher += std::uint32_t(0xdeadbeef);
+    UT_EXPECT_EQ(hasher.value(), 0xaeeb7438ul);
+    hasher += 3.25f;
+    UT_EXPECT_EQ(hasher.value(), 0x541ffc2bul);
+    hasher += int(-7);
+    UT_EXPECT_EQ(hasher.value(), 0x1e13d26aul);
+}
+
+TSUNIT_TEST(TestAddOns_Hasher, CheckEndianIndependence)
+{
+    // Every value is the same as its bytes in big endian order.
+    tsunit::CHasher bytesHasher;
+    const std::uint8_t bytes[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef};
+    for (std::uint8_t byte : bytes)
+    {
+        bytesHasher += byte;
+    }
+
+    tsunit::CHasher u64Hasher;
+    u64Hasher += std::uint64_t(0x0123456789abcdefull);
+    UT_EXPECT_EQ(u64Hasher.value(), bytesHasher.value());
+
+    tsunit::CHasher u32Hasher;
+    u32Hasher += std::uint32_t(0x01234567ul);
+    u32Hasher += std::uint32_t(0x89abcdeful);
+    UT_EXPECT_EQ(u32Hasher.value(), bytesHasher.value());
+
+    tsunit::CHasher u16Hasher;
+    u16Hasher += std::uint16_t(0x0123);
+    u16Hasher += std::uint16_t(0x4567);
+    u16Hasher += std::uint16_t(0x89ab);
+    u16Hasher += std::uint16_t(0xcdef);
+    UT_EXPECT_EQ(u16Hasher.value(), bytesHasher.value());
+
+    // IEEE floating point numbers are added as their bit pattern.
+    tsunit::CHasher doubleHasher;
+    doubleHasher += 1.0;
+    tsunit::CHasher doubleBitsHasher;
+    doubleBitsHasher += std::uint64_t(0x3ff0000000000000ull);
+    UT_EXPECT_EQ(doubleHasher.value(), doubleBitsHasher.value());
+}
+
+TSUNIT_TEST(TestAddOns_Hasher, CheckAddAllAndSpans)
+{
+    tsunit::CHasher oneByOneHasher;
+    oneByOneHasher += std::uint8_t(7);
+    oneByOneHasher += std::uint16_t(0xbeef);
+    oneByOneHasher += std::uint32_t(4711);
+    oneByOneHasher += std::uint64_t(1) << 40;
+    oneByOneHasher += -1.5f;
+    oneByOneHasher += 2.75;
+
+    tsunit::CHasher allHasher;
+    allHasher.addAll(std::uint8_t(7), std::uint16_t(0xbeef), std::uint32_t(4711), std::uint64_t(1) << 40, -1.5f, 2.75);
+    UT_EXPECT_EQ(allHasher.value(), oneByOneHasher.value());
+
+    std::vector<std::uint32_t> values(1000);
+    tsunit::CHasher valueHasher;
+    for (std::size_t i=0; i < values.size(); ++i)
+    {
+        values[i] = std::uint32_t(i * 2654435761ul);
+        valueHasher += values[i];
+    }
+
+    tsunit::CHasher spanHasher;
+    spanHasher.addSpan(values.data(), values.size());
+    UT_EXPECT_EQ(spanHasher.value(), valueHasher.value());
+
+    tsunit::CHasher vectorHasher;
+    vectorHasher.add(values);
+    UT_EXPECT_EQ(vectorHasher.value(), valueHasher.value());
+
+    // ... the same for the multi lane hash.
+    tsunit::CHasher multiLaneHasher(0x5acB4821ul, tsunit::HashVersion::MULTILANE_V1);
+    for (std::uint32_t value : values)
+    {
+        multiLaneHasher += value;
+    }
+    tsunit::CHasher multiLaneSpanHasher(0x5acB4821ul, tsunit::HashVersion::MULTILANE_V1);
+    multiLaneSpanHasher.add(values);
+    UT_EXPECT_EQ(multiLaneSpanHasher.value(), multiLaneHasher.value());
+    UT_EXPECT_TRUE(multiLaneSpanHasher.value() != valueHasher.value());
+}
+
+TSUNIT_TEST(TestAddOns_TreeHash, CheckIndependentOfThreads)
+{
+    std::vector<std::uint8_t> data(1000 * 1000 + 17);
+    tsunit::pseudoRandomsetSeed(4711);
+    for (std::uint8_t& byte : data)
+    {
+        byte = std::uint8_t(tsunit::pseudoRandom());
+    }
+
+    const tsunit::TreeHash serialHash = tsunit::hashRange(data.data(), data.size(), tsunit::HashVersion::MULTILANE_V1, 4096, 1);
+    UT_EXPECT_EQ(serialHash.chunkHashes.size(), std::size_t(245));
+    UT_EXPECT_EQ(serialHash.dataSize, std::uint64_t(data.size()));
+
+    for (unsigned int nrOfThreads : {2u, 3u, 8u, 0u})
+    {
+        const tsunit::TreeHash parallelHash = tsunit::hashRange(data.data(), data.size(), tsunit::HashVersion::MULTILANE_V1, 4096, nrOfThreads);
+        UT_EXPECT_EQ(parallelHash.root, serialHash.root);
+        UT_EXPECT_TRUE(parallelHash.chunkHashes == serialHash.chunkHashes);
+    }
+
+    // The chunks are just hashed.
+    UT_EXPECT_EQ(serialHash.chunkHashes[3], tsunit::hash(&data[3 * 4096], 4096, tsunit::HashVersion::MULTILANE_V1));
+    UT_EXPECT_EQ(serialHash.chunkHashes.back(), tsunit::hash(&data[244 * 4096], 1000 * 1000 + 17 - 244 * 4096, tsunit::HashVersion::MULTILANE_V1));
+
+    // Another version, another chunk size or size of the data - another hash.
+    UT_EXPECT_TRUE(tsunit::hashRange(data.data(), data.size(), tsunit::HashVersion::LEGACY, 65536).root != serialHash.root);
+    UT_EXPECT_TRUE(tsunit::hashRange(data.data(), data.size(), tsunit::HashVersion::MULTILANE_V1, 8192).root != serialHash.root);
+    UT_EXPECT_TRUE(tsunit::hashRange(data.data(), data.size() - 1, tsunit::HashVersion::MULTILANE_V1, 4096).root != serialHash.root);
+
+    // Empty data
+    const tsunit::TreeHash emptyHash = tsunit::hashRange(nullptr, 0);
+    UT_EXPECT_TRUE(emptyHash.chunkHashes.empty());
+    UT_EXPECT_EQ(emptyHash.root, tsunit::hashRange(nullptr, 0).root);
+}
+
+TSUNIT_TEST(TestAddOns_TreeHash, CheckDiff)
+{
+    std::vector<std::uint8_t> data(100 * 1024, 0x55);
+    const tsunit::TreeHash hash = tsunit::hashRange(data.data(), data.size(), tsunit::HashVersion::MULTILANE_V1, 1024);
+    UT_EXPECT_TRUE(hash.diff(hash).empty());
+
+    data[5 * 1024 + 7] ^= 1;
+    data[77 * 1024] ^= 1;
+    const tsunit::TreeHash modifiedHash = tsunit::hashRange(data.data(), data.size(), tsunit::HashVersion::MULTILANE_V1, 1024);
+    UT_EXPECT_TRUE(modifiedHash.root != hash.root);
+    UT_EXPECT_TRUE(modifiedHash.diff(hash) == std::vector<std::size_t>({5, 77}));
+
+    // Appended data
+    data.resize(data.size() + 1);
+    const tsunit::TreeHash appendedHash = tsunit::hashRange(data.data(), data.size(), tsunit::HashVersion::MULTILANE_V1, 1024);
+    UT_EXPECT_TRUE(appendedHash.diff(modifiedHash) == std::vector<std::size_t>({100}));
+}
+
+#if !defined(CROSS_BUILD)
+TSUNIT_TEST(TestAddOns_TreeHash, CheckFile)
+{
+    std::vector<std::uint8_t> data(300 * 1000);
+    for (std::size_t i=0; i < data.size(); ++i)
+    {
+        data[i] = std::uint8_t(i * 31 + (i >> 8));
+    }
+
+    // Unique, since several runs of these tests may run in parallel.
+    const std::string pathName = "UT_TSUnitTestAddOns_TreeHash_"
+                               + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())
+                               + "_" + std::to_string(reinterpret_cast<std::uintptr_t>(&data)) + ".tmp";
+    const char* path = pathName.c_str();
+    FILE* file = fopen(path, "wb");
+    UT_EXPECT_TRUE(nullptr != file);
+    if (nullptr == file)
+    {
+        return;
+    }
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+
+    tsunit::TreeHash fileHash;
+    UT_EXPECT_TRUE(tsunit::hashFile(path, fileHash, tsunit::HashVersion::MULTILANE_V1, 16384));
+    remove(path);
+
+    const tsunit::TreeHash rangeHash = tsunit::hashRange(data.data(), data.size(), tsunit::HashVersion::MULTILANE_V1, 16384);
+    UT_EXPECT_EQ(fileHash.root, rangeHash.root);
+    UT_EXPECT_TRUE(fileHash.diff(rangeHash).empty());
+
+    tsunit::TreeHash missingHash;
+    UT_EXPECT_FALSE(tsunit::hashFile("UT_TSUnitTestAddOns_DoesNotExist.tmp", missingHash));
+}
+#endif // !defined(CROSS_BUILD)
+
+TSUNIT_TEST(TestAddOns_RandomStream, CheckCounterBased)
+{
+    tsunit::CRandomStream stream(4711);
+    tsunit::CRandomStream jumpingStream(4711);
+    const tsunit::CRandomStream constStream(4711);
+
+    for (std::uint64_t i=0; i < 1000; ++i)
+    {
+        UT_EXPECT_EQ(constStream.at(i), stream.next64());
+    }
+    UT_EXPECT_EQ(stream.counter(), std::uint64_t(1000));
+
+    // Jump ahead
+    jumpingStream.jump(1000);
+    UT_EXPECT_EQ(jumpingStream.next64(), stream.next64());
+    jumpingStream.jump(1ull << 62);
+    UT_EXPECT_EQ(jumpingStream.next64(), constStream.at((1ull << 62) + 1001));
+
+    // 32 bit numbers take the upper half of the 64 bit ones.
+    tsunit::CRandomStream stream32(4711);
+    UT_EXPECT_EQ(stream32.next32(), std::uint32_t(constStream.at(0) >> 32));
+}
 
-    const uint32_t averageCnt = sumCnt >> 5; // 32
-    const unsigned int absDeviation = (kMaxDAcceptableDeviationPercent * averageCnt) / 100;
+TSUNIT_TEST(TestAddOns_RandomStream, CheckSubstreams)
+{
+    const tsunit::CRandomStream stream(4711);
+    UT_EXPECT_EQ(stream.substream(1).key(), stream.substream(1).key());
+    UT_EXPECT_TRUE(stream.substream(1).key() != stream.substream(2).key());
+    UT_EXPECT_TRUE(stream.substream(1).key() != tsunit::CRandomStream(4712).substream(1).key());
+    UT_EXPECT_TRUE(stream.substream(0).at(0) != stream.at(0));
+
+    UT_EXPECT_EQ(tsunit::CRandomStream::forName("Group::test").key(), tsunit::CRandomStream::forName("Group::test").key());
+    UT_EXPECT_TRUE(tsunit::CRandomStream::forName("Group::test").key() != tsunit::CRandomStream::forName("Group::tesT").key());
+    UT_EXPECT_TRUE(tsunit::CRandomStream::forName("Group::test", 1).key() != tsunit::CRandomStream::forName("Group::test").key());
+}
 
-    const unsigned int maxDeviation = averageCnt + absDeviation;
-    const unsigned int minDeviation = averageCnt - absDeviation;
+TSUNIT_TEST(TestAddOns_RandomStream, CheckSeededByTheTest)
+{
+    // The streams of a test only depend on its name.
+    UT_EXPECT_EQ(tsunit::testRandomStream().key(), tsunit::CRandomStream::forName("TestAddOns_RandomStream::CheckSeededByTheTest").key());
+    UT_EXPECT_EQ(tsunit::testRandomStream().counter(), std::uint64_t(0));
 
-    // Loop through the counted 32 bits and check if their count values
-    // are within the expected tolerance.
-    for (unsigned int i=0; i < 32; ++i)
+    const std::uint32_t first = tsunit::pseudoRandom();
+    const std::uint64_t firstOfStream = tsunit::testRandomStream().next64();
+
+    tsunit::_seedTestRandomStreams("TestAddOns_RandomStream", "CheckSeededByTheTest");
+    UT_EXPECT_EQ(tsunit::pseudoRandom(), first);
+    UT_EXPECT_EQ(tsunit::testRandomStream().next64(), firstOfStream);
+}
+
+#if defined(TSUNIT_WITH_THREADS)
+TSUNIT_TEST(TestAddOns_RandomStream, CheckThreadsDoNotShareTheirState)
+{
+    constexpr unsigned int kNrOfThreads = 4;
+    constexpr unsigned int kIterations = 10000;
+    std::vector<std::vector<std::uint32_t> > numbers(kNrOfThreads, std::vector<std::uint32_t>(kIterations));
+
+    std::vector<std::thread> threads;
+    for (unsigned int t=0; t < kNrOfThreads; ++t)
     {
-        const bool success((cnt[i] >= minDeviation) && (cnt[i] <= maxDeviation));
-        if (!success)
+        threads.push_back(std::thread([&numbers, t]() {
+            tsunit::pseudoRandomsetSeed(42);
+            for (std::uint32_t& number : numbers[t])
+            {
+                number = tsunit::pseudoRandom();
+            }
+        }));
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (unsigned int t=1; t < kNrOfThreads; ++t)
+    {
+        UT_EXPECT_TRUE(numbers[t] == numbers[0]);
+    }
+}
+#endif // defined(TSUNIT_WITH_THREADS)
+
+TSUNIT_TEST(TestAddOns_RandomStream, CheckFill)
+{
+    // The bytes are the numbers of the stream in little endian order
+    std::uint8_t buffer[8 * 10 + 5];
+    tsunit::CRandomStream stream(4711);
+    stream.fill(buffer, sizeof(buffer));
+    UT_EXPECT_EQ(stream.counter(), std::uint64_t(11));
+
+    const tsunit::CRandomStream constStream(4711);
+    for (unsigned int i=0; i < sizeof(buffer); ++i)
+    {
+        if (buffer[i] != std::uint8_t(constStream.at(i / 8) >> (8 * (i % 8))))
         {
-            UT_EXPECT_TRUE(success);
+            UT_EXPECT_EQ(buffer[i], std::uint8_t(constStream.at(i / 8) >> (8 * (i % 8))));
             break;
         }
     }
+
+    // Reproducible by the seed
+    std::vector<std::uint8_t> first(100000);
+    std::vector<std::uint8_t> second(100000);
+    tsunit::pseudoRandomsetSeed(42);
+    tsunit::pseudoRandomFill(first.data(), first.size());
+    tsunit::pseudoRandomsetSeed(42);
+    tsunit::pseudoRandomFill(second.data(), second.size());
+    UT_EXPECT_TRUE(first == second);
+    tsunit::pseudoRandomFill(second.data(), second.size());
+    UT_EXPECT_FALSE(first == second);
 }
 
-TSUNIT_TEST(TestAddOns_Hash, CheckEntropy)
+TSUNIT_TEST(TestAddOns_RandomStream, CheckBulkBelowMatchesSingleCalls)
 {
-    std::uint32_t cnt[32] = {0};
+    // Small bounds, a bound of 0, and huge ones that reject half of the numbers
+    const std::uint64_t bounds[] = {1, 6, 1000, 0, (std::uint64_t(1) << 63) + 1, ~std::uint64_t(0) - 2};
+    for (std::uint64_t bound : bounds)
+    {
+        tsunit::CRandomStream bulkStream(4711);
+        tsunit::CRandomStream singleStream(4711);
+        std::vector<std::uint64_t> values(1000);
+        for (std::size_t count : {std::size_t(1), std::size_t(63), std::size_t(64), std::size_t(1000)})
+        {
+            bulkStream.fillBelow(values.data(), count, bound);
+            std::size_t mismatches = 0;
+            for (std::size_t i=0; i < count; ++i)
+            {
+                mismatches += (singleStream.below(bound) != values[i]) ? 1 : 0;
+            }
+            UT_EXPECT_EQ(mismatches, std::size_t(0));
+            UT_EXPECT_EQ(singleStream.counter(), bulkStream.counter());
+        }
+    }
+}
 
-    const char testData[] = "Das Reh springt hoch, das Reh springt weit, das darf es auch, es hat ja Zeit...";
+TSUNIT_TEST(TestAddOns_RandomStream, CheckUnbiasedRanges)
+{
+    tsunit::CRandomStream stream(4711);
+    UT_EXPECT_EQ(stream.below(1), std::uint64_t(0));
+    UT_EXPECT_EQ(stream.uniformInt(-3, -3), std::int64_t(-3));
+
+    // A bound that is no power of 2 - every value has to be equally likely.
+    constexpr unsigned int kBound = 6;
+    constexpr unsigned int kIterations = 600000;
+    std::vector<std::uint64_t> values(kIterations);
+    stream.fillBelow(values.data(), values.size(), kBound);
+
+    unsigned int cnt[kBound] = {0};
+    std::size_t outOfRange = 0;
+    for (std::uint64_t value : values)
+    {
+        if (value < kBound)
+        {
+            ++cnt[value];
+        }
+        else
+        {
+            ++outOfRange;
+        }
+    }
+    UT_EXPECT_EQ(std::size_t(0), outOfRange);
+    for (unsigned int count : cnt)
+    {
+        UT_EXPECT_TRUE((count > 99000) and (count < 101000));
+    }
 
-    tsunit::CHasher hash;
-    constexpr std::size_t kIterations = 10000;
-    for (unsigned int i=0; i < kIterations; ++i)
+    // The bulk variant returns the same numbers as single calls.
+    tsunit::CRandomStream singleStream(4711);
+    singleStream.below(1);
+    singleStream.uniformInt(-3, -3);
+    for (std::size_t i=0; i < 1000; ++i)
     {
-        hash.add(testData, sizeof(testData));
-        std::uint32_t num = hash.value();
+        if (singleStream.below(kBound) != values[i])
+        {
+            UT_EXPECT_EQ(singleStream.below(kBound), values[i]);
+            break;
+        }
+    }
 
-        for (unsigned int j= 0; j<32; ++j)
+    for (unsigned int i=0; i < 10000; ++i)
+    {
+        const std::int64_t value = stream.uniformInt(-5, 5);
+        if ((value < -5) or (value > 5))
         {
-            cnt[j] += (0 != (num & (1ul << j)));
+            UT_EXPECT_TRUE((value >= -5) and (value <= 5));
+            break;
         }
     }
+}
+
+TSUNIT_TEST(TestAddOns_RandomStream, CheckDistributions)
+{
+    constexpr std::size_t kIterations = 200000;
+    std::vector<double> values(kIterations);
+
+    // Uniform, and using all 53 bits
+    tsunit::CRandomStream stream(4711);
+    stream.fillUniformDouble(values.data(), values.size());
+    double sum = 0.0;
+    bool anyLowBitSet = false;
+    std::size_t outOfRange = 0;
+    for (double value : values)
+    {
+        outOfRange += ((value >= 0.0) and (value < 1.0)) ? 0 : 1;
+        sum += value;
+        anyLowBitSet |= (0 != (std::uint64_t(value * 9007199254740992.0) & 1));
+    }
+    UT_EXPECT_EQ(std::size_t(0), outOfRange);
+    UT_EXPECT_TRUE(anyLowBitSet);
+    UT_EXPECT_TRUE(std::fabs(sum / kIterations - 0.5) < 0.005);
+
+    // Normal
+    stream.fillNormal(values.data(), values.size(), 10.0, 2.0);
+    double sumOfSquares = 0.0;
+    sum = 0.0;
+    for (double value : values)
+    {
+        sum += value;
+        sumOfSquares += value * value;
+    }
+    const double mean = sum / kIterations;
+    const double stdDev = std::sqrt(sumOfSquares / kIterations - mean * mean);
+    UT_EXPECT_TRUE(std::fabs(mean - 10.0) < 0.02);
+    UT_EXPECT_TRUE(std::fabs(stdDev - 2.0) < 0.02);
+
+    // Exponential
+    stream.fillExponential(values.data(), values.size(), 4.0);
+    sum = 0.0;
+    outOfRange = 0;
+    for (double value : values)
+    {
+        outOfRange += (value >= 0.0) ? 0 : 1;
+        sum += value;
+    }
+    UT_EXPECT_EQ(std::size_t(0), outOfRange);
+    UT_EXPECT_TRUE(std::fabs(sum / kIterations - 0.25) < 0.005);
+
+    // Single values
+    UT_EXPECT_TRUE(stream.exponential(1.0) >= 0.0);
+    const double normal = stream.normal();
+    UT_EXPECT_TRUE((normal > -10.0) and (normal < 10.0));
+    const double precise = tsunit::pseudoRandomDouble(1.0, 2.0);
+    UT_EXPECT_TRUE((precise >= 1.0) and (precise < 2.0));
+}
 
-    unsigned int sumCnt = 0;
-    // Loop throught the 32 bits and sum up the total cnt
-    for (unsigned int i=0; i < 32; ++i)
+TSUNIT_TEST(TestAddOns_RandomStream, CheckShuffle)
+{
+    std::vector<unsigned int> values(1000);
+    for (unsigned int i=0; i < values.size(); ++i)
     {
-        sumCnt += cnt[i];
+        values[i] = i;
     }
 
-    // Treat a deviation of +/- 3% as acceptable
-    constexpr unsigned int kMaxDAcceptableDeviationPercent = 3; // The +/- Deviation in %
+    std::vector<unsigned int> shuffled(values);
+    tsunit::CRandomStream(4711).shuffle(shuffled.data(), shuffled.size());
+    UT_EXPECT_FALSE(shuffled == values);
 
-    const uint32_t averageCnt = sumCnt >> 5; // 32
-    const unsigned int absDeviation = (kMaxDAcceptableDeviationPercent * averageCnt) / 100;
+    std::vector<unsigned int> shuffledAgain(values);
+    tsunit::CRandomStream(4711).shuffle(shuffledAgain.data(), shuffledAgain.size());
+    UT_EXPECT_TRUE(shuffled == shuffledAgain);
 
-    const unsigned int maxDeviation = averageCnt + absDeviation;
-    const unsigned int minDeviation = averageCnt - absDeviation;
+    // ... still a permutation
+    std::sort(shuffled.begin(), shuffled.end());
+    UT_EXPECT_TRUE(shuffled == values);
+}
 
-    for (unsigned int i=0; i < 32; ++i)
+TSUNIT_TEST(TestAddOns_WideHasher, CheckKnownHashes)
+{
+    // The published test vectors of XXH64 and MurmurHash3 x64 128 (seed 0)
+    const char* text[] = {"", "a", "abc", "The quick brown fox jumps over the lazy dog"};
+    const std::uint64_t expectedHash64[] = {
+        0xef46db3751d8e999ull, 0xd24ec4f1a98c6e5bull, 0x44bc2cf5ad770999ull, 0x0b242d361fda71bcull
+    };
+
+    for (unsigned int i=0; i < dimof(text); ++i)
     {
-        const bool success((cnt[i] >= minDeviation) && (cnt[i] <= maxDeviation));
-        UT_EXPECT_TRUE(success);
+        tsunit::CHasher64 hasher;
+        UT_EXPECT_EQ(hasher.add(text[i], std::strlen(text[i])).value(), expectedHash64[i]);
     }
+
+    tsunit::CHasher128 hasher;
+    UT_EXPECT_TRUE(hasher.value() == tsunit::Hash128({0, 0}));
+    hasher.add("hello", 5);
+    UT_EXPECT_EQ(hasher.value().low, 0xcbd8a7b341bd9b02ull);
+    UT_EXPECT_EQ(hasher.value().high, 0x5b1e906a48ae1d19ull);
+    hasher.reset();
+    hasher.add(text[3], std::strlen(text[3]));
+    UT_EXPECT_EQ(hasher.value().low, 0xe34bbc7bbc071b6cull);
+    UT_EXPECT_EQ(hasher.value().high, 0x7a433ca9c49a9347ull);
+}
+
+TSUNIT_TEST(TestAddOns_WideHasher, CheckStreaming)
+{
+    std::vector<std::uint8_t> data(1000);
+    tsunit::CRandomStream(4711).fill(data.data(), data.size());
+
+    tsunit::CHasher64 hasher64;
+    tsunit::CHasher128 hasher128;
+    hasher64.add(data.data(), data.size());
+    hasher128.add(data.data(), data.size());
+
+    // Adding the data piecewise gives the same hash.
+    tsunit::CRandomStream splits(42);
+    for (unsigned int run=0; run < 100; ++run)
+    {
+        tsunit::CHasher64 pieceHasher64;
+        tsunit::CHasher128 pieceHasher128;
+        for (std::size_t offset=0; offset < data.size();)
+        {
+            const std::size_t size = std::min<std::size_t>(std::size_t(splits.below(70)), data.size() - offset);
+            pieceHasher64.add(data.data() + offset, size);
+            pieceHasher128.add(data.data() + offset, size);
+            offset += size;
+        }
+        if ((pieceHasher64.value() != hasher64.value()) or (pieceHasher128.value() != hasher128.value()))
+        {
+            UT_EXPECT_EQ(pieceHasher64.value(), hasher64.value());
+            UT_EXPECT_TRUE(pieceHasher128.value() == hasher128.value());
+            break;
+        }
+    }
+
+    // Another seed, another hash
+    UT_EXPECT_TRUE(tsunit::CHasher64(1).add(data.data(), data.size()).value() != hasher64.value());
+    UT_EXPECT_TRUE(tsunit::CHasher128(1).add(data.data(), data.size()).value() != hasher128.value());
+}
+
+TSUNIT_TEST(TestAddOns_WideHasher, CheckTypedValues)
+{
+    // Typed values are added as their bytes in big endian order.
+    const std::uint8_t bytes[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x3f, 0xf0, 0, 0, 0, 0, 0, 0};
+
+    tsunit::CHasher64 bytesHasher;
+    bytesHasher.add(bytes, sizeof(bytes));
+
+    tsunit::CHasher64 typedHasher;
+    typedHasher += std::uint32_t(0x01234567ul);
+    typedHasher += std::uint16_t(0x89ab);
+    typedHasher += std::uint8_t(0xcd);
+    typedHasher += std::uint8_t(0xef);
+    typedHasher += 1.0;
+    UT_EXPECT_EQ(typedHasher.value(), bytesHasher.value());
+
+    tsunit::CHasher64 allHasher;
+    allHasher.addAll(std::uint64_t(0x0123456789abcdefull), 1.0);
+    UT_EXPECT_EQ(allHasher.value(), bytesHasher.value());
+
+    tsunit::CHasher128 bytesHasher128;
+    bytesHasher128.add(bytes, sizeof(bytes));
+    const std::vector<std::uint32_t> words = {0x01234567ul, 0x89abcdeful, 0x3ff00000ul, 0};
+    tsunit::CHasher128 vectorHasher128;
+    vectorHasher128.add(words);
+    UT_EXPECT_TRUE(vectorHasher128.value() == bytesHasher128.value());
+
+    // Hashes may be used as keys
+    const tsunit::Hash128 smaller = {5, 1};
+    const tsunit::Hash128 larger = {1, 2};
+    UT_EXPECT_TRUE(smaller < larger);
+    UT_EXPECT_FALSE(larger < smaller);
+    UT_EXPECT_TRUE(smaller != larger);
+}
+
+TSUNIT_TEST(TestAddOns_Statistics, CheckBitCounter)
+{
+    // More values than a byte counter can take before it is flushed
+    tsunit::CRandomStream stream(4711);
+    tsunit::CBitCounter counter;
+    std::uint64_t expected[64] = {0};
+    for (unsigned int i=0; i < 1000; ++i)
+    {
+        const std::uint64_t value = stream.next64();
+        counter.add(value);
+        for (unsigned int bit=0; bit < 64; ++bit)
+        {
+            expected[bit] += (value >> bit) & 1;
+        }
+    }
+    UT_EXPECT_EQ(counter.samples(), std::uint64_t(1000));
+    for (unsigned int bit=0; bit < 64; ++bit)
+    {
+        UT_EXPECT_EQ(counter.count(bit), expected[bit]);
+    }
+}
+
+TSUNIT_TEST(TestAddOns_Statistics, CheckUniformBits)
+{
+    tsunit::CRandomStream& stream = tsunit::testRandomStream();
+    UT_EXPECT_UNIFORM_BITS([&]() { return stream.next64(); }, 1000000, 0.01);
+    UT_EXPECT_UNIFORM_BITS([&]() { return std::uint8_t(stream.next32()); }, 100000, 0.02);
+
+    // Bit 5 is set in 3 of 4 values
+    std::uint32_t i = 0;
+    const tsunit::StatisticResult result = tsunit::checkUniformBits([&]() {
+        const std::uint32_t value = stream.next32() & ~(1u << 5);
+        return value | ((0 != (++i % 4)) ? (1u << 5) : 0u);
+    }, 10000, 0.03);
+    UT_EXPECT_TRUE(result.failed);
+    UT_EXPECT_EQ(result.worstBit, 5u);
+    UT_EXPECT_TRUE(std::fabs(result.deviation - 0.5) < 0.01);
+    UT_EXPECT_TRUE(result.pValue < 1e-9);
+}
+
+TSUNIT_TEST(TestAddOns_Statistics, CheckChiSquare)
+{
+    tsunit::CRandomStream& stream = tsunit::testRandomStream();
+    UT_EXPECT_CHI_SQUARE([&]() { return stream.next32(); }, 100000, 256, 0.0001);
+    UT_EXPECT_CHI_SQUARE([&]() { return stream.next64(); }, 100000, 1000, 0.0001);
+
+    // 7 values into 10 buckets
+    std::uint32_t i = 0;
+    UT_EXPECT_TRUE(tsunit::checkChiSquare([&]() { return ++i % 7; }, 10000, 10, 0.0001).failed);
+
+    // A counter is too uniform to be random
+    const tsunit::StatisticResult tooUniform = tsunit::checkChiSquare([&]() { return ++i; }, 100000, 256, 0.0001);
+    UT_EXPECT_TRUE(tooUniform.failed);
+    UT_EXPECT_TRUE(tooUniform.deviation < 0.0);
+}
+
+TSUNIT_TEST(TestAddOns_Statistics, CheckRuns)
+{
+    tsunit::CRandomStream& stream = tsunit::testRandomStream();
+    UT_EXPECT_RUNS([&]() { return stream.next64(); }, 100000, 0.0001);
+    UT_EXPECT_RUNS([&]() { return stream.next32(); }, 100000, 0.0001);
+
+    // Alternating bits change too often, blocks of bits too seldom
+    UT_EXPECT_TRUE(tsunit::checkRuns([]() { return 0x55555555u; }, 1000, 0.0001).failed);
+    UT_EXPECT_TRUE(tsunit::checkRuns([]() { return 0x0000ffffu; }, 1000, 0.0001).failed);
+    UT_EXPECT_TRUE(tsunit::checkRuns([]() { return 0u; }, 1000, 0.0001).failed);
 }
@@ -0,0 +1,108 @@
+/* ==========================================================================
+ * @(#)File: UT_TSUnit_FailingThreads.cpp
+ * Created: 2026-10-19
+ * --------------------------------------------------------------------------
+ *  (c)1982-2026 Tangerine-Software
+ *
+ *       Hans-Peter Beständig
+ *       Kühbachstr. 8
+ *       81543 München
+ *       GERMANY
+ *
+ *       mailto:hdusel@tangerine-soft.de
+ *       http://hdusel.tangerine-soft.de
+ * --------------------------------------------------------------------------
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * ========================================================================== */
+/*
+ * Checks that an assertion which fails on a thread that a test has started
+ * by itself fails this test. The test is expected to fail, so this runs the
+ * tests by its own main and checks the results.
+ */
+#include "TSUnit.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+/*
+ * Prints the report and counts the logged failed assertions.
+ */
+class CCountingLogger : public tsunit::ILogger
+{
+public:
+    virtual void reportIntro() override {}
+    virtual void issueTestRun(const tsunit::TestListEntry& inEntry) override
+    {
+        log("Running %s::%s\n", inEntry.groupName, inEntry.testCaseName);
+    }
+    virtual void reportPassed() override { log("[PASSED]\n"); }
+    virtual void reportFailed() override { log("[FAILED]\n"); }
+    virtual void reportResults() override {}
+
+    virtual void log(const char* fmt, ...) override
+    {
+        char buffer[512];
+        va_list list;
+        va_start(list, fmt);
+        vsnprintf(buffer, sizeof(buffer), fmt, list);
+        va_end(list);
+        printf("%s", buffer);
+        if (nullptr != strstr(buffer, "*** Assertion failed in"))
+        {
+            ++failedAssertionLogs;
+        }
+    }
+
+    unsigned int failedAssertionLogs = 0;
+};
+
+TSUNIT_TEST(FailingThreads, failsOnAThreadOfItsOwn)
+{
+    std::thread thread([]() {
+        UT_EXPECT_TRUE(false);
+    });
+    thread.join();
+}
+
+TSUNIT_TEST(FailingThreads, passesAfterwards)
+{
+    UT_EXPECT_TRUE(true);
+}
+// Not at the same time - an unattributed failure fails every running test.
+TSUNIT_AFTER(FailingThreads, passesAfterwards, FailingThreads, failsOnAThreadOfItsOwn);
+
+/* ========================================================================== *
+ * Main entry
+ * ========================================================================== */
+int main(int argc, char* argv[])
+{
+    CCountingLogger logger;
+    tsunit::pLogger = &logger;
+    const int rc = tsunit::runUnitTests(argc, argv);
+
+    const tsunit::Statistics& stats = tsunit::totalStatistics();
+    const bool asExpected = (EXIT_FAILURE == rc)
+        && (1 == stats.failedTestsCnt())
+        && (1 == stats.passedTestsCnt())
+        && (1 == stats.assertionsFailedCnt())
+        && (1 == logger.failedAssertionLogs);
+    printf("%s\n", asExpected ? "The failure of the thread has been reported as expected."
+                              : "*** The failure of the thread has not been reported as expected!");
+    return asExpected ? EXIT_SUCCESS : EXIT_FAILURE;
+}